@@ -19,10 +19,19 @@
  **/
 
 #include "floattypes.h"
+#include "config.h"
 
 #include <limits>
 #include <cmath>
 
+#if defined(LOVE_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(LOVE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace love
 {
 
@@ -165,6 +174,160 @@ float16 float32to16(float f)
 	return basetable[(u >> 23) & 0x1FF] + ((u & 0x007FFFFF) >> shifttable[(u >> 23) & 0x1FF]);
 }
 
+// The bulk conversions below give the same results as the table-based ones
+// above: float16 -> float32 is exact, and float32 -> float16 truncates.
+
+void float16to32(const float16 *src, float *dst, size_t count)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+
+	const __m128i signmask = _mm_set1_epi32(0x8000);
+	const __m128i expmantmask = _mm_set1_epi32(0x7FFF);
+	const __m128i rebias = _mm_set1_epi32((127 - 15) << 23);
+	const __m128i infnanmin = _mm_set1_epi32(0x7BFF);
+	const __m128i normalmin = _mm_set1_epi32(0x0400);
+	const __m128 denormscale = _mm_set1_ps(1.0f / 16777216.0f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) (src + i)), _mm_setzero_si128());
+
+		__m128i sign = _mm_slli_epi32(_mm_and_si128(h, signmask), 16);
+		__m128i em = _mm_and_si128(h, expmantmask);
+
+		// Normal numbers only need their exponent rebiased. Infinity and NaN
+		// need it rebiased twice to end up with an all-ones exponent.
+		__m128i normal = _mm_add_epi32(_mm_slli_epi32(em, 13), rebias);
+		__m128i isinfnan = _mm_cmpgt_epi32(em, infnanmin);
+		normal = _mm_add_epi32(normal, _mm_and_si128(isinfnan, rebias));
+
+		// Denormals are just their mantissa scaled by 2^-24.
+		__m128i denorm = _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(em), denormscale));
+		__m128i isdenorm = _mm_cmplt_epi32(em, normalmin);
+
+		__m128i f = _mm_or_si128(_mm_and_si128(isdenorm, denorm), _mm_andnot_si128(isdenorm, normal));
+		_mm_storeu_ps(dst + i, _mm_castsi128_ps(_mm_or_si128(f, sign)));
+	}
+
+#elif defined(LOVE_SIMD_NEON)
+
+	const uint32x4_t signmask = vdupq_n_u32(0x8000);
+	const uint32x4_t expmantmask = vdupq_n_u32(0x7FFF);
+	const uint32x4_t rebias = vdupq_n_u32((127 - 15) << 23);
+	const uint32x4_t infnanmin = vdupq_n_u32(0x7BFF);
+	const uint32x4_t normalmin = vdupq_n_u32(0x0400);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		uint32x4_t h = vmovl_u16(vld1_u16(src + i));
+
+		uint32x4_t sign = vshlq_n_u32(vandq_u32(h, signmask), 16);
+		uint32x4_t em = vandq_u32(h, expmantmask);
+
+		uint32x4_t normal = vaddq_u32(vshlq_n_u32(em, 13), rebias);
+		uint32x4_t isinfnan = vcgtq_u32(em, infnanmin);
+		normal = vaddq_u32(normal, vandq_u32(isinfnan, rebias));
+
+		uint32x4_t denorm = vreinterpretq_u32_f32(vmulq_n_f32(vcvtq_f32_u32(em), 1.0f / 16777216.0f));
+		uint32x4_t isdenorm = vcltq_u32(em, normalmin);
+
+		uint32x4_t f = vbslq_u32(isdenorm, denorm, normal);
+		vst1q_f32(dst + i, vreinterpretq_f32_u32(vorrq_u32(f, sign)));
+	}
+
+#endif
+
+	for (; i < count; i++)
+		dst[i] = float16to32(src[i]);
+}
+
+void float32to16(const float *src, float16 *dst, size_t count)
+{
+	size_t i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+
+	const __m128i absmask = _mm_set1_epi32(0x7FFFFFFF);
+	const __m128i signmask = _mm_set1_epi32(0x8000);
+	const __m128i rebias = _mm_set1_epi32((127 - 15) << 23);
+	const __m128i normalmin = _mm_set1_epi32(0x38800000);
+	const __m128i overflowmin = _mm_set1_epi32(0x477FFFFF);
+	const __m128i infnanmin = _mm_set1_epi32(0x7F7FFFFF);
+	const __m128i mantmask = _mm_set1_epi32(0x007FFFFF);
+	const __m128i inf = _mm_set1_epi32(0x7C00);
+	const __m128 denormscale = _mm_set1_ps(16777216.0f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i u = _mm_castps_si128(_mm_loadu_ps(src + i));
+
+		__m128i sign = _mm_and_si128(_mm_srli_epi32(u, 16), signmask);
+		__m128i a = _mm_and_si128(u, absmask);
+
+		__m128i normal = _mm_srli_epi32(_mm_sub_epi32(a, rebias), 13);
+
+		// Denormals (and numbers too small for float16, which become 0) are
+		// the value scaled by 2^24 and truncated.
+		__m128i denorm = _mm_cvttps_epi32(_mm_mul_ps(_mm_castsi128_ps(a), denormscale));
+		__m128i isdenorm = _mm_cmplt_epi32(a, normalmin);
+		__m128i h = _mm_or_si128(_mm_and_si128(isdenorm, denorm), _mm_andnot_si128(isdenorm, normal));
+
+		// Large numbers become Infinity, Infinity and NaN keep their mantissa.
+		__m128i isoverflow = _mm_cmpgt_epi32(a, overflowmin);
+		h = _mm_or_si128(_mm_and_si128(isoverflow, inf), _mm_andnot_si128(isoverflow, h));
+
+		__m128i isinfnan = _mm_cmpgt_epi32(a, infnanmin);
+		__m128i infnan = _mm_srli_epi32(_mm_and_si128(a, mantmask), 13);
+		h = _mm_or_si128(h, _mm_and_si128(isinfnan, infnan));
+
+		h = _mm_or_si128(h, sign);
+
+		// Sign-extend so the saturating pack leaves the low 16 bits alone.
+		h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+		_mm_storel_epi64((__m128i *) (dst + i), _mm_packs_epi32(h, h));
+	}
+
+#elif defined(LOVE_SIMD_NEON)
+
+	const uint32x4_t absmask = vdupq_n_u32(0x7FFFFFFF);
+	const uint32x4_t signmask = vdupq_n_u32(0x8000);
+	const uint32x4_t rebias = vdupq_n_u32((127 - 15) << 23);
+	const uint32x4_t normalmin = vdupq_n_u32(0x38800000);
+	const uint32x4_t overflowmin = vdupq_n_u32(0x477FFFFF);
+	const uint32x4_t infnanmin = vdupq_n_u32(0x7F7FFFFF);
+	const uint32x4_t mantmask = vdupq_n_u32(0x007FFFFF);
+	const uint32x4_t inf = vdupq_n_u32(0x7C00);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		uint32x4_t u = vreinterpretq_u32_f32(vld1q_f32(src + i));
+
+		uint32x4_t sign = vandq_u32(vshrq_n_u32(u, 16), signmask);
+		uint32x4_t a = vandq_u32(u, absmask);
+
+		uint32x4_t normal = vshrq_n_u32(vsubq_u32(a, rebias), 13);
+
+		uint32x4_t denorm = vcvtq_u32_f32(vmulq_n_f32(vreinterpretq_f32_u32(a), 16777216.0f));
+		uint32x4_t h = vbslq_u32(vcltq_u32(a, normalmin), denorm, normal);
+
+		h = vbslq_u32(vcgtq_u32(a, overflowmin), inf, h);
+
+		uint32x4_t infnan = vshrq_n_u32(vandq_u32(a, mantmask), 13);
+		h = vorrq_u32(h, vandq_u32(vcgtq_u32(a, infnanmin), infnan));
+
+		h = vorrq_u32(h, sign);
+
+		vst1_u16(dst + i, vmovn_u32(h));
+	}
+
+#endif
+
+	for (; i < count; i++)
+		dst[i] = float32to16(src[i]);
+}
+
 // Adapted from https://stackoverflow.com/questions/41532085/how-to-pack-unpack-11-and-10-bit-floats-in-javascript-for-webgl2
 
 float float11to32(float11 f)
@@ -22,6 +22,8 @@
 
 #include "int.h"
 
+#include <cstddef>
+
 namespace love
 {
 
@@ -34,6 +36,10 @@ void float16Init();
 float float16to32(float16 f);
 float16 float32to16(float f);
 
+// Converts count values at once. Uses SIMD instructions when available.
+void float16to32(const float16 *src, float *dst, size_t count);
+void float32to16(const float *src, float16 *dst, size_t count);
+
 float float11to32(float11 f);
 float11 float32to11(float f);
 
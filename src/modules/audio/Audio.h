@@ -27,6 +27,7 @@
 // LOVE
 #include "common/Module.h"
 #include "common/StringMap.h"
+#include "common/int.h"
 #include "Source.h"
 #include "Effect.h"
 #include "RecordingDevice.h"
@@ -34,6 +35,13 @@
 namespace love
 {
 
+namespace filesystem
+{
+
+class FileData;
+
+} // filesystem
+
 namespace sound
 {
 
@@ -108,6 +116,45 @@ class Audio : public Module
 	virtual Source *newSource(love::sound::SoundData *soundData) = 0;
 	virtual Source *newSource(int sampleRate, int bitDepth, int channels, int buffers) = 0;
 
+	/**
+	 * Creates a static Source from an encoded sound file. Sources created from
+	 * identical file contents share their decoded audio through a cache.
+	 * @param filedata The encoded sound file.
+	 **/
+	virtual Source *newSource(love::filesystem::FileData *filedata) = 0;
+
+	struct SoundCacheStats
+	{
+		int sounds;
+		int64 memory;
+		int64 hits;
+		int64 misses;
+	};
+
+	/**
+	 * Gets information about the cache of decoded sounds used by static
+	 * Sources created from files.
+	 **/
+	virtual SoundCacheStats getSoundCacheStats() const = 0;
+
+	/**
+	 * Sets the most memory the decoded sound cache may use. Least recently
+	 * used sounds are evicted past that, although Sources keep their audio.
+	 * @param bytes The limit in bytes. 0 disables the cache.
+	 **/
+	virtual void setSoundCacheLimit(int64 bytes) = 0;
+	virtual int64 getSoundCacheLimit() const = 0;
+
+	/**
+	 * Sets the size above which static Sources created from files play the
+	 * decoded sound as a stream, a chunk at a time, instead of copying it into
+	 * one audio buffer. Such Sources report their type as "stream". Sources
+	 * created from SoundData the game made itself are always static.
+	 * @param bytes The threshold in bytes. 0 disables streaming.
+	 **/
+	virtual void setStaticStreamingThreshold(int64 bytes) = 0;
+	virtual int64 getStaticStreamingThreshold() const = 0;
+
 	/**
 	 * Gets the current number of simultaneous playing sources.
 	 * @return The current number of simultaneous playing sources.
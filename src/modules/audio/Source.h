@@ -122,6 +122,17 @@ class Source : public Object
 	virtual int getFreeBufferCount() const = 0;
 	virtual bool queue(void *data, size_t length, int dataSampleRate, int dataBitDepth, int dataChannels) = 0;
 
+	/**
+	 * Gets the total time spent decoding this Source's audio, in seconds.
+	 **/
+	virtual double getDecodeTime() const = 0;
+
+	/**
+	 * Gets the number of times this Source ran out of decoded audio while
+	 * playing.
+	 **/
+	virtual int getUnderrunCount() const = 0;
+
 	virtual Type getType() const;
 
 	static bool getConstant(const char *in, Type &out);
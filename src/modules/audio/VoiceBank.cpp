@@ -0,0 +1,530 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "VoiceBank.h"
+#include "common/Exception.h"
+#include "common/math.h"
+
+#if defined(LOVE_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(LOVE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+namespace love
+{
+namespace audio
+{
+
+love::Type VoiceBank::type("VoiceBank", &love::sound::Decoder::type);
+
+// Converts signed 16 bit samples to floats in [-1, 1).
+static void int16ToFloat(const int16 *src, float *dst, int count)
+{
+	const float scale = 1.0f / 32768.0f;
+	int i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+	const __m128 vscale = _mm_set1_ps(scale);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+
+		// Sign-extend by unpacking into the high halves and shifting down.
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	for (; i + 8 <= count; i += 8)
+	{
+		int16x8_t s = vld1q_s16(src + i);
+		vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), scale));
+		vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), scale));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = src[i] * scale;
+}
+
+// Adds interleaved stereo frames to the mix, with the left and right gains
+// ramping linearly from g0 to g1 over rampFrames.
+static void accumulate(float *mix, const float *src, int frames, int rampFrames, const float g0[2], const float g1[2])
+{
+	float dl = (g1[0] - g0[0]) / rampFrames;
+	float dr = (g1[1] - g0[1]) / rampFrames;
+	float gl = g0[0] + dl;
+	float gr = g0[1] + dr;
+	int f = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+	__m128 g = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+	const __m128 gstep = _mm_setr_ps(2 * dl, 2 * dr, 2 * dl, 2 * dr);
+
+	for (; f + 2 <= frames; f += 2)
+	{
+		__m128 m = _mm_loadu_ps(mix + f * 2);
+		__m128 s = _mm_loadu_ps(src + f * 2);
+		_mm_storeu_ps(mix + f * 2, _mm_add_ps(m, _mm_mul_ps(s, g)));
+		g = _mm_add_ps(g, gstep);
+	}
+
+	gl += f * dl;
+	gr += f * dr;
+#elif defined(LOVE_SIMD_NEON)
+	const float ginit[4] = {gl, gr, gl + dl, gr + dr};
+	const float gsteps[4] = {2 * dl, 2 * dr, 2 * dl, 2 * dr};
+	float32x4_t g = vld1q_f32(ginit);
+	const float32x4_t gstep = vld1q_f32(gsteps);
+
+	for (; f + 2 <= frames; f += 2)
+	{
+		float32x4_t m = vld1q_f32(mix + f * 2);
+		float32x4_t s = vld1q_f32(src + f * 2);
+		vst1q_f32(mix + f * 2, vmlaq_f32(m, s, g));
+		g = vaddq_f32(g, gstep);
+	}
+
+	gl += f * dl;
+	gr += f * dr;
+#endif
+
+	for (; f < frames; f++)
+	{
+		mix[f * 2 + 0] += src[f * 2 + 0] * gl;
+		mix[f * 2 + 1] += src[f * 2 + 1] * gr;
+		gl += dl;
+		gr += dr;
+	}
+}
+
+// Converts the mix to signed 16 bit samples, clipping anything too loud.
+static void floatToInt16(const float *src, int16 *dst, int count)
+{
+	int i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 lo = _mm_set1_ps(-32768.0f);
+	const __m128 hi = _mm_set1_ps(32767.0f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), lo), hi);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+		_mm_storeu_si128((__m128i *) (dst + i), packed);
+	}
+#elif defined(LOVE_SIMD_NEON) && defined(__aarch64__)
+	for (; i + 8 <= count; i += 8)
+	{
+		// Rounds to nearest (even), like the other paths.
+		int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 32767.0f));
+		int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32767.0f));
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	const uint32x4_t signbit = vdupq_n_u32(0x80000000);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		// ARMv7 can only convert with truncation, so round half away from
+		// zero first. Only exact ties differ from the other paths.
+		float32x4_t fa = vmulq_n_f32(vld1q_f32(src + i), 32767.0f);
+		float32x4_t fb = vmulq_n_f32(vld1q_f32(src + i + 4), 32767.0f);
+		float32x4_t ha = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(fa), signbit), vreinterpretq_u32_f32(half)));
+		float32x4_t hb = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(fb), signbit), vreinterpretq_u32_f32(half)));
+		int32x4_t a = vcvtq_s32_f32(vaddq_f32(fa, ha));
+		int32x4_t b = vcvtq_s32_f32(vaddq_f32(fb, hb));
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float v = std::min(std::max(src[i] * 32767.0f, -32768.0f), 32767.0f);
+		dst[i] = (int16) lrintf(v);
+	}
+}
+
+static void getGains(float volume, float pan, int channels, float gains[2])
+{
+	if (channels == 1)
+	{
+		// Constant power panning, like OpenAL's for mono sources.
+		float angle = (pan + 1.0f) * (float) (LOVE_M_PI / 4.0);
+		gains[0] = volume * cosf(angle);
+		gains[1] = volume * sinf(angle);
+	}
+	else
+	{
+		// Stereo sounds are balanced, at full volume when centered.
+		gains[0] = volume * std::min(1.0f - pan, 1.0f);
+		gains[1] = volume * std::min(1.0f + pan, 1.0f);
+	}
+}
+
+VoiceBank::VoiceBank(int maxVoices, int sampleRate)
+	: Decoder(nullptr, BUFFER_FRAMES * 2 * sizeof(int16))
+	, maxVoices(maxVoices)
+	, nextID(1)
+{
+	if (maxVoices < 1 || maxVoices > MAX_VOICES)
+		throw love::Exception("Invalid voice count: %d (must be between 1 and %d)", maxVoices, MAX_VOICES);
+
+	if (sampleRate <= 0)
+		throw love::Exception("Invalid sample rate: %d", sampleRate);
+
+	this->sampleRate = sampleRate;
+
+	// Stolen voices keep fading out alongside the ones which replace them.
+	voices.reserve(maxVoices * 2);
+	mixBuffer.resize(BUFFER_FRAMES * 2);
+	voiceBuffer.resize(BUFFER_FRAMES * 2);
+}
+
+VoiceBank::~VoiceBank()
+{
+}
+
+int VoiceBank::play(love::sound::SoundData *soundData, float volume, float pitch, float pan, bool looping)
+{
+	int channels = soundData->getChannelCount();
+	if (channels != 1 && channels != 2)
+		throw love::Exception("Only mono and stereo sounds can be played by a VoiceBank.");
+
+	if (!(pitch > 0.0f) || !std::isfinite(pitch))
+		throw love::Exception("Pitch has to be non-zero, positive, finite number.");
+
+	if (volume < 0.0f)
+		throw love::Exception("Volume cannot be negative.");
+
+	Voice voice;
+	voice.soundData.set(soundData);
+	voice.position = 0.0;
+	voice.volume = volume;
+	voice.pitch = pitch;
+	voice.pan = std::min(std::max(pan, -1.0f), 1.0f);
+	voice.looping = looping;
+	voice.stopping = false;
+	getGains(voice.volume, voice.pan, channels, voice.lastGains);
+
+	thread::Lock lock(mutex);
+
+	voice.id = nextID;
+	nextID = nextID == LOVE_INT32_MAX ? 1 : nextID + 1;
+
+	// Voices which are already fading out don't count against the limit. If
+	// it's still reached, the oldest voice is stolen: it fades out over the
+	// next buffer like a stopped one, instead of cutting off with a click.
+	Voice *oldest = nullptr;
+	int active = 0;
+
+	for (Voice &v : voices)
+	{
+		if (v.stopping)
+			continue;
+
+		if (oldest == nullptr)
+			oldest = &v;
+
+		active++;
+	}
+
+	if (active >= maxVoices)
+		oldest->stopping = true;
+
+	// Too many voices played before the next buffer is mixed can leave more
+	// fading out than there's room for. Only then is one cut off, preferably
+	// one which hasn't been heard yet, so the cut is silent.
+	if ((int) voices.size() >= maxVoices * 2)
+	{
+		auto it = std::find_if(voices.begin(), voices.end(), [](const Voice &v) { return v.stopping && v.position == 0.0; });
+		if (it == voices.end())
+			it = std::find_if(voices.begin(), voices.end(), [](const Voice &v) { return v.stopping; });
+
+		voices.erase(it);
+	}
+
+	voices.push_back(voice);
+	return voice.id;
+}
+
+void VoiceBank::stop(int voice)
+{
+	thread::Lock lock(mutex);
+
+	Voice *v = findVoice(voice);
+	if (v != nullptr)
+		v->stopping = true;
+}
+
+void VoiceBank::stopAll()
+{
+	thread::Lock lock(mutex);
+
+	for (Voice &v : voices)
+		v.stopping = true;
+}
+
+bool VoiceBank::isPlaying(int voice) const
+{
+	thread::Lock lock(mutex);
+
+	const Voice *v = findVoice(voice);
+	return v != nullptr && !v->stopping;
+}
+
+void VoiceBank::setVolume(int voice, float volume)
+{
+	if (volume < 0.0f)
+		throw love::Exception("Volume cannot be negative.");
+
+	thread::Lock lock(mutex);
+
+	Voice *v = findVoice(voice);
+	if (v != nullptr)
+		v->volume = volume;
+}
+
+void VoiceBank::setPitch(int voice, float pitch)
+{
+	if (!(pitch > 0.0f) || !std::isfinite(pitch))
+		throw love::Exception("Pitch has to be non-zero, positive, finite number.");
+
+	thread::Lock lock(mutex);
+
+	Voice *v = findVoice(voice);
+	if (v != nullptr)
+		v->pitch = pitch;
+}
+
+void VoiceBank::setPan(int voice, float pan)
+{
+	thread::Lock lock(mutex);
+
+	Voice *v = findVoice(voice);
+	if (v != nullptr)
+		v->pan = std::min(std::max(pan, -1.0f), 1.0f);
+}
+
+int VoiceBank::getActiveVoiceCount() const
+{
+	thread::Lock lock(mutex);
+
+	int count = 0;
+	for (const Voice &v : voices)
+	{
+		if (!v.stopping)
+			count++;
+	}
+
+	return count;
+}
+
+int VoiceBank::getMaxVoices() const
+{
+	return maxVoices;
+}
+
+VoiceBank::Voice *VoiceBank::findVoice(int id)
+{
+	for (Voice &v : voices)
+	{
+		if (v.id == id)
+			return &v;
+	}
+
+	return nullptr;
+}
+
+const VoiceBank::Voice *VoiceBank::findVoice(int id) const
+{
+	for (const Voice &v : voices)
+	{
+		if (v.id == id)
+			return &v;
+	}
+
+	return nullptr;
+}
+
+int VoiceBank::resample(Voice &voice, float *out, int frames) const
+{
+	const love::sound::SoundData *sd = voice.soundData.get();
+
+	int channels = sd->getChannelCount();
+	int bitDepth = sd->getBitDepth();
+	int64 count = sd->getSampleCount();
+	double step = voice.pitch * (double) sd->getSampleRate() / (double) sampleRate;
+	double pos = voice.position;
+
+	const int16 *samples16 = (const int16 *) sd->getData();
+	const uint8 *samples8 = (const uint8 *) sd->getData();
+
+	int written = 0;
+
+	while (written < frames)
+	{
+		if (pos >= (double) count)
+		{
+			if (!voice.looping)
+				break;
+			pos = fmod(pos, (double) count);
+		}
+
+		int64 index = (int64) pos;
+
+		// Unpitched 16 bit stereo sounds at the mixing rate don't need any
+		// interpolation, so they're converted in bulk.
+		if (step == 1.0 && pos == (double) index && bitDepth == 16 && channels == 2)
+		{
+			int n = (int) std::min<int64>(frames - written, count - index);
+			int16ToFloat(samples16 + index * 2, out + written * 2, n * 2);
+			written += n;
+			pos += n;
+			continue;
+		}
+
+		int64 next = index + 1;
+		if (next >= count)
+			next = voice.looping ? 0 : index;
+
+		float t = (float) (pos - (double) index);
+		float s0[2], s1[2];
+
+		for (int c = 0; c < channels; c++)
+		{
+			if (bitDepth == 16)
+			{
+				s0[c] = samples16[index * channels + c] / 32768.0f;
+				s1[c] = samples16[next * channels + c] / 32768.0f;
+			}
+			else
+			{
+				// 8 bit samples are unsigned.
+				s0[c] = (samples8[index * channels + c] - 128) / 128.0f;
+				s1[c] = (samples8[next * channels + c] - 128) / 128.0f;
+			}
+		}
+
+		if (channels == 1)
+		{
+			s0[1] = s0[0];
+			s1[1] = s1[0];
+		}
+
+		out[written * 2 + 0] = s0[0] + (s1[0] - s0[0]) * t;
+		out[written * 2 + 1] = s0[1] + (s1[1] - s0[1]) * t;
+
+		written++;
+		pos += step;
+	}
+
+	voice.position = pos;
+	return written;
+}
+
+love::sound::Decoder *VoiceBank::clone()
+{
+	// A new VoiceBank wouldn't play the voices of this one, so the cloned
+	// Source would only ever play silence.
+	throw love::Exception("Sources playing a VoiceBank can't be cloned.");
+}
+
+int VoiceBank::decode()
+{
+	thread::Lock lock(mutex);
+
+	std::fill(mixBuffer.begin(), mixBuffer.end(), 0.0f);
+
+	for (Voice &v : voices)
+	{
+		int channels = v.soundData->getChannelCount();
+
+		// Stopped voices fade out over this buffer instead of cutting off.
+		float gains[2] = {0.0f, 0.0f};
+		if (!v.stopping)
+			getGains(v.volume, v.pan, channels, gains);
+
+		int written = resample(v, voiceBuffer.data(), BUFFER_FRAMES);
+		accumulate(mixBuffer.data(), voiceBuffer.data(), written, BUFFER_FRAMES, v.lastGains, gains);
+
+		v.lastGains[0] = gains[0];
+		v.lastGains[1] = gains[1];
+
+		if (written < BUFFER_FRAMES)
+			v.stopping = true;
+	}
+
+	voices.erase(std::remove_if(voices.begin(), voices.end(), [](const Voice &v) { return v.stopping && v.lastGains[0] == 0.0f && v.lastGains[1] == 0.0f; }), voices.end());
+
+	floatToInt16(mixBuffer.data(), (int16 *) buffer, BUFFER_FRAMES * 2);
+
+	return bufferSize;
+}
+
+bool VoiceBank::seek(double /*s*/)
+{
+	return false;
+}
+
+bool VoiceBank::rewind()
+{
+	return true;
+}
+
+bool VoiceBank::isSeekable()
+{
+	return false;
+}
+
+int VoiceBank::getChannelCount() const
+{
+	return 2;
+}
+
+int VoiceBank::getBitDepth() const
+{
+	return 16;
+}
+
+int VoiceBank::getSampleRate() const
+{
+	return sampleRate;
+}
+
+double VoiceBank::getDuration()
+{
+	return -1.0;
+}
+
+} // audio
+} // love
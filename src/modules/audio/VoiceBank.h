@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_AUDIO_VOICE_BANK_H
+#define LOVE_AUDIO_VOICE_BANK_H
+
+// LOVE
+#include "common/int.h"
+#include "sound/Decoder.h"
+#include "sound/SoundData.h"
+#include "thread/threads.h"
+
+// C++
+#include <vector>
+
+namespace love
+{
+namespace audio
+{
+
+/**
+ * Mixes many short sounds in software into a single stereo 16 bit stream.
+ * A streaming Source created from the VoiceBank plays the mix, so the sounds
+ * only use one OpenAL source between them, however many overlap.
+ *
+ * Voices are played from SoundData and have their own volume, pitch and pan.
+ * The VoiceBank never finishes: it decodes silence while no voices play.
+ * Its Source can't be cloned, since voices are played on the VoiceBank
+ * rather than on a Source.
+ **/
+class VoiceBank : public love::sound::Decoder
+{
+public:
+
+	static love::Type type;
+
+	static const int DEFAULT_MAX_VOICES = 64;
+	static const int MAX_VOICES = 4096;
+
+	// Sample frames mixed per decode. Kept small, since it determines the
+	// latency between playing a voice and hearing it.
+	static const int BUFFER_FRAMES = 256;
+
+	VoiceBank(int maxVoices, int sampleRate);
+	virtual ~VoiceBank();
+
+	/**
+	 * Starts playing a sound. If all voices are in use, the one which has
+	 * been playing the longest is faded out over the next mixed buffer and
+	 * replaced.
+	 * @param soundData The sound to play. Must be mono or stereo.
+	 * @param volume Linear volume of the voice.
+	 * @param pitch Playback speed, where 1 is the original pitch.
+	 * @param pan Stereo position, from -1 (left) to 1 (right).
+	 * @param looping Whether the voice repeats until it's stopped.
+	 * @return An identifier for the voice.
+	 **/
+	int play(love::sound::SoundData *soundData, float volume, float pitch, float pan, bool looping);
+
+	/**
+	 * Stops a voice. The voice is faded out over the next mixed buffer.
+	 **/
+	void stop(int voice);
+	void stopAll();
+
+	bool isPlaying(int voice) const;
+
+	void setVolume(int voice, float volume);
+	void setPitch(int voice, float pitch);
+	void setPan(int voice, float pan);
+
+	int getActiveVoiceCount() const;
+	int getMaxVoices() const;
+
+	// Implements Decoder. clone() throws, see above.
+	Decoder *clone();
+	int decode();
+	bool seek(double s);
+	bool rewind();
+	bool isSeekable();
+	int getChannelCount() const;
+	int getBitDepth() const;
+	int getSampleRate() const;
+	double getDuration();
+
+private:
+
+	struct Voice
+	{
+		StrongRef<love::sound::SoundData> soundData;
+		int id;
+
+		// Read position in source sample frames.
+		double position;
+
+		float volume;
+		float pitch;
+		float pan;
+		bool looping;
+		bool stopping;
+
+		// Gains used at the end of the previous buffer, which the next buffer
+		// ramps from to avoid clicks.
+		float lastGains[2];
+	};
+
+	Voice *findVoice(int id);
+	const Voice *findVoice(int id) const;
+
+	// Resamples up to frames stereo frames of a voice into out. Returns the
+	// number of frames written, which is less at the end of the sound.
+	int resample(Voice &voice, float *out, int frames) const;
+
+	int maxVoices;
+	int nextID;
+
+	std::vector<Voice> voices;
+
+	std::vector<float> mixBuffer;
+	std::vector<float> voiceBuffer;
+
+	// Voices are played from the main thread while the Source decodes on
+	// the audio thread.
+	love::thread::MutexRef mutex;
+
+}; // VoiceBank
+
+} // audio
+} // love
+
+#endif // LOVE_AUDIO_VOICE_BANK_H
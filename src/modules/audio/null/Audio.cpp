@@ -56,6 +56,35 @@ love::audio::Source *Audio::newSource(int, int, int, int)
 	return new Source();
 }
 
+love::audio::Source *Audio::newSource(love::filesystem::FileData *)
+{
+	return new Source();
+}
+
+Audio::SoundCacheStats Audio::getSoundCacheStats() const
+{
+	SoundCacheStats stats = {};
+	return stats;
+}
+
+void Audio::setSoundCacheLimit(int64)
+{
+}
+
+int64 Audio::getSoundCacheLimit() const
+{
+	return 0;
+}
+
+void Audio::setStaticStreamingThreshold(int64)
+{
+}
+
+int64 Audio::getStaticStreamingThreshold() const
+{
+	return 0;
+}
+
 int Audio::getActiveSourceCount() const
 {
 	return 0;
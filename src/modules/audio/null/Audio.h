@@ -48,6 +48,13 @@ class Audio : public love::audio::Audio
 	love::audio::Source *newSource(love::sound::Decoder *decoder);
 	love::audio::Source *newSource(love::sound::SoundData *soundData);
 	love::audio::Source *newSource(int sampleRate, int bitDepth, int channels, int buffers);
+	love::audio::Source *newSource(love::filesystem::FileData *filedata);
+	SoundCacheStats getSoundCacheStats() const;
+	void setSoundCacheLimit(int64 bytes);
+	int64 getSoundCacheLimit() const;
+
+	void setStaticStreamingThreshold(int64 bytes);
+	int64 getStaticStreamingThreshold() const;
 	int getActiveSourceCount() const;
 	int getMaxSources() const;
 	bool play(love::audio::Source *source);
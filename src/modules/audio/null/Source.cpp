@@ -239,6 +239,16 @@ bool Source::queue(void *, size_t, int, int, int)
 	return false;
 }
 
+double Source::getDecodeTime() const
+{
+	return 0.0;
+}
+
+int Source::getUnderrunCount() const
+{
+	return 0;
+}
+
 bool Source::setFilter(const std::map<Filter::Parameter, float> &)
 {
 	return false;
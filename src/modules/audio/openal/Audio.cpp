@@ -22,6 +22,9 @@
 #include "common/delay.h"
 #include "RecordingDevice.h"
 #include "sound/Decoder.h"
+#include "sound/Sound.h"
+#include "filesystem/FileData.h"
+#include "libraries/xxHash/xxhash.h"
 
 #include <cstdlib>
 #include <iostream>
@@ -57,15 +60,19 @@ void Audio::PoolThread::threadFunction()
 			}
 		}
 
-		pool->update();
-		sleep(5);
+		int delay = pool->update();
+		pool->waitForUpdate(delay);
 	}
 }
 
 void Audio::PoolThread::setFinish()
 {
-	thread::Lock lock(mutex);
-	finish = true;
+	{
+		thread::Lock lock(mutex);
+		finish = true;
+	}
+
+	pool->requestUpdate();
 }
 
 ALenum Audio::getFormat(int bitDepth, int channels)
@@ -95,6 +102,12 @@ Audio::Audio()
 	, pool(nullptr)
 	, poolThread(nullptr)
 	, distanceModel(DISTANCE_INVERSE_CLAMPED)
+	, soundCacheLimit(DEFAULT_SOUND_CACHE_LIMIT)
+	, soundCacheMemory(0)
+	, soundCacheHits(0)
+	, soundCacheMisses(0)
+	, soundCacheUses(0)
+	, staticStreamingThreshold(DEFAULT_STATIC_STREAMING_THRESHOLD)
 {
 #if defined(LOVE_LINUX)
 	// Temporarly block signals, as the thread inherits this mask
@@ -199,6 +212,9 @@ Audio::~Audio()
 	delete poolThread;
 	delete pool;
 
+	// The cached buffers have to be deleted while the context still exists.
+	soundCache.clear();
+
 	for (auto c : capture)
 		delete c;
 
@@ -235,7 +251,28 @@ love::audio::Source *Audio::newSource(love::sound::Decoder *decoder)
 
 love::audio::Source *Audio::newSource(love::sound::SoundData *soundData)
 {
-	return new Source(pool, soundData);
+	// SoundData which uses a file's contents in place (a mapped WAV file)
+	// shares the cache with Sources created from files. Other SoundData can
+	// be changed by the game after the Source is created, so it's always
+	// copied into a static buffer.
+	love::Data *file = soundData->getSourceData();
+	if (file == nullptr)
+		return new Source(pool, soundData);
+
+	Source *source = newStreamingSource(soundData);
+	if (source != nullptr)
+		return source;
+
+	uint64 key = XXH64(file->getData(), file->getSize(), 0);
+
+	source = newCachedSource(key, file->getSize());
+	if (source != nullptr)
+		return source;
+
+	source = new Source(pool, soundData);
+	addCachedSound(key, file->getSize(), source, soundData);
+
+	return source;
 }
 
 love::audio::Source *Audio::newSource(int sampleRate, int bitDepth, int channels, int buffers)
@@ -243,6 +280,136 @@ love::audio::Source *Audio::newSource(int sampleRate, int bitDepth, int channels
 	return new Source(pool, sampleRate, bitDepth, channels, buffers);
 }
 
+love::audio::Source *Audio::newSource(love::filesystem::FileData *filedata)
+{
+	uint64 key = XXH64(filedata->getData(), filedata->getSize(), 0);
+
+	Source *cached = newCachedSource(key, filedata->getSize());
+	if (cached != nullptr)
+		return cached;
+
+	auto soundmodule = Module::getInstance<love::sound::Sound>(M_SOUND);
+	if (soundmodule == nullptr)
+		throw love::Exception("love.sound must be loaded in order to create a Source from a file.");
+
+	StrongRef<love::sound::Decoder> decoder(soundmodule->newDecoder(filedata, love::sound::Decoder::DEFAULT_BUFFER_SIZE), Acquire::NORETAIN);
+	StrongRef<love::sound::SoundData> sounddata(soundmodule->newSoundData(decoder), Acquire::NORETAIN);
+
+	Source *source = newStreamingSource(sounddata.get());
+	if (source == nullptr)
+		source = new Source(pool, sounddata.get());
+
+	addCachedSound(key, filedata->getSize(), source, sounddata.get());
+
+	return source;
+}
+
+Source *Audio::newStreamingSource(love::sound::SoundData *soundData)
+{
+	int64 threshold = staticStreamingThreshold;
+	auto soundmodule = Module::getInstance<love::sound::Sound>(M_SOUND);
+
+	// Large sounds are fed to OpenAL a chunk at a time, so the whole sound
+	// doesn't have to sit in an audio buffer as well as in the SoundData.
+	if (threshold <= 0 || (int64) soundData->getSize() <= threshold || soundmodule == nullptr)
+		return nullptr;
+
+	StrongRef<love::sound::Decoder> decoder(soundmodule->newSoundDataDecoder(soundData, love::sound::Decoder::DEFAULT_BUFFER_SIZE), Acquire::NORETAIN);
+	return new Source(pool, decoder);
+}
+
+Source *Audio::newCachedSource(uint64 key, size_t fileSize)
+{
+	thread::Lock lock(soundCacheMutex);
+
+	auto it = soundCache.find(key);
+	if (it != soundCache.end() && it->second.fileSize == fileSize)
+	{
+		CachedSound &sound = it->second;
+		sound.lastUse = ++soundCacheUses;
+		soundCacheHits++;
+		return new Source(pool, sound.buffer, sound.sampleRate, sound.bitDepth, sound.channels);
+	}
+
+	soundCacheMisses++;
+	return nullptr;
+}
+
+void Audio::addCachedSound(uint64 key, size_t fileSize, Source *source, love::sound::SoundData *soundData)
+{
+	// Streamed sounds have no buffer to share.
+	if (source->getStaticBuffer() == nullptr)
+		return;
+
+	thread::Lock lock(soundCacheMutex);
+
+	if ((int64) soundData->getSize() <= soundCacheLimit && soundCache.find(key) == soundCache.end())
+	{
+		CachedSound &sound = soundCache[key];
+		sound.buffer.set(source->getStaticBuffer());
+		sound.fileSize = fileSize;
+		sound.sampleRate = soundData->getSampleRate();
+		sound.bitDepth = soundData->getBitDepth();
+		sound.channels = soundData->getChannelCount();
+		sound.lastUse = ++soundCacheUses;
+
+		soundCacheMemory += sound.buffer->getSize();
+		trimSoundCache();
+	}
+}
+
+Audio::SoundCacheStats Audio::getSoundCacheStats() const
+{
+	thread::Lock lock(soundCacheMutex);
+
+	SoundCacheStats stats;
+	stats.sounds = (int) soundCache.size();
+	stats.memory = soundCacheMemory;
+	stats.hits = soundCacheHits;
+	stats.misses = soundCacheMisses;
+	return stats;
+}
+
+void Audio::setSoundCacheLimit(int64 bytes)
+{
+	thread::Lock lock(soundCacheMutex);
+	soundCacheLimit = std::max<int64>(bytes, 0);
+	trimSoundCache();
+}
+
+int64 Audio::getSoundCacheLimit() const
+{
+	thread::Lock lock(soundCacheMutex);
+	return soundCacheLimit;
+}
+
+void Audio::setStaticStreamingThreshold(int64 bytes)
+{
+	staticStreamingThreshold = std::max<int64>(bytes, 0);
+}
+
+int64 Audio::getStaticStreamingThreshold() const
+{
+	return staticStreamingThreshold;
+}
+
+void Audio::trimSoundCache()
+{
+	while (soundCacheMemory > soundCacheLimit && !soundCache.empty())
+	{
+		auto oldest = soundCache.begin();
+		for (auto it = soundCache.begin(); it != soundCache.end(); ++it)
+		{
+			if (it->second.lastUse < oldest->second.lastUse)
+				oldest = it;
+		}
+
+		// Sources which use the sound keep their own reference to it.
+		soundCacheMemory -= oldest->second.buffer->getSize();
+		soundCache.erase(oldest);
+	}
+}
+
 int Audio::getActiveSourceCount() const
 {
 	return pool->getActiveSourceCount();
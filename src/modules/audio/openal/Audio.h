@@ -22,8 +22,10 @@
 #define LOVE_AUDIO_OPENAL_AUDIO_H
 
 // STD
+#include <atomic>
 #include <queue>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <stack>
 #include <cmath>
@@ -62,6 +64,8 @@ namespace audio
 namespace openal
 {
 
+class StaticDataBuffer;
+
 class Audio : public love::audio::Audio
 {
 public:
@@ -85,6 +89,13 @@ class Audio : public love::audio::Audio
 	love::audio::Source *newSource(love::sound::Decoder *decoder);
 	love::audio::Source *newSource(love::sound::SoundData *soundData);
 	love::audio::Source *newSource(int sampleRate, int bitDepth, int channels, int buffers);
+	love::audio::Source *newSource(love::filesystem::FileData *filedata);
+	SoundCacheStats getSoundCacheStats() const;
+	void setSoundCacheLimit(int64 bytes);
+	int64 getSoundCacheLimit() const;
+
+	void setStaticStreamingThreshold(int64 bytes);
+	int64 getStaticStreamingThreshold() const;
 	int getActiveSourceCount() const;
 	int getMaxSources() const;
 	bool play(love::audio::Source *source);
@@ -127,6 +138,21 @@ class Audio : public love::audio::Audio
 
 private:
 	void initializeEFX();
+
+	// Returns a new Source using the cached sound for the given file contents,
+	// or null if it isn't cached.
+	Source *newCachedSource(uint64 key, size_t fileSize);
+
+	// Returns a new stream Source playing the decoded contents of a file, or
+	// null if they're within the static streaming threshold.
+	Source *newStreamingSource(love::sound::SoundData *soundData);
+
+	// Caches the static buffer of a Source created from the given file.
+	void addCachedSound(uint64 key, size_t fileSize, Source *source, love::sound::SoundData *soundData);
+
+	// Evicts least recently used sounds until the cache is within its limit.
+	void trimSoundCache();
+
 	// The OpenAL device.
 	ALCdevice *device;
 
@@ -174,6 +200,32 @@ class Audio : public love::audio::Audio
 
 	DistanceModel distanceModel;
 	//float metersPerUnit = 1.0;
+
+	static const int64 DEFAULT_SOUND_CACHE_LIMIT = 32 * 1024 * 1024;
+
+	// Decoded static sounds, keyed by a hash of their encoded file contents.
+	struct CachedSound
+	{
+		StrongRef<StaticDataBuffer> buffer;
+		size_t fileSize;
+		int sampleRate;
+		int bitDepth;
+		int channels;
+		uint64 lastUse;
+	};
+
+	std::unordered_map<uint64, CachedSound> soundCache;
+	int64 soundCacheLimit;
+	int64 soundCacheMemory;
+	int64 soundCacheHits;
+	int64 soundCacheMisses;
+	uint64 soundCacheUses;
+	love::thread::MutexRef soundCacheMutex;
+
+	static const int64 DEFAULT_STATIC_STREAMING_THRESHOLD = 16 * 1024 * 1024;
+
+	std::atomic<int64> staticStreamingThreshold;
+
 }; // Audio
 
 #ifdef ALC_EXT_EFX
@@ -22,6 +22,10 @@
 
 #include "Source.h"
 
+// C++
+#include <algorithm>
+#include <thread>
+
 namespace love
 {
 namespace audio
@@ -32,6 +36,7 @@ namespace openal
 Pool::Pool()
 	: sources()
 	, totalSources(0)
+	, decodeWorkers(nullptr)
 {
 	// Clear errors.
 	alGetError();
@@ -69,12 +74,17 @@ Pool::Pool()
 
 		available.push(sources[i]);
 	}
+
+	int cores = (int) std::thread::hardware_concurrency();
+	decodeWorkers = new love::thread::WorkerPool(std::max(std::min(MAX_DECODE_WORKERS, cores - 1), 0));
 }
 
 Pool::~Pool()
 {
 	Source::stop(this);
 
+	delete decodeWorkers;
+
 	// Free all sources.
 	alDeleteSources(totalSources, sources);
 }
@@ -99,20 +109,78 @@ bool Pool::isPlaying(Source *s)
 	return p;
 }
 
-void Pool::update()
+int Pool::update()
 {
-	thread::Lock lock(mutex);
+	std::vector<Source *> playingSources;
 
-	std::vector<Source *> torelease;
+	{
+		thread::Lock lock(mutex);
+
+		playingSources.reserve(playing.size());
+		for (const auto &i : playing)
+		{
+			i.first->retain();
+			playingSources.push_back(i.first);
+		}
+	}
 
-	for (const auto &i : playing)
+	// Decoding is the slow part, so it happens while other threads can still
+	// play and stop Sources, with one slow decoder not holding up the others.
+	// Decoding errors are raised later, when update() decodes directly.
+	decodeWorkers->parallelFor((int) playingSources.size(), [&](int i)
 	{
-		if (!i.first->update())
-			torelease.push_back(i.first);
+		try
+		{
+			playingSources[i]->decodeAhead();
+		}
+		catch (love::Exception &)
+		{
+		}
+	});
+
+	int delay = -1;
+
+	for (Source *s : playingSources)
+	{
+		thread::Lock lock(mutex);
+
+		if (playing.find(s) == playing.end())
+			continue;
+
+		if (!s->update())
+		{
+			releaseSource(s);
+			continue;
+		}
+
+		int sourcedelay = s->getUpdateDelay();
+		if (sourcedelay < 0 || sourcedelay > MAX_UPDATE_DELAY)
+			sourcedelay = MAX_UPDATE_DELAY;
+
+		delay = delay < 0 ? sourcedelay : std::min(delay, sourcedelay);
 	}
 
-	for (Source *s : torelease)
-		releaseSource(s);
+	for (Source *s : playingSources)
+		s->release();
+
+	return delay;
+}
+
+void Pool::waitForUpdate(int timeout)
+{
+	thread::Lock lock(updateMutex);
+
+	if (!updateRequested && timeout != 0)
+		updateCond->wait(updateMutex, timeout);
+
+	updateRequested = false;
+}
+
+void Pool::requestUpdate()
+{
+	thread::Lock lock(updateMutex);
+	updateRequested = true;
+	updateCond->signal();
 }
 
 int Pool::getActiveSourceCount() const
@@ -142,6 +210,9 @@ bool Pool::assignSource(Source *source, ALuint &out, char &wasPlaying)
 
 	playing.insert(std::make_pair(source, out));
 	source->retain();
+
+	// The update thread may be waiting with no deadline.
+	requestUpdate();
 	return true;
 }
 
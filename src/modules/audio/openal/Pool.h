@@ -31,6 +31,7 @@
 #include "common/config.h"
 #include "common/Exception.h"
 #include "thread/threads.h"
+#include "thread/WorkerPool.h"
 #include "audio/Source.h"
 
 // OpenAL
@@ -78,7 +79,26 @@ class Pool
 	 **/
 	bool isPlaying(Source *s);
 
-	void update();
+	/**
+	 * Updates the playing Sources. Streaming Sources decode their next buffers
+	 * in parallel before the Pool is locked, so the lock is only held briefly
+	 * per Source.
+	 * @return The time in milliseconds until the next update is needed, or -1
+	 * if nothing is playing.
+	 **/
+	int update();
+
+	/**
+	 * Waits until the next update is due, or until a Source starts playing.
+	 * @param timeout The maximum time to wait in milliseconds, or -1 to wait
+	 * until woken up.
+	 **/
+	void waitForUpdate(int timeout);
+
+	/**
+	 * Wakes up a thread which is waiting in waitForUpdate.
+	 **/
+	void requestUpdate();
 
 	int getActiveSourceCount() const;
 	int getMaxSources() const;
@@ -101,6 +121,13 @@ class Pool
 	// Maximum possible number of OpenAL sources the pool attempts to generate.
 	static const int MAX_SOURCES = 64;
 
+	// Most threads used for decoding streaming Sources in parallel.
+	static const int MAX_DECODE_WORKERS = 2;
+
+	// Longest time between updates while Sources are playing, since their
+	// deadlines can change (e.g. through setPitch or setLooping).
+	static const int MAX_UPDATE_DELAY = 50;
+
 	// OpenAL sources
 	ALuint sources[MAX_SOURCES];
 
@@ -117,6 +144,14 @@ class Pool
 	// make sure of that.
 	love::thread::MutexRef mutex;
 
+	// Separate from the shared WorkerPool, so long jobs from other modules
+	// can't delay decoding.
+	love::thread::WorkerPool *decodeWorkers;
+
+	love::thread::MutexRef updateMutex;
+	love::thread::ConditionalRef updateCond;
+	bool updateRequested = false;
+
 }; // Pool
 
 } // openal
@@ -23,10 +23,12 @@
 #include "Pool.h"
 #include "Audio.h"
 #include "common/math.h"
+#include "timer/Timer.h"
 
 // STD
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 
 #define audiomodule() (Module::getInstance<Audio>(Module::M_AUDIO))
 
@@ -141,6 +143,24 @@ Source::Source(Pool *pool, love::sound::SoundData *soundData)
 		slotlist.push(i);
 }
 
+Source::Source(Pool *pool, StaticDataBuffer *buffer, int sampleRate, int bitDepth, int channels)
+	: love::audio::Source(Source::TYPE_STATIC)
+	, pool(pool)
+	, staticBuffer(buffer)
+	, sampleRate(sampleRate)
+	, channels(channels)
+	, bitDepth(bitDepth)
+{
+	float z[3] = {0, 0, 0};
+
+	setFloatv(position, z);
+	setFloatv(velocity, z);
+	setFloatv(direction, z);
+
+	for (int i = 0; i < audiomodule()->getMaxSourceEffects(); i++)
+		slotlist.push(i);
+}
+
 Source::Source(Pool *pool, love::sound::Decoder *decoder)
 	: love::audio::Source(Source::TYPE_STREAM)
 	, pool(pool)
@@ -370,8 +390,12 @@ bool Source::isFinished() const
 	if (!valid)
 		return false;
 
-	if (sourceType == TYPE_STREAM && (isLooping() || !decoder->isFinished()))
-		return false;
+	if (sourceType == TYPE_STREAM)
+	{
+		Lock l(decoderMutex);
+		if (isLooping() || !decoder->isFinished() || decodedAheadCount > 0)
+			return false;
+	}
 
 	ALenum state;
 	alGetSourcei(source, AL_SOURCE_STATE, &state);
@@ -395,6 +419,11 @@ bool Source::update()
 		case TYPE_STREAM:
 			if (!isFinished())
 			{
+				// OpenAL stops a streaming source which runs out of queued
+				// buffers. It's restarted once they're refilled.
+				ALint state;
+				alGetSourcei(source, AL_SOURCE_STATE, &state);
+
 				ALint processed;
 				alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
 
@@ -437,6 +466,18 @@ bool Source::update()
 						break;
 				}
 
+				if (state == AL_STOPPED)
+				{
+					ALint queued;
+					alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+
+					if (queued > 0)
+					{
+						underrunCount++;
+						alSourcePlay(source);
+					}
+				}
+
 				return true;
 			}
 			return false;
@@ -542,7 +583,11 @@ void Source::seek(double offset, Source::Unit unit)
 			if (valid)
 				stop();
 
-			decoder->seek(offsetSeconds);
+			{
+				Lock dl(decoderMutex);
+				decoder->seek(offsetSeconds);
+				decodedAheadFirst = decodedAheadCount = 0;
+			}
 
 			if (wasPlaying)
 				play();
@@ -626,6 +671,7 @@ double Source::getDuration(Unit unit)
 	}
 	case TYPE_STREAM:
 	{
+		Lock dl(decoderMutex);
 		double seconds = decoder->getDuration();
 
 		if (unit == UNIT_SECONDS)
@@ -851,6 +897,7 @@ void Source::prepareAtomic()
 			alSourceQueueBuffers(source, 1, &b);
 			unusedBuffers.pop();
 
+			Lock dl(decoderMutex);
 			if (decoder->isFinished())
 				break;
 		}
@@ -884,7 +931,11 @@ void Source::teardownAtomic()
 		ALuint buffers[MAX_BUFFERS];
 
 		// Some decoders (e.g. ModPlug) can rewind() more reliably than seek(0).
-		decoder->rewind();
+		{
+			Lock dl(decoderMutex);
+			decoder->rewind();
+			decodedAheadFirst = decodedAheadCount = 0;
+		}
 
 		// Drain buffers.
 		// NOTE: The Apple implementation of OpenAL on iOS doesn't return
@@ -1146,8 +1197,25 @@ void Source::setFloatv(float *dst, const float *src) const
 
 int Source::streamAtomic(ALuint buffer, love::sound::Decoder *d)
 {
-	// Get more sound data.
-	int decoded = std::max(d->decode(), 0);
+	Lock l(decoderMutex);
+
+	// Get more sound data, preferably what the decode workers already decoded.
+	const void *samples = d->getBuffer();
+	int decoded = 0;
+
+	if (decodedAheadCount > 0)
+	{
+		samples = &decodedAheadData[decodedAheadFirst * d->getSize()];
+		decoded = decodedAheadSizes[decodedAheadFirst];
+		decodedAheadFirst = (decodedAheadFirst + 1) % DECODE_AHEAD_BUFFERS;
+		decodedAheadCount--;
+	}
+	else
+	{
+		double start = love::timer::Timer::getTime();
+		decoded = std::max(d->decode(), 0);
+		decodeTime += love::timer::Timer::getTime() - start;
+	}
 
 	// OpenAL implementations are allowed to ignore 0-size alBufferData calls.
 	if (decoded > 0)
@@ -1155,12 +1223,12 @@ int Source::streamAtomic(ALuint buffer, love::sound::Decoder *d)
 		int fmt = Audio::getFormat(d->getBitDepth(), d->getChannelCount());
 
 		if (fmt != AL_NONE)
-			alBufferData(buffer, fmt, d->getBuffer(), decoded, d->getSampleRate());
+			alBufferData(buffer, fmt, samples, decoded, d->getSampleRate());
 		else
 			decoded = 0;
 	}
 
-	if (decoder->isFinished() && isLooping())
+	if (decoder->isFinished() && decodedAheadCount == 0 && isLooping())
 	{
 		int queued, processed;
 		alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
@@ -1183,6 +1251,95 @@ int Source::streamAtomic(ALuint buffer, love::sound::Decoder *d)
 	return decoded;
 }
 
+void Source::decodeAhead()
+{
+	if (sourceType != TYPE_STREAM)
+		return;
+
+	Lock l(decoderMutex);
+
+	size_t buffersize = decoder->getSize();
+	if (decodedAheadData.size() < buffersize * DECODE_AHEAD_BUFFERS)
+		decodedAheadData.resize(buffersize * DECODE_AHEAD_BUFFERS);
+
+	// Looping Sources are rewound by streamAtomic, once the buffers decoded
+	// before the end have been used.
+	while (decodedAheadCount < DECODE_AHEAD_BUFFERS && !decoder->isFinished())
+	{
+		double start = love::timer::Timer::getTime();
+		int decoded = std::max(decoder->decode(), 0);
+		decodeTime += love::timer::Timer::getTime() - start;
+
+		if (decoded == 0)
+			break;
+
+		int index = (decodedAheadFirst + decodedAheadCount) % DECODE_AHEAD_BUFFERS;
+		memcpy(&decodedAheadData[index * buffersize], decoder->getBuffer(), decoded);
+		decodedAheadSizes[index] = decoded;
+		decodedAheadCount++;
+	}
+}
+
+double Source::getDecodeTime() const
+{
+	Lock l(decoderMutex);
+	return decodeTime;
+}
+
+int Source::getUnderrunCount() const
+{
+	Lock l = pool->lock();
+	return underrunCount;
+}
+
+int Source::getUpdateDelay() const
+{
+	if (!valid)
+		return 0;
+
+	ALint state;
+	alGetSourcei(source, AL_SOURCE_STATE, &state);
+
+	if (state != AL_PLAYING)
+		return -1;
+
+	ALint offset = 0;
+	int remaining = 0;
+
+	switch (sourceType)
+	{
+	case TYPE_STATIC:
+	{
+		if (isLooping())
+			return -1;
+
+		alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+		remaining = (staticBuffer->getSize() / channels) / (bitDepth / 8) - offset;
+		break;
+	}
+	case TYPE_STREAM:
+	{
+		// Wake up once the first queued buffer has been played, so it can be
+		// refilled.
+		ALint processed = 0;
+		alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+
+		if (processed > 0)
+			return 0;
+
+		alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+		remaining = (decoder->getSize() / channels) / (bitDepth / 8) - offset;
+		break;
+	}
+	case TYPE_QUEUE:
+		return QUEUE_UPDATE_DELAY;
+	case TYPE_MAX_ENUM:
+		return -1;
+	}
+
+	return std::max((int) (remaining * 1000.0 / (sampleRate * pitch)), 0);
+}
+
 void Source::setMinVolume(float volume)
 {
 	if (valid)
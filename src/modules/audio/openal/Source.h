@@ -28,6 +28,7 @@
 #include "audio/Filter.h"
 #include "sound/SoundData.h"
 #include "sound/Decoder.h"
+#include "thread/threads.h"
 #include "Audio.h"
 #include "Filter.h"
 
@@ -101,6 +102,7 @@ class Source : public love::audio::Source
 	Source(Pool *pool, love::sound::SoundData *soundData);
 	Source(Pool *pool, love::sound::Decoder *decoder);
 	Source(Pool *pool, int sampleRate, int bitDepth, int channels, int buffers);
+	Source(Pool *pool, StaticDataBuffer *buffer, int sampleRate, int bitDepth, int channels);
 	Source(const Source &s);
 	virtual ~Source();
 
@@ -156,6 +158,8 @@ class Source : public love::audio::Source
 
 	virtual int getFreeBufferCount() const;
 	virtual bool queue(void *data, size_t length, int dataSampleRate, int dataBitDepth, int dataChannels);
+	virtual double getDecodeTime() const;
+	virtual int getUnderrunCount() const;
 
 	void prepareAtomic();
 	void teardownAtomic();
@@ -172,6 +176,26 @@ class Source : public love::audio::Source
 	static std::vector<love::audio::Source*> pause(Pool *pool);
 	static void stop(Pool *pool);
 
+	/**
+	 * Gets the OpenAL buffer of a static Source, which may be shared with
+	 * other Sources.
+	 **/
+	StaticDataBuffer *getStaticBuffer() const { return staticBuffer.get(); }
+
+	/**
+	 * Fills a streaming Source's ring of buffers decoded ahead of time. Called
+	 * by the Pool's decode workers without holding the Pool's lock, so the
+	 * lock is only needed for the (quick) hand-off to OpenAL in update().
+	 **/
+	void decodeAhead();
+
+	/**
+	 * Gets the time in milliseconds until this Source needs another update,
+	 * based on how much of its queued audio is left. Returns -1 if there's no
+	 * particular deadline.
+	 **/
+	int getUpdateDelay() const;
+
 private:
 
 	void reset();
@@ -186,6 +210,10 @@ class Source : public love::audio::Source
 
 	const static int DEFAULT_BUFFERS = 8;
 	const static int MAX_BUFFERS = 64;
+
+	// Queueable Sources are usually fed small buffers just in time, so their
+	// processed buffers are reclaimed often.
+	const static int QUEUE_UPDATE_DELAY = 5;
 	std::queue<ALuint> streamBuffers;
 	std::stack<ALuint> unusedBuffers;
 
@@ -221,6 +249,21 @@ class Source : public love::audio::Source
 
 	StrongRef<love::sound::Decoder> decoder;
 
+	// Number of buffers a streaming Source decodes ahead of time.
+	const static int DECODE_AHEAD_BUFFERS = 2;
+
+	// Guards the decoder, the ring of buffers decoded ahead of time and the
+	// decode time. May be locked while holding the Pool's lock, but not the
+	// other way around.
+	love::thread::MutexRef decoderMutex;
+	std::vector<char> decodedAheadData;
+	int decodedAheadSizes[DECODE_AHEAD_BUFFERS];
+	int decodedAheadFirst = 0;
+	int decodedAheadCount = 0;
+	double decodeTime = 0.0;
+
+	int underrunCount = 0;
+
 	unsigned int toLoop = 0;
 	ALsizei bufferedBytes = 0;
 	int buffers = 0;
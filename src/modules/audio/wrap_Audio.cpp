@@ -25,6 +25,8 @@
 #include "null/Audio.h"
 
 #include "common/runtime.h"
+#include "filesystem/wrap_Filesystem.h"
+#include "sound/wrap_Sound.h"
 
 // C++
 #include <iostream>
@@ -57,6 +59,43 @@ int w_newSource(lua_State *L)
 			return luaL_error(L, "Cannot create queueable sources using newSource. Use newQueueableSource instead.");
 	}
 
+	// Large uncompressed WAV files on disk are used in place. They still share
+	// the static sound cache with other files, unless they are streamed.
+	if (stype == Source::TYPE_STATIC)
+	{
+		love::sound::SoundData *s = love::sound::luax_newmappedsounddata(L, 1);
+
+		if (s != nullptr)
+		{
+			Source *t = nullptr;
+
+			luax_catchexcept(L,
+				[&]() { t = instance()->newSource(s); },
+				[&](bool) { s->release(); }
+			);
+
+			luax_pushtype(L, t);
+			t->release();
+			return 1;
+		}
+	}
+
+	// Static Sources from files share their decoded audio through a cache.
+	if (stype == Source::TYPE_STATIC && love::filesystem::luax_cangetfiledata(L, 1))
+	{
+		love::filesystem::FileData *fd = love::filesystem::luax_getfiledata(L, 1);
+		Source *t = nullptr;
+
+		luax_catchexcept(L,
+			[&]() { t = instance()->newSource(fd); },
+			[&](bool) { fd->release(); }
+		);
+
+		luax_pushtype(L, t);
+		t->release();
+		return 1;
+	}
+
 	if (lua_isstring(L, 1) || luax_istype(L, 1, love::filesystem::File::type) || luax_istype(L, 1, love::filesystem::FileData::type))
 		luax_convobj(L, 1, "sound", "newDecoder");
 
@@ -100,6 +139,19 @@ int w_newQueueableSource(lua_State *L)
 		return 0; //all argument type errors are checked in above constructor
 }
 
+int w_newVoiceBank(lua_State *L)
+{
+	int maxVoices = (int) luaL_optinteger(L, 1, VoiceBank::DEFAULT_MAX_VOICES);
+	int sampleRate = (int) luaL_optinteger(L, 2, love::sound::Decoder::DEFAULT_SAMPLE_RATE);
+
+	VoiceBank *t = nullptr;
+	luax_catchexcept(L, [&]() { t = new VoiceBank(maxVoices, sampleRate); });
+
+	luax_pushtype(L, t);
+	t->release();
+	return 1;
+}
+
 static std::vector<Source*> readSourceList(lua_State *L, int n)
 {
 	if (n < 0)
@@ -530,6 +582,56 @@ int w_setMixWithSystem(lua_State *L)
 	return 1;
 }
 
+int w_getSoundCacheStats(lua_State *L)
+{
+	Audio::SoundCacheStats stats = instance()->getSoundCacheStats();
+
+	if (lua_istable(L, 1))
+		lua_pushvalue(L, 1);
+	else
+		lua_createtable(L, 0, 4);
+
+	lua_pushinteger(L, stats.sounds);
+	lua_setfield(L, -2, "sounds");
+
+	lua_pushnumber(L, (lua_Number) stats.memory);
+	lua_setfield(L, -2, "memory");
+
+	lua_pushnumber(L, (lua_Number) stats.hits);
+	lua_setfield(L, -2, "hits");
+
+	lua_pushnumber(L, (lua_Number) stats.misses);
+	lua_setfield(L, -2, "misses");
+
+	return 1;
+}
+
+int w_setSoundCacheLimit(lua_State *L)
+{
+	int64 bytes = (int64) luaL_checknumber(L, 1);
+	instance()->setSoundCacheLimit(bytes);
+	return 0;
+}
+
+int w_getSoundCacheLimit(lua_State *L)
+{
+	lua_pushnumber(L, (lua_Number) instance()->getSoundCacheLimit());
+	return 1;
+}
+
+int w_setStaticStreamingThreshold(lua_State *L)
+{
+	int64 bytes = (int64) luaL_checknumber(L, 1);
+	instance()->setStaticStreamingThreshold(bytes);
+	return 0;
+}
+
+int w_getStaticStreamingThreshold(lua_State *L)
+{
+	lua_pushnumber(L, (lua_Number) instance()->getStaticStreamingThreshold());
+	return 1;
+}
+
 int w_getSourceCount(lua_State *L)
 {
 	luax_markdeprecated(L, "love.audio.getSourceCount", API_FUNCTION, DEPRECATED_RENAMED, "love.audio.getActiveSourceCount");
@@ -542,6 +644,7 @@ static const luaL_Reg functions[] =
 	{ "getActiveSourceCount", w_getActiveSourceCount },
 	{ "newSource", w_newSource },
 	{ "newQueueableSource", w_newQueueableSource },
+	{ "newVoiceBank", w_newVoiceBank },
 	{ "play", w_play },
 	{ "stop", w_stop },
 	{ "pause", w_pause },
@@ -567,6 +670,11 @@ static const luaL_Reg functions[] =
 	{ "getMaxSourceEffects", w_getMaxSourceEffects },
 	{ "isEffectsSupported", w_isEffectsSupported },
 	{ "setMixWithSystem", w_setMixWithSystem },
+	{ "getSoundCacheStats", w_getSoundCacheStats },
+	{ "setSoundCacheLimit", w_setSoundCacheLimit },
+	{ "getSoundCacheLimit", w_getSoundCacheLimit },
+	{ "setStaticStreamingThreshold", w_setStaticStreamingThreshold },
+	{ "getStaticStreamingThreshold", w_getStaticStreamingThreshold },
 
 	// Deprecated
 	{ "getSourceCount", w_getSourceCount },
@@ -578,6 +686,7 @@ static const lua_CFunction types[] =
 {
 	luaopen_source,
 	luaopen_recordingdevice,
+	luaopen_voicebank,
 	0
 };
 
@@ -27,6 +27,7 @@
 #include "Audio.h"
 #include "wrap_Source.h"
 #include "wrap_RecordingDevice.h"
+#include "wrap_VoiceBank.h"
 
 namespace love
 {
@@ -538,6 +538,20 @@ int w_Source_getFreeBufferCount(lua_State *L)
 	return 1;
 }
 
+int w_Source_getDecodeTime(lua_State *L)
+{
+	Source *t = luax_checksource(L, 1);
+	lua_pushnumber(L, t->getDecodeTime());
+	return 1;
+}
+
+int w_Source_getUnderrunCount(lua_State *L)
+{
+	Source *t = luax_checksource(L, 1);
+	lua_pushinteger(L, t->getUnderrunCount());
+	return 1;
+}
+
 int w_Source_queue(lua_State *L)
 {
 	Source *t = luax_checksource(L, 1);
@@ -659,6 +673,8 @@ static const luaL_Reg w_Source_functions[] =
 
 	{ "getFreeBufferCount", w_Source_getFreeBufferCount },
 	{ "queue", w_Source_queue },
+	{ "getDecodeTime", w_Source_getDecodeTime },
+	{ "getUnderrunCount", w_Source_getUnderrunCount },
 
 	{ "getType", w_Source_getType },
 
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "wrap_VoiceBank.h"
+
+#include "sound/wrap_Decoder.h"
+#include "sound/wrap_SoundData.h"
+
+namespace love
+{
+namespace audio
+{
+
+VoiceBank *luax_checkvoicebank(lua_State *L, int idx)
+{
+	return luax_checktype<VoiceBank>(L, idx);
+}
+
+int w_VoiceBank_play(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+	love::sound::SoundData *s = love::sound::luax_checksounddata(L, 2);
+	float volume = (float) luaL_optnumber(L, 3, 1.0);
+	float pitch = (float) luaL_optnumber(L, 4, 1.0);
+	float pan = (float) luaL_optnumber(L, 5, 0.0);
+	bool looping = luax_optboolean(L, 6, false);
+
+	int voice = 0;
+	luax_catchexcept(L, [&]() { voice = t->play(s, volume, pitch, pan, looping); });
+
+	lua_pushinteger(L, voice);
+	return 1;
+}
+
+int w_VoiceBank_stop(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+
+	if (lua_isnoneornil(L, 2))
+		t->stopAll();
+	else
+		t->stop((int) luaL_checkinteger(L, 2));
+
+	return 0;
+}
+
+int w_VoiceBank_isPlaying(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+	luax_pushboolean(L, t->isPlaying((int) luaL_checkinteger(L, 2)));
+	return 1;
+}
+
+int w_VoiceBank_setVolume(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+	int voice = (int) luaL_checkinteger(L, 2);
+	float volume = (float) luaL_checknumber(L, 3);
+	luax_catchexcept(L, [&]() { t->setVolume(voice, volume); });
+	return 0;
+}
+
+int w_VoiceBank_setPitch(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+	int voice = (int) luaL_checkinteger(L, 2);
+	float pitch = (float) luaL_checknumber(L, 3);
+	luax_catchexcept(L, [&]() { t->setPitch(voice, pitch); });
+	return 0;
+}
+
+int w_VoiceBank_setPan(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+	int voice = (int) luaL_checkinteger(L, 2);
+	float pan = (float) luaL_checknumber(L, 3);
+	t->setPan(voice, pan);
+	return 0;
+}
+
+int w_VoiceBank_getActiveVoiceCount(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+	lua_pushinteger(L, t->getActiveVoiceCount());
+	return 1;
+}
+
+int w_VoiceBank_getMaxVoices(lua_State *L)
+{
+	VoiceBank *t = luax_checkvoicebank(L, 1);
+	lua_pushinteger(L, t->getMaxVoices());
+	return 1;
+}
+
+static const luaL_Reg w_VoiceBank_functions[] =
+{
+	{ "play", w_VoiceBank_play },
+	{ "stop", w_VoiceBank_stop },
+	{ "isPlaying", w_VoiceBank_isPlaying },
+	{ "setVolume", w_VoiceBank_setVolume },
+	{ "setPitch", w_VoiceBank_setPitch },
+	{ "setPan", w_VoiceBank_setPan },
+	{ "getActiveVoiceCount", w_VoiceBank_getActiveVoiceCount },
+	{ "getMaxVoices", w_VoiceBank_getMaxVoices },
+	{ 0, 0 }
+};
+
+extern "C" int luaopen_voicebank(lua_State *L)
+{
+	return luax_register_type(L, &VoiceBank::type, love::sound::w_Decoder_functions, w_VoiceBank_functions, nullptr);
+}
+
+} // audio
+} // love
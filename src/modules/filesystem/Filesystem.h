@@ -28,6 +28,7 @@
 #include "common/StringMap.h"
 #include "FileData.h"
 #include "File.h"
+#include "MappedFileData.h"
 
 // C++
 #include <string>
@@ -152,6 +153,17 @@ class Filesystem : public Module
 	 **/
 	virtual FileData *newFileData(const void *data, size_t size, const char *filename) const;
 
+	/**
+	 * Maps a file into memory instead of reading it. Only works for files
+	 * which are stored directly on disk in the game's source directory (or
+	 * the source's base directory, if the game is fused), rather than inside
+	 * an archive. Files in the save directory may be written to while mapped,
+	 * so they're never mapped.
+	 * @param filename The file to map.
+	 * @return The mapped file, or null if the file can't be mapped.
+	 **/
+	virtual MappedFileData *newMappedFileData(const char *filename) const = 0;
+
 	/**
 	 * Gets the current working directory.
 	 **/
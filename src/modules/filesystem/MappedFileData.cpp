@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "MappedFileData.h"
+#include "FileData.h"
+
+#if defined(LOVE_WINDOWS)
+#include <windows.h>
+#include "common/utf8.h"
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// C
+#include <cstring>
+
+namespace love
+{
+namespace filesystem
+{
+
+love::Type MappedFileData::type("MappedFileData", &Data::type);
+
+MappedFileData::MappedFileData(const std::string &path)
+	: data(nullptr)
+	, size(0)
+	, path(path)
+#ifdef LOVE_WINDOWS
+	, mapping(nullptr)
+#endif
+{
+#if defined(LOVE_WINDOWS_UWP)
+	throw love::Exception("Memory-mapped files are not supported on this platform.");
+#elif defined(LOVE_WINDOWS)
+	std::wstring wpath = to_widestr(path);
+
+	HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw love::Exception("Could not open file %s.", path.c_str());
+
+	LARGE_INTEGER filesize;
+	if (!GetFileSizeEx(file, &filesize) || filesize.QuadPart <= 0 || (uint64) filesize.QuadPart > (uint64) SIZE_MAX)
+	{
+		CloseHandle(file);
+		throw love::Exception("Could not map file %s: invalid file size.", path.c_str());
+	}
+
+	// The mapping object keeps its own reference to the file.
+	mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+
+	if (mapping == nullptr)
+		throw love::Exception("Could not map file %s.", path.c_str());
+
+	data = MapViewOfFile((HANDLE) mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle((HANDLE) mapping);
+		throw love::Exception("Could not map file %s.", path.c_str());
+	}
+
+	size = (size_t) filesize.QuadPart;
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw love::Exception("Could not open file %s.", path.c_str());
+
+	struct stat buf;
+	if (fstat(fd, &buf) != 0 || !S_ISREG(buf.st_mode) || buf.st_size <= 0 || (uint64) buf.st_size > (uint64) SIZE_MAX)
+	{
+		close(fd);
+		throw love::Exception("Could not map file %s: invalid file size.", path.c_str());
+	}
+
+	// A private writable mapping means pages are only copied if they're
+	// written to. The mapping stays valid after the descriptor is closed.
+	void *mem = mmap(nullptr, (size_t) buf.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mem == MAP_FAILED)
+		throw love::Exception("Could not map file %s.", path.c_str());
+
+	data = mem;
+	size = (size_t) buf.st_size;
+#endif
+}
+
+MappedFileData::~MappedFileData()
+{
+#if defined(LOVE_WINDOWS)
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != nullptr)
+		CloseHandle((HANDLE) mapping);
+#else
+	if (data != nullptr)
+		munmap(data, size);
+#endif
+}
+
+Data *MappedFileData::clone() const
+{
+	FileData *c = new FileData(size, path);
+	memcpy(c->getData(), data, size);
+	return c;
+}
+
+void *MappedFileData::getData() const
+{
+	return data;
+}
+
+size_t MappedFileData::getSize() const
+{
+	return size;
+}
+
+const std::string &MappedFileData::getPath() const
+{
+	return path;
+}
+
+} // filesystem
+} // love
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_FILESYSTEM_MAPPED_FILE_DATA_H
+#define LOVE_FILESYSTEM_MAPPED_FILE_DATA_H
+
+// LOVE
+#include "common/Data.h"
+#include "common/int.h"
+#include "common/Exception.h"
+
+#include <string>
+
+namespace love
+{
+namespace filesystem
+{
+
+/**
+ * The contents of a file on disk, mapped into memory instead of being read.
+ * Pages are only loaded when they're accessed, and the OS can drop them again
+ * under memory pressure. The mapping is private: writes to the data are not
+ * visible in the file.
+ *
+ * The file must not be changed while it's mapped: on Windows other programs
+ * can't open it for writing, and elsewhere truncating it makes accessing the
+ * data crash. Filesystem::newMappedFileData only maps the game's own files
+ * for that reason.
+ **/
+class MappedFileData : public Data
+{
+public:
+
+	static love::Type type;
+
+	/**
+	 * @param path The full (OS-dependent) path to the file.
+	 **/
+	MappedFileData(const std::string &path);
+	virtual ~MappedFileData();
+
+	// Implements Data. The clone is a regular FileData.
+	Data *clone() const;
+	void *getData() const;
+	size_t getSize() const;
+
+	const std::string &getPath() const;
+
+private:
+
+	void *data;
+	size_t size;
+
+	std::string path;
+
+#ifdef LOVE_WINDOWS
+	void *mapping;
+#endif
+
+}; // MappedFileData
+
+} // filesystem
+} // love
+
+#endif // LOVE_FILESYSTEM_MAPPED_FILE_DATA_H
@@ -451,6 +451,49 @@ love::filesystem::File *Filesystem::newFile(const char *filename) const
 	return new File(filename);
 }
 
+MappedFileData *Filesystem::newMappedFileData(const char *filename) const
+{
+	if (!PHYSFS_isInit())
+		throw love::Exception("PhysFS is not initialized.");
+
+	const char *dir = PHYSFS_getRealDir(filename);
+
+	// Files inside archives have no path of their own on disk.
+	if (dir == nullptr || !isRealDirectory(dir))
+		return nullptr;
+
+	// Only the game's own files are mapped. Files in the save directory (or
+	// other mounted directories) can be truncated or rewritten while they're
+	// mapped, which crashes on POSIX systems and fails on Windows.
+	if (game_source.compare(dir) != 0 && !(isFused() && getSourceBaseDirectory().compare(dir) == 0))
+		return nullptr;
+
+	// Paths in the search path are relative to the directory's mount point.
+	std::string path = filename;
+	std::string mountpoint = PHYSFS_getMountPoint(dir) ? PHYSFS_getMountPoint(dir) : "";
+
+	while (!path.empty() && path[0] == '/')
+		path.erase(0, 1);
+	while (!mountpoint.empty() && mountpoint[0] == '/')
+		mountpoint.erase(0, 1);
+
+	if (!mountpoint.empty())
+	{
+		if (path.compare(0, mountpoint.size(), mountpoint) != 0)
+			return nullptr;
+		path.erase(0, mountpoint.size());
+	}
+
+	try
+	{
+		return new MappedFileData(std::string(dir) + LOVE_PATH_SEPARATOR + path);
+	}
+	catch (love::Exception &)
+	{
+		return nullptr;
+	}
+}
+
 const char *Filesystem::getWorkingDirectory()
 {
 	if (cwd.empty())
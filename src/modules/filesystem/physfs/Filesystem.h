@@ -67,6 +67,7 @@ class Filesystem final : public love::filesystem::Filesystem
 	bool unmount(Data *data) override;
 
 	love::filesystem::File *newFile(const char *filename) const override;
+	MappedFileData *newMappedFileData(const char *filename) const override;
 
 	const char *getWorkingDirectory() override;
 	std::string getUserDirectory() override;
@@ -291,6 +291,25 @@ bool luax_cangetfiledata(lua_State *L, int idx)
 	return lua_isstring(L, idx) || luax_istype(L, idx, File::type) || luax_istype(L, idx, FileData::type);
 }
 
+MappedFileData *luax_getmappedfiledata(lua_State *L, int idx)
+{
+	std::string filename;
+
+	if (lua_isstring(L, idx))
+		filename = lua_tostring(L, idx);
+	else if (luax_istype(L, idx, File::type))
+		filename = luax_checkfile(L, idx)->getFilename();
+	else
+		return nullptr;
+
+	if (instance() == nullptr)
+		return nullptr;
+
+	MappedFileData *data = nullptr;
+	luax_catchexcept(L, [&]() { data = instance()->newMappedFileData(filename.c_str()); });
+	return data;
+}
+
 bool luax_cangetdata(lua_State *L, int idx)
 {
 	return lua_isstring(L, idx) || luax_istype(L, idx, File::type) || luax_istype(L, idx, Data::type);
@@ -25,6 +25,7 @@
 #include "common/runtime.h"
 #include "File.h"
 #include "FileData.h"
+#include "MappedFileData.h"
 
 namespace love
 {
@@ -40,6 +41,7 @@ namespace filesystem
  **/
 FileData *luax_getfiledata(lua_State *L, int idx);
 bool luax_cangetfiledata(lua_State *L, int idx);
+MappedFileData *luax_getmappedfiledata(lua_State *L, int idx);
 File *luax_getfile(lua_State *L, int idx);
 
 Data *luax_getdata(lua_State *L, int idx);
@@ -42,16 +42,16 @@ class DefaultFontData : public love::Data
 	size_t getSize() const override { return sizeof(Vera_ttf); }
 };
 
-Rasterizer *Font::newTrueTypeRasterizer(int size, TrueTypeRasterizer::Hinting hinting)
+Rasterizer *Font::newTrueTypeRasterizer(int size, TrueTypeRasterizer::Hinting hinting, TrueTypeRasterizer::RenderMode rendermode)
 {
 	StrongRef<DefaultFontData> data(new DefaultFontData, Acquire::NORETAIN);
-	return newTrueTypeRasterizer(data.get(), size, hinting);
+	return newTrueTypeRasterizer(data.get(), size, hinting, rendermode);
 }
 
-Rasterizer *Font::newTrueTypeRasterizer(int size, float dpiscale, TrueTypeRasterizer::Hinting hinting)
+Rasterizer *Font::newTrueTypeRasterizer(int size, float dpiscale, TrueTypeRasterizer::Hinting hinting, TrueTypeRasterizer::RenderMode rendermode)
 {
 	StrongRef<DefaultFontData> data(new DefaultFontData, Acquire::NORETAIN);
-	return newTrueTypeRasterizer(data.get(), size, dpiscale, hinting);
+	return newTrueTypeRasterizer(data.get(), size, dpiscale, hinting, rendermode);
 }
 
 Rasterizer *Font::newBMFontRasterizer(love::filesystem::FileData *fontdef, const std::vector<image::ImageData *> &images, float dpiscale)
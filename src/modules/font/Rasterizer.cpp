@@ -97,15 +97,38 @@ bool Rasterizer::hasGlyphs(const std::string &text) const
 	return true;
 }
 
+int Rasterizer::getGlyphAdvance(uint32 glyph) const
+{
+	GlyphData *gd = getGlyphData(glyph);
+	int advance = gd->getAdvance();
+	gd->release();
+	return advance;
+}
+
 float Rasterizer::getKerning(uint32 /*leftglyph*/, uint32 /*rightglyph*/) const
 {
 	return 0.0f;
 }
 
+bool Rasterizer::isDistanceField() const
+{
+	return false;
+}
+
+std::string Rasterizer::getCacheKey() const
+{
+	return std::string();
+}
+
 float Rasterizer::getDPIScale() const
 {
 	return dpiScale;
 }
 
+love::thread::Mutex *Rasterizer::getMutex() const
+{
+	return mutex;
+}
+
 } // font
 } // love
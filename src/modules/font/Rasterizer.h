@@ -24,6 +24,7 @@
 // LOVE
 #include "common/Object.h"
 #include "common/int.h"
+#include "thread/threads.h"
 #include "GlyphData.h"
 
 namespace love
@@ -96,6 +97,13 @@ class Rasterizer : public Object
 	 **/
 	virtual GlyphData *getGlyphData(const std::string &text) const;
 
+	/**
+	 * Gets the horizontal advance of a specific glyph, without necessarily
+	 * rendering it.
+	 * @param glyph The (UNICODE) glyph codepoint.
+	 **/
+	virtual int getGlyphAdvance(uint32 glyph) const;
+
 	/**
 	 * Gets the number of glyphs the rasterizer has data for.
 	 **/
@@ -120,13 +128,39 @@ class Rasterizer : public Object
 
 	virtual DataType getDataType() const = 0;
 
+	/**
+	 * Gets whether the glyphs' alpha holds a signed distance field (0.5 on
+	 * the outline, increasing inside it) rather than coverage. Distance field
+	 * glyphs can be scaled without blurring, using a matching shader.
+	 **/
+	virtual bool isDistanceField() const;
+
+	/**
+	 * Gets a string which identifies the glyphs this Rasterizer produces, so
+	 * they can be cached across runs. Returns an empty string if the glyphs
+	 * can't be cached.
+	 **/
+	virtual std::string getCacheKey() const;
+
 	float getDPIScale() const;
 
+	/**
+	 * Rasterizers aren't thread-safe. Code which may use one at the same time
+	 * as another thread (for example a Font's asynchronous glyph loading, when
+	 * the Rasterizer is shared with other Fonts) must hold this mutex while
+	 * calling its methods.
+	 **/
+	love::thread::Mutex *getMutex() const;
+
 protected:
 
 	FontMetrics metrics;
 	float dpiScale;
 
+private:
+
+	love::thread::MutexRef mutex;
+
 }; // Rasterizer
 
 } // font
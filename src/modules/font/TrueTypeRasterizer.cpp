@@ -40,6 +40,21 @@ std::vector<std::string> TrueTypeRasterizer::getConstants(Hinting)
 	return hintings.getNames();
 }
 
+bool TrueTypeRasterizer::getConstant(const char *in, RenderMode &out)
+{
+	return renderModes.find(in, out);
+}
+
+bool TrueTypeRasterizer::getConstant(RenderMode in, const char *&out)
+{
+	return renderModes.find(in, out);
+}
+
+std::vector<std::string> TrueTypeRasterizer::getConstants(RenderMode)
+{
+	return renderModes.getNames();
+}
+
 StringMap<TrueTypeRasterizer::Hinting, TrueTypeRasterizer::HINTING_MAX_ENUM>::Entry TrueTypeRasterizer::hintingEntries[] =
 {
 	{"normal", HINTING_NORMAL},
@@ -50,5 +65,13 @@ StringMap<TrueTypeRasterizer::Hinting, TrueTypeRasterizer::HINTING_MAX_ENUM>::En
 
 StringMap<TrueTypeRasterizer::Hinting, TrueTypeRasterizer::HINTING_MAX_ENUM> TrueTypeRasterizer::hintings(TrueTypeRasterizer::hintingEntries, sizeof(TrueTypeRasterizer::hintingEntries));
 
+StringMap<TrueTypeRasterizer::RenderMode, TrueTypeRasterizer::RENDER_MAX_ENUM>::Entry TrueTypeRasterizer::renderModeEntries[] =
+{
+	{"normal", RENDER_NORMAL},
+	{"sdf", RENDER_SDF},
+};
+
+StringMap<TrueTypeRasterizer::RenderMode, TrueTypeRasterizer::RENDER_MAX_ENUM> TrueTypeRasterizer::renderModes(TrueTypeRasterizer::renderModeEntries, sizeof(TrueTypeRasterizer::renderModeEntries));
+
 } // font
 } // love
@@ -44,17 +44,32 @@ class TrueTypeRasterizer : public Rasterizer
 		HINTING_MAX_ENUM
 	};
 
+	// What TrueType glyph pixels hold.
+	enum RenderMode
+	{
+		RENDER_NORMAL, // Coverage of the glyph outline.
+		RENDER_SDF,    // Signed distance to the glyph outline.
+		RENDER_MAX_ENUM
+	};
+
 	virtual ~TrueTypeRasterizer() {}
 
 	static bool getConstant(const char *in, Hinting &out);
 	static bool getConstant(Hinting in, const char *&out);
 	static std::vector<std::string> getConstants(Hinting);
 
+	static bool getConstant(const char *in, RenderMode &out);
+	static bool getConstant(RenderMode in, const char *&out);
+	static std::vector<std::string> getConstants(RenderMode);
+
 private:
 
 	static StringMap<Hinting, HINTING_MAX_ENUM>::Entry hintingEntries[];
 	static StringMap<Hinting, HINTING_MAX_ENUM> hintings;
 
+	static StringMap<RenderMode, RENDER_MAX_ENUM>::Entry renderModeEntries[];
+	static StringMap<RenderMode, RENDER_MAX_ENUM> renderModes;
+
 }; // TrueTypeRasterizer
 
 } // font
@@ -49,26 +49,26 @@ Font::~Font()
 Rasterizer *Font::newRasterizer(love::filesystem::FileData *data)
 {
 	if (TrueTypeRasterizer::accepts(library, data))
-		return newTrueTypeRasterizer(data, 12, TrueTypeRasterizer::HINTING_NORMAL);
+		return newTrueTypeRasterizer(data, 12, TrueTypeRasterizer::HINTING_NORMAL, TrueTypeRasterizer::RENDER_NORMAL);
 	else if (BMFontRasterizer::accepts(data))
 		return newBMFontRasterizer(data, {}, 1.0f);
 
 	throw love::Exception("Invalid font file: %s", data->getFilename().c_str());
 }
 
-Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, TrueTypeRasterizer::Hinting hinting)
+Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, TrueTypeRasterizer::Hinting hinting, TrueTypeRasterizer::RenderMode rendermode)
 {
 	float dpiscale = 1.0f;
 	auto window = Module::getInstance<window::Window>(Module::M_WINDOW);
 	if (window != nullptr)
 		dpiscale = window->getDPIScale();
 
-	return newTrueTypeRasterizer(data, size, dpiscale, hinting);
+	return newTrueTypeRasterizer(data, size, dpiscale, hinting, rendermode);
 }
 
-Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, float dpiscale, TrueTypeRasterizer::Hinting hinting)
+Rasterizer *Font::newTrueTypeRasterizer(love::Data *data, int size, float dpiscale, TrueTypeRasterizer::Hinting hinting, TrueTypeRasterizer::RenderMode rendermode)
 {
-	return new TrueTypeRasterizer(library, data, size, dpiscale, hinting);
+	return new TrueTypeRasterizer(library, data, size, dpiscale, hinting, rendermode);
 }
 
 const char *Font::getName() const
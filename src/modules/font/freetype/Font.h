@@ -45,8 +45,8 @@ class Font : public love::font::Font
 
 	// Implements Font
 	Rasterizer *newRasterizer(love::filesystem::FileData *data) override;
-	Rasterizer *newTrueTypeRasterizer(love::Data *data, int size, TrueTypeRasterizer::Hinting hinting) override;
-	Rasterizer *newTrueTypeRasterizer(love::Data *data, int size, float dpiscale, TrueTypeRasterizer::Hinting hinting) override;
+	Rasterizer *newTrueTypeRasterizer(love::Data *data, int size, TrueTypeRasterizer::Hinting hinting, TrueTypeRasterizer::RenderMode rendermode) override;
+	Rasterizer *newTrueTypeRasterizer(love::Data *data, int size, float dpiscale, TrueTypeRasterizer::Hinting hinting, TrueTypeRasterizer::RenderMode rendermode) override;
 
 	// Implement Module
 	const char *getName() const override;
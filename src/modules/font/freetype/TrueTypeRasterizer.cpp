@@ -21,10 +21,17 @@
 // LOVE
 #include "TrueTypeRasterizer.h"
 #include "common/Exception.h"
+#include "data/HashFunction.h"
 
 // C
 #include <math.h>
 
+// C++
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <vector>
+
 namespace love
 {
 namespace font
@@ -32,9 +39,10 @@ namespace font
 namespace freetype
 {
 
-TrueTypeRasterizer::TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting)
+TrueTypeRasterizer::TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting, RenderMode rendermode)
 	: data(data)
 	, hinting(hinting)
+	, renderMode(rendermode)
 {
 	this->dpiScale = dpiscale;
 	size = floorf(size * dpiscale + 0.5f);
@@ -75,8 +83,235 @@ int TrueTypeRasterizer::getLineHeight() const
 	return (int)(getHeight() * 1.25);
 }
 
+// One-dimensional squared Euclidean distance transform of a sampled function,
+// from "Distance Transforms of Sampled Functions" (Felzenszwalb, Huttenlocher).
+// v, z are scratch space of at least n and n + 1 elements.
+static void distanceTransform1D(const double *f, double *d, int n, int *v, double *z)
+{
+	const double inf = std::numeric_limits<double>::infinity();
+
+	int k = 0;
+	v[0] = 0;
+	z[0] = -inf;
+	z[1] = inf;
+
+	for (int q = 1; q < n; q++)
+	{
+		double s = 0.0;
+
+		while (true)
+		{
+			int r = v[k];
+			s = ((f[q] + q * q) - (f[r] + r * r)) / (2.0 * (q - r));
+
+			if (s > z[k])
+				break;
+
+			k--;
+		}
+
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = inf;
+	}
+
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q)
+			k++;
+
+		int r = v[k];
+		d[q] = (q - r) * (q - r) + f[r];
+	}
+}
+
+// Replaces each value in the grid with the squared distance to the nearest
+// zero value (plus that value), by transforming columns and then rows.
+static void distanceTransform2D(std::vector<double> &grid, int width, int height)
+{
+	int n = std::max(width, height);
+
+	std::vector<double> f(n);
+	std::vector<double> d(n);
+	std::vector<double> z(n + 1);
+	std::vector<int> v(n);
+
+	for (int x = 0; x < width; x++)
+	{
+		for (int y = 0; y < height; y++)
+			f[y] = grid[y * width + x];
+
+		distanceTransform1D(f.data(), d.data(), height, v.data(), z.data());
+
+		for (int y = 0; y < height; y++)
+			grid[y * width + x] = d[y];
+	}
+
+	for (int y = 0; y < height; y++)
+	{
+		double *row = &grid[y * width];
+		std::copy(row, row + width, f.begin());
+
+		distanceTransform1D(f.data(), d.data(), width, v.data(), z.data());
+
+		std::copy(d.begin(), d.begin() + width, row);
+	}
+}
+
+static int floorDiv(int a, int b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+GlyphData *TrueTypeRasterizer::getDistanceFieldGlyphData(uint32 glyph) const
+{
+	love::font::GlyphMetrics glyphMetrics = {};
+	FT_Glyph ftglyph;
+
+	FT_Error err = FT_Err_Ok;
+
+	// Hinting is specific to the size glyphs are rendered at, which distance
+	// field glyphs aren't.
+	err = FT_Load_Glyph(face, FT_Get_Char_Index(face, glyph), FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING);
+
+	if (err != FT_Err_Ok)
+		throw love::Exception("TrueType Font glyph error: FT_Load_Glyph failed (0x%x)", err);
+
+	err = FT_Get_Glyph(face->glyph, &ftglyph);
+
+	if (err != FT_Err_Ok)
+		throw love::Exception("TrueType Font glyph error: FT_Get_Glyph failed (0x%x)", err);
+
+	glyphMetrics.advance = (int) (ftglyph->advance.x >> 16);
+
+	const int S = SDF_SUPERSAMPLE;
+
+	FT_Matrix scale = {S << 16, 0, 0, S << 16};
+	err = FT_Glyph_Transform(ftglyph, &scale, nullptr);
+
+	if (err == FT_Err_Ok)
+		err = FT_Glyph_To_Bitmap(&ftglyph, FT_RENDER_MODE_NORMAL, 0, 1);
+
+	if (err != FT_Err_Ok)
+	{
+		FT_Done_Glyph(ftglyph);
+		throw love::Exception("TrueType Font glyph error: could not render the glyph outline for a distance field (0x%x)", err);
+	}
+
+	FT_BitmapGlyph bitmap_glyph = (FT_BitmapGlyph) ftglyph;
+	const FT_Bitmap &bitmap = bitmap_glyph->bitmap;
+
+	int bitmapw = (int) bitmap.width;
+	int bitmaph = (int) bitmap.rows;
+
+	if (bitmapw == 0 || bitmaph == 0)
+	{
+		glyphMetrics.bearingX = floorDiv(bitmap_glyph->left, S);
+		glyphMetrics.bearingY = floorDiv(bitmap_glyph->top, S);
+
+		FT_Done_Glyph(ftglyph);
+		return new GlyphData(glyph, glyphMetrics, PIXELFORMAT_LA8);
+	}
+
+	// Align the supersampled bitmap within the grid so each output pixel
+	// covers exactly S*S grid cells, with the spread around the edges.
+	int left = floorDiv(bitmap_glyph->left, S);
+	int top = -floorDiv(-bitmap_glyph->top, S);
+	int offsetx = SDF_SPREAD * S + (bitmap_glyph->left - left * S);
+	int offsety = SDF_SPREAD * S + (top * S - bitmap_glyph->top);
+
+	int width = (offsetx + bitmapw + S - 1) / S + SDF_SPREAD;
+	int height = (offsety + bitmaph + S - 1) / S + SDF_SPREAD;
+
+	int gridw = width * S;
+	int gridh = height * S;
+
+	// Large but finite, so the distance transform never subtracts infinities.
+	const double inf = 1e20;
+
+	// Squared distances to the outline from outside and inside it. Partially
+	// covered pixels start out at a distance based on their coverage, which
+	// keeps the antialiased outline's subpixel position.
+	std::vector<double> outer(gridw * gridh, inf);
+	std::vector<double> inner(gridw * gridh, 0.0);
+
+	for (int y = 0; y < bitmaph; y++)
+	{
+		const uint8 *row = bitmap.buffer + y * bitmap.pitch;
+
+		for (int x = 0; x < bitmapw; x++)
+		{
+			double a = 0.0;
+			if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+				a = (row[x / 8] & (1 << (7 - (x % 8)))) ? 1.0 : 0.0;
+			else
+				a = row[x] / 255.0;
+
+			size_t i = (y + offsety) * gridw + (x + offsetx);
+
+			if (a >= 1.0)
+			{
+				outer[i] = 0.0;
+				inner[i] = inf;
+			}
+			else if (a > 0.0)
+			{
+				double d = 0.5 - a;
+				outer[i] = d > 0.0 ? d * d : 0.0;
+				inner[i] = d < 0.0 ? d * d : 0.0;
+			}
+		}
+	}
+
+	FT_Done_Glyph(ftglyph);
+
+	distanceTransform2D(outer, gridw, gridh);
+	distanceTransform2D(inner, gridw, gridh);
+
+	glyphMetrics.width = width;
+	glyphMetrics.height = height;
+	glyphMetrics.bearingX = left - SDF_SPREAD;
+	glyphMetrics.bearingY = top + SDF_SPREAD;
+
+	GlyphData *glyphData = new GlyphData(glyph, glyphMetrics, PIXELFORMAT_LA8);
+	uint8 *dest = (uint8 *) glyphData->getData();
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			// Average the signed distance over the grid cells of this pixel.
+			double dist = 0.0;
+
+			for (int sy = 0; sy < S; sy++)
+			{
+				for (int sx = 0; sx < S; sx++)
+				{
+					size_t i = (y * S + sy) * gridw + (x * S + sx);
+					dist += sqrt(outer[i]) - sqrt(inner[i]);
+				}
+			}
+
+			dist /= S * S * S;
+
+			double value = 0.5 - dist / (2.0 * SDF_SPREAD);
+			value = std::min(std::max(value, 0.0), 1.0);
+
+			dest[2 * (y * width + x) + 0] = 255;
+			dest[2 * (y * width + x) + 1] = (uint8) (value * 255.0 + 0.5);
+		}
+	}
+
+	return glyphData;
+}
+
 GlyphData *TrueTypeRasterizer::getGlyphData(uint32 glyph) const
 {
+	if (renderMode == RENDER_SDF)
+		return getDistanceFieldGlyphData(glyph);
+
 	love::font::GlyphMetrics glyphMetrics = {};
 	FT_Glyph ftglyph;
 
@@ -160,6 +395,21 @@ GlyphData *TrueTypeRasterizer::getGlyphData(uint32 glyph) const
 	return glyphData;
 }
 
+int TrueTypeRasterizer::getGlyphAdvance(uint32 glyph) const
+{
+	// Loaded the same way as in getGlyphData, but not rendered.
+	FT_UInt loadoption = FT_LOAD_NO_HINTING;
+	if (renderMode != RENDER_SDF)
+		loadoption = hintingToLoadOption(hinting);
+
+	FT_Error err = FT_Load_Glyph(face, FT_Get_Char_Index(face, glyph), FT_LOAD_DEFAULT | loadoption);
+
+	if (err != FT_Err_Ok)
+		throw love::Exception("TrueType Font glyph error: FT_Load_Glyph failed (0x%x)", err);
+
+	return (int) (face->glyph->advance.x >> 6);
+}
+
 int TrueTypeRasterizer::getGlyphCount() const
 {
 	return (int) face->num_glyphs;
@@ -186,6 +436,43 @@ Rasterizer::DataType TrueTypeRasterizer::getDataType() const
 	return DATA_TRUETYPE;
 }
 
+bool TrueTypeRasterizer::isDistanceField() const
+{
+	return renderMode == RENDER_SDF;
+}
+
+std::string TrueTypeRasterizer::getCacheKey() const
+{
+	if (!cacheKey.empty())
+		return cacheKey;
+
+	using love::data::HashFunction;
+
+	HashFunction *hashfunction = HashFunction::getHashFunction(HashFunction::FUNCTION_SHA1);
+	if (hashfunction == nullptr)
+		return std::string();
+
+	HashFunction::Value hash = {};
+	hashfunction->hash(HashFunction::FUNCTION_SHA1, (const char *) data->getData(), data->getSize(), hash);
+
+	const char *hintingname = nullptr;
+	const char *rendermodename = nullptr;
+	getConstant(hinting, hintingname);
+	getConstant(renderMode, rendermodename);
+
+	std::stringstream ss;
+	ss << "truetype sha1:" << std::hex;
+
+	for (size_t i = 0; i < hash.size; i++)
+		ss << (int) ((hash.data[i] >> 4) & 0xF) << (int) (hash.data[i] & 0xF);
+
+	ss << std::dec << " size:" << face->size->metrics.y_ppem << " dpiscale:" << dpiScale;
+	ss << " hinting:" << hintingname << " rendermode:" << rendermodename;
+
+	cacheKey = ss.str();
+	return cacheKey;
+}
+
 bool TrueTypeRasterizer::accepts(FT_Library library, love::Data *data)
 {
 	const FT_Byte *fbase = (const FT_Byte *) data->getData();
@@ -44,16 +44,19 @@ class TrueTypeRasterizer : public love::font::TrueTypeRasterizer
 {
 public:
 
-	TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting);
+	TrueTypeRasterizer(FT_Library library, love::Data *data, int size, float dpiscale, Hinting hinting, RenderMode rendermode);
 	virtual ~TrueTypeRasterizer();
 
 	// Implement Rasterizer
 	int getLineHeight() const override;
 	GlyphData *getGlyphData(uint32 glyph) const override;
+	int getGlyphAdvance(uint32 glyph) const override;
 	int getGlyphCount() const override;
 	bool hasGlyph(uint32 glyph) const override;
 	float getKerning(uint32 leftglyph, uint32 rightglyph) const override;
 	DataType getDataType() const override;
+	bool isDistanceField() const override;
+	std::string getCacheKey() const override;
 
 	static bool accepts(FT_Library library, love::Data *data);
 
@@ -61,6 +64,8 @@ class TrueTypeRasterizer : public love::font::TrueTypeRasterizer
 
 	static FT_UInt hintingToLoadOption(Hinting hinting);
 
+	GlyphData *getDistanceFieldGlyphData(uint32 glyph) const;
+
 	// TrueType face
 	FT_Face face;
 
@@ -68,6 +73,18 @@ class TrueTypeRasterizer : public love::font::TrueTypeRasterizer
 	StrongRef<love::Data> data;
 
 	Hinting hinting;
+	RenderMode renderMode;
+
+	// Computed the first time it's needed, since it hashes the font data.
+	mutable std::string cacheKey;
+
+	// Distance field glyphs are computed from the outline rasterized at this
+	// multiple of the font size, for more accurate distances near corners.
+	static const int SDF_SUPERSAMPLE = 2;
+
+	// How many pixels (at the font size) distance fields extend past the
+	// outline. Larger values allow wider outlines and glows in shaders.
+	static const int SDF_SPREAD = 4;
 
 }; // TrueTypeRasterizer
 
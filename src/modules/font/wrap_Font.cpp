@@ -68,6 +68,7 @@ int w_newTrueTypeRasterizer(lua_State *L)
 {
 	Rasterizer *t = nullptr;
 	TrueTypeRasterizer::Hinting hinting = TrueTypeRasterizer::HINTING_NORMAL;
+	TrueTypeRasterizer::RenderMode rendermode = TrueTypeRasterizer::RENDER_NORMAL;
 
 	if (lua_type(L, 1) == LUA_TNUMBER || lua_isnone(L, 1))
 	{
@@ -78,12 +79,16 @@ int w_newTrueTypeRasterizer(lua_State *L)
 		if (hintstr && !TrueTypeRasterizer::getConstant(hintstr, hinting))
 			return luax_enumerror(L, "TrueType font hinting mode", TrueTypeRasterizer::getConstants(hinting), hintstr);
 
+		const char *modestr = lua_isnoneornil(L, 4) ? nullptr : luaL_checkstring(L, 4);
+		if (modestr && !TrueTypeRasterizer::getConstant(modestr, rendermode))
+			return luax_enumerror(L, "TrueType font render mode", TrueTypeRasterizer::getConstants(rendermode), modestr);
+
 		if (lua_isnoneornil(L, 3))
-			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, hinting); });
+			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, hinting, rendermode); });
 		else
 		{
 			float dpiscale = (float) luaL_checknumber(L, 3);
-			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, dpiscale, hinting); });
+			luax_catchexcept(L, [&](){ t = instance()->newTrueTypeRasterizer(size, dpiscale, hinting, rendermode); });
 		}
 	}
 	else
@@ -102,12 +107,22 @@ int w_newTrueTypeRasterizer(lua_State *L)
 
 		const char *hintstr = lua_isnoneornil(L, 3) ? nullptr : luaL_checkstring(L, 3);
 		if (hintstr && !TrueTypeRasterizer::getConstant(hintstr, hinting))
+		{
+			d->release();
 			return luax_enumerror(L, "TrueType font hinting mode", TrueTypeRasterizer::getConstants(hinting), hintstr);
+		}
+
+		const char *modestr = lua_isnoneornil(L, 5) ? nullptr : luaL_checkstring(L, 5);
+		if (modestr && !TrueTypeRasterizer::getConstant(modestr, rendermode))
+		{
+			d->release();
+			return luax_enumerror(L, "TrueType font render mode", TrueTypeRasterizer::getConstants(rendermode), modestr);
+		}
 
 		if (lua_isnoneornil(L, 4))
 		{
 			luax_catchexcept(L,
-				[&]() { t = instance()->newTrueTypeRasterizer(d, size, hinting); },
+				[&]() { t = instance()->newTrueTypeRasterizer(d, size, hinting, rendermode); },
 				[&](bool) { d->release(); }
 			);
 		}
@@ -115,7 +130,7 @@ int w_newTrueTypeRasterizer(lua_State *L)
 		{
 			float dpiscale = (float) luaL_checknumber(L, 4);
 			luax_catchexcept(L,
-				[&]() { t = instance()->newTrueTypeRasterizer(d, size, dpiscale, hinting); },
+				[&]() { t = instance()->newTrueTypeRasterizer(d, size, dpiscale, hinting, rendermode); },
 				[&](bool) { d->release(); }
 			);
 		}
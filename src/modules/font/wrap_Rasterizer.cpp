@@ -73,6 +73,8 @@ int w_Rasterizer_getGlyphData(lua_State *L)
 	GlyphData *g = 0;
 
 	luax_catchexcept(L, [&]() {
+		love::thread::Lock lock(t->getMutex());
+
 		// getGlyphData accepts a unicode character or a codepoint number.
 		if (lua_type(L, 2) == LUA_TSTRING)
 		{
@@ -98,6 +100,13 @@ int w_Rasterizer_getGlyphCount(lua_State *L)
 	return 1;
 }
 
+int w_Rasterizer_isDistanceField(lua_State *L)
+{
+	Rasterizer *t = luax_checkrasterizer(L, 1);
+	luax_pushboolean(L, t->isDistanceField());
+	return 1;
+}
+
 int w_Rasterizer_hasGlyphs(lua_State *L)
 {
 	Rasterizer *t = luax_checkrasterizer(L, 1);
@@ -108,6 +117,8 @@ int w_Rasterizer_hasGlyphs(lua_State *L)
 	count = count < 1 ? 1 : count;
 
 	luax_catchexcept(L, [&]() {
+		love::thread::Lock lock(t->getMutex());
+
 		for (int i = 2; i < count + 2; i++)
 		{
 			if (lua_type(L, i) == LUA_TSTRING)
@@ -134,6 +145,7 @@ const luaL_Reg w_Rasterizer_functions[] =
 	{ "getGlyphData", w_Rasterizer_getGlyphData },
 	{ "getGlyphCount", w_Rasterizer_getGlyphCount },
 	{ "hasGlyphs", w_Rasterizer_hasGlyphs },
+	{ "isDistanceField", w_Rasterizer_isDistanceField },
 	{ 0, 0 }
 };
 
@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "common/config.h"
+#include "DrawList.h"
+
+// LOVE
+#include "Graphics.h"
+#include "Buffer.h"
+
+namespace love
+{
+namespace graphics
+{
+
+love::Type DrawList::type("DrawList", &Drawable::type);
+
+DrawList::DrawList(Graphics *gfx, const std::vector<Command> &commands, const std::vector<uint8> data[2])
+	: indexBuffer(nullptr)
+	, vertexCount(0)
+{
+	using namespace vertex;
+
+	vertexBuffers[0] = vertexBuffers[1] = nullptr;
+
+	std::vector<uint16> indices;
+
+	// Merge consecutive compatible draws, the same way the stream batcher
+	// would have. Their vertices are already contiguous in the data arrays.
+	for (const Command &cmd : commands)
+	{
+		bool indexed = cmd.indexMode != TriangleIndexMode::NONE;
+		Batch *batch = batches.empty() ? nullptr : &batches.back();
+
+		if (batch == nullptr
+			|| batch->primitiveMode != cmd.primitiveMode
+			|| batch->formats[0] != cmd.formats[0] || batch->formats[1] != cmd.formats[1]
+			|| batch->indexed != indexed
+			|| batch->texture.get() != cmd.texture.get()
+			|| batch->standardShaderType != cmd.standardShaderType
+			|| (indexed && batch->vertexCount + cmd.vertexCount > LOVE_UINT16_MAX))
+		{
+			Batch b;
+			b.primitiveMode = cmd.primitiveMode;
+			b.formats[0] = cmd.formats[0];
+			b.formats[1] = cmd.formats[1];
+			b.texture = cmd.texture;
+			b.standardShaderType = cmd.standardShaderType;
+			b.dataOffsets[0] = cmd.dataOffsets[0];
+			b.dataOffsets[1] = cmd.dataOffsets[1];
+			b.vertexCount = 0;
+			b.indexed = indexed;
+			b.indexStart = (int) indices.size();
+			b.indexCount = 0;
+
+			batches.push_back(b);
+			batch = &batches.back();
+		}
+
+		if (indexed)
+		{
+			int count = getIndexCount(cmd.indexMode, cmd.vertexCount);
+			size_t start = indices.size();
+
+			indices.resize(start + count);
+			fillIndices(cmd.indexMode, (uint16) batch->vertexCount, (uint16) cmd.vertexCount, &indices[start]);
+
+			batch->indexCount += count;
+		}
+
+		batch->vertexCount += cmd.vertexCount;
+		vertexCount += cmd.vertexCount;
+	}
+
+	// Static buffers keep a copy of their contents in main memory, so the
+	// list survives the graphics context being recreated.
+	try
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			if (!data[i].empty())
+				vertexBuffers[i] = gfx->newBuffer(data[i].size(), data[i].data(), BUFFER_VERTEX, USAGE_STATIC, 0);
+		}
+
+		if (!indices.empty())
+			indexBuffer = gfx->newBuffer(indices.size() * sizeof(uint16), indices.data(), BUFFER_INDEX, USAGE_STATIC, 0);
+	}
+	catch (love::Exception &)
+	{
+		delete vertexBuffers[0];
+		delete vertexBuffers[1];
+		throw;
+	}
+}
+
+DrawList::~DrawList()
+{
+	delete vertexBuffers[0];
+	delete vertexBuffers[1];
+	delete indexBuffer;
+}
+
+int DrawList::getVertexCount() const
+{
+	return vertexCount;
+}
+
+int DrawList::getBatchCount() const
+{
+	return (int) batches.size();
+}
+
+void DrawList::draw(Graphics *gfx, const Matrix4 &m)
+{
+	using namespace vertex;
+
+	if (batches.empty())
+		return;
+
+	gfx->flushStreamDraws();
+
+	Graphics::TempTransform transform(gfx, m);
+
+	for (const Batch &batch : batches)
+	{
+		if (batch.vertexCount == 0 || (batch.indexed && batch.indexCount == 0))
+			continue;
+
+		if (Shader::isDefaultActive())
+			Shader::attachDefault(batch.standardShaderType);
+
+		if (Shader::current != nullptr && batch.texture.get() != nullptr)
+			Shader::current->checkMainTexture(batch.texture);
+
+		Attributes attributes;
+		BufferBindings buffers;
+
+		for (int i = 0; i < 2; i++)
+		{
+			if (batch.formats[i] == CommonFormat::NONE)
+				continue;
+
+			attributes.setCommonFormat(batch.formats[i], (uint8) i);
+			buffers.set(i, vertexBuffers[i], batch.dataOffsets[i]);
+		}
+
+		if (attributes.enableBits == 0)
+			continue;
+
+		if (batch.indexed)
+		{
+			Graphics::DrawIndexedCommand cmd(&attributes, &buffers, indexBuffer);
+			cmd.primitiveType = batch.primitiveMode;
+			cmd.indexCount = batch.indexCount;
+			cmd.indexType = INDEX_UINT16;
+			cmd.indexBufferOffset = batch.indexStart * sizeof(uint16);
+			cmd.texture = batch.texture;
+			gfx->draw(cmd);
+		}
+		else
+		{
+			Graphics::DrawCommand cmd(&attributes, &buffers);
+			cmd.primitiveType = batch.primitiveMode;
+			cmd.vertexStart = 0;
+			cmd.vertexCount = batch.vertexCount;
+			cmd.texture = batch.texture;
+			gfx->draw(cmd);
+		}
+	}
+}
+
+} // graphics
+} // love
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/int.h"
+#include "common/Matrix.h"
+#include "Drawable.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "vertex.h"
+
+// C++
+#include <vector>
+
+namespace love
+{
+namespace graphics
+{
+
+class Graphics;
+class Buffer;
+
+/**
+ * A sequence of stream draws (shapes, textures, text, etc.) captured between
+ * Graphics::beginRecording and Graphics::endRecording. The generated vertices
+ * are stored in static GPU buffers, so drawing the list again only costs one
+ * draw call per batch of compatible draws.
+ *
+ * Only draws which go through Graphics::requestStreamDraw are recorded.
+ * Global state such as the blend mode, active Canvas and custom Shader is
+ * taken from the time the list is drawn, not from when it was recorded.
+ **/
+class DrawList : public Drawable
+{
+public:
+
+	static love::Type type;
+
+	struct Command
+	{
+		PrimitiveType primitiveMode;
+		vertex::CommonFormat formats[2];
+		vertex::TriangleIndexMode indexMode;
+		int vertexCount;
+		StrongRef<Texture> texture;
+		Shader::StandardShader standardShaderType;
+		size_t dataOffsets[2];
+	};
+
+	DrawList(Graphics *gfx, const std::vector<Command> &commands, const std::vector<uint8> data[2]);
+	virtual ~DrawList();
+
+	/**
+	 * Gets the total number of recorded vertices.
+	 **/
+	int getVertexCount() const;
+
+	/**
+	 * Gets the number of draw calls needed to draw the list.
+	 **/
+	int getBatchCount() const;
+
+	// Implements Drawable.
+	void draw(Graphics *gfx, const Matrix4 &m) override;
+
+private:
+
+	struct Batch
+	{
+		PrimitiveType primitiveMode;
+		vertex::CommonFormat formats[2];
+		StrongRef<Texture> texture;
+		Shader::StandardShader standardShaderType;
+		size_t dataOffsets[2];
+		int vertexCount;
+		bool indexed;
+		int indexStart;
+		int indexCount;
+	};
+
+	std::vector<Batch> batches;
+
+	Buffer *vertexBuffers[2];
+	Buffer *indexBuffer;
+
+	int vertexCount;
+
+}; // DrawList
+
+} // graphics
+} // love
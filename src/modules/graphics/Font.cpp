@@ -26,8 +26,10 @@
 #include "common/math.h"
 #include "common/Matrix.h"
 #include "Graphics.h"
+#include "filesystem/Filesystem.h"
 
 #include <math.h>
+#include <cmath>
 #include <sstream>
 #include <algorithm> // for max
 #include <limits>
@@ -42,6 +44,156 @@ static inline uint16 normToUint16(double n)
 	return (uint16) (n * LOVE_UINT16_MAX);
 }
 
+// 64-bit FNV-1a.
+static uint64 hashBytes(const void *data, size_t size, uint64 hash = 0xCBF29CE484222325ULL)
+{
+	const uint8 *bytes = (const uint8 *) data;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+// Glyph cache files are meant to be read on the machine which wrote them, so
+// values are stored in native byte order.
+static const char GLYPH_CACHE_MAGIC[] = "LOVE glyph cache";
+static const uint32 GLYPH_CACHE_VERSION = 1;
+
+template <typename T>
+static void writeCacheValue(std::vector<uint8> &out, const T &value)
+{
+	const uint8 *bytes = (const uint8 *) &value;
+	out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+struct GlyphCacheReader
+{
+	const uint8 *data;
+	size_t size;
+	size_t offset;
+};
+
+static bool readCacheBytes(GlyphCacheReader &r, void *dst, size_t size)
+{
+	if (r.size - r.offset < size)
+		return false;
+
+	memcpy(dst, r.data + r.offset, size);
+	r.offset += size;
+	return true;
+}
+
+template <typename T>
+static bool readCacheValue(GlyphCacheReader &r, T &value)
+{
+	return readCacheBytes(r, &value, sizeof(T));
+}
+
+/**
+ * Rasterizes queued glyphs for Fonts using asynchronous glyph loading. A
+ * single thread is shared by all Fonts, which take turns one glyph at a time.
+ **/
+class GlyphWorker : public love::thread::Threadable
+{
+public:
+
+	GlyphWorker()
+		: current(nullptr)
+	{
+		threadName = "GlyphWorker";
+	}
+
+	virtual ~GlyphWorker() {}
+
+	void addFont(Font *font)
+	{
+		love::thread::Lock lock(mutex);
+
+		if (std::find(fonts.begin(), fonts.end(), font) == fonts.end())
+			fonts.push_back(font);
+
+		cond->broadcast();
+	}
+
+	// Waits until the worker is done with the Font, if it's using it.
+	void removeFont(Font *font)
+	{
+		love::thread::Lock lock(mutex);
+
+		// The worker may queue the Font again when it's done with it, so it
+		// can only be removed afterward. It can't be picked up again while
+		// the lock is held.
+		while (current == font)
+			cond->wait(mutex);
+
+		fonts.erase(std::remove(fonts.begin(), fonts.end(), font), fonts.end());
+	}
+
+	// Implements Threadable.
+	void threadFunction() override
+	{
+		while (true)
+		{
+			Font *font = nullptr;
+
+			{
+				love::thread::Lock lock(mutex);
+
+				while (fonts.empty())
+					cond->wait(mutex);
+
+				font = fonts.front();
+				current = font;
+			}
+
+			font->rasterizeQueuedGlyph();
+
+			{
+				love::thread::Lock lock(mutex);
+
+				fonts.erase(std::remove(fonts.begin(), fonts.end(), font), fonts.end());
+
+				// Re-checked while holding the lock, so a glyph queued right
+				// after the last one was taken isn't missed.
+				if (font->hasQueuedGlyphs())
+					fonts.push_back(font);
+
+				current = nullptr;
+				cond->broadcast();
+			}
+		}
+	}
+
+	static GlyphWorker *getShared()
+	{
+		// Intentionally never deleted: the thread just sleeps until the process
+		// exits, which avoids problems with static destruction order.
+		static GlyphWorker *worker = nullptr;
+
+		if (worker == nullptr)
+		{
+			worker = new GlyphWorker();
+			if (!worker->start())
+				throw love::Exception("Could not start the glyph rasterizer thread.");
+		}
+
+		return worker;
+	}
+
+private:
+
+	love::thread::MutexRef mutex;
+	love::thread::ConditionalRef cond;
+
+	std::vector<Font *> fonts;
+	Font *current;
+
+}; // GlyphWorker
+
 love::Type Font::type("Font", &Object::type);
 int Font::fontCount = 0;
 
@@ -53,13 +205,35 @@ Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 	, lineHeight(1)
 	, textureWidth(128)
 	, textureHeight(128)
+	, glyphTable(GLYPH_TABLE_SIZE / GLYPH_TABLE_PAGE_SIZE)
+	, kerningIndexTable(GLYPH_TABLE_SIZE / GLYPH_TABLE_PAGE_SIZE)
+	, kerningGlyphCount(0)
 	, filter(f)
 	, dpiScale(r->getDPIScale())
 	, useSpacesAsTab(false)
 	, textureCacheID(0)
+	, glyphLoadMode(GLYPH_LOAD_SYNC)
+	, placeholderGlyph(0)
+	, hasPlaceholderGlyph(false)
+	, pendingGlyph()
+	, hasLoadedGlyphs(false)
+	, usingGlyphWorker(false)
+	, batchingGlyphUploads(false)
+	, atlasMemoryBudget(0)
+	, glyphUseStamp(0)
+	, glyphUseDepth(0)
+	, evictedGlyphCount(0)
+	, atlasCompactionCount(0)
+	, layoutCacheID(0)
+	, layoutCandidates()
+	, nextLayoutCandidate(0)
 {
 	filter.mipmap = Texture::FILTER_NONE;
 
+	// Distance fields are only meaningful between texels when interpolated.
+	if (r->isDistanceField())
+		filter.min = filter.mag = Texture::FILTER_LINEAR;
+
 	// Try to find the best texture size match for the font size. default to the
 	// largest texture size if no rough match is found.
 	while (true)
@@ -76,12 +250,17 @@ Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 		textureHeight = nextsize.height;
 	}
 
-	love::font::GlyphData *gd = r->getGlyphData(32); // Space character.
-	pixelFormat = gd->getFormat();
-	gd->release();
+	{
+		// The Rasterizer may already be in use by another Font's glyph worker.
+		love::thread::Lock lock(r->getMutex());
+
+		love::font::GlyphData *gd = r->getGlyphData(32); // Space character.
+		pixelFormat = gd->getFormat();
+		gd->release();
 
-	if (!r->hasGlyph(9)) // No tab character in the Rasterizer.
-		useSpacesAsTab = true;
+		if (!r->hasGlyph(9)) // No tab character in the Rasterizer.
+			useSpacesAsTab = true;
+	}
 
 	loadVolatile();
 	++fontCount;
@@ -89,6 +268,12 @@ Font::Font(love::font::Rasterizer *r, const Texture::Filter &f)
 
 Font::~Font()
 {
+	if (usingGlyphWorker)
+		GlyphWorker::getShared()->removeFont(this);
+
+	// Gives the glyphs' space in a shared atlas back to it.
+	clearGlyphs();
+
 	--fontCount;
 }
 
@@ -122,90 +307,237 @@ Font::TextureSize Font::getNextTextureSize() const
 bool Font::loadVolatile()
 {
 	textureCacheID++;
-	glyphs.clear();
-	images.clear();
-	createTexture();
+	clearGlyphs();
+
+	if (atlas.get() == nullptr)
+		atlas.set(new GlyphAtlas(pixelFormat, filter, textureWidth, textureHeight, false), Acquire::NORETAIN);
+
+	// Other Fonts may have already put glyphs in a shared atlas.
+	if (!atlas->isShared())
+		atlas->clear();
+
+	if (atlas->getPageCount() == 0)
+		atlas->addPage();
+
+	flushGlyphUploads();
 	return true;
 }
 
-void Font::createTexture()
+void Font::unloadVolatile()
 {
-	auto gfx = Module::getInstance<graphics::Graphics>(Module::M_GRAPHICS);
-	gfx->flushStreamDraws();
+	clearGlyphs();
 
-	Image *image = nullptr;
-	TextureSize size = {textureWidth, textureHeight};
-	TextureSize nextsize = getNextTextureSize();
-	bool recreatetexture = false;
+	// Other Fonts may still have glyphs in a shared atlas.
+	if (atlas.get() != nullptr && !atlas->isShared())
+		atlas->clear();
 
-	// If we have an existing texture already, we'll try replacing it with a
-	// larger-sized one rather than creating a second one. Having a single
-	// texture reduces texture switches and draw calls when rendering.
-	if ((nextsize.width > size.width || nextsize.height > size.height) && !images.empty())
+	layoutCache.clear();
+}
+
+Font::GlyphUseScope::GlyphUseScope(Font *font)
+	: font(font)
+{
+	if (font->glyphUseDepth++ == 0)
+		font->glyphUseStamp++;
+}
+
+Font::GlyphUseScope::~GlyphUseScope()
+{
+	font->glyphUseDepth--;
+}
+
+void Font::packGlyph(int w, int h, int &page, Rect &rect)
+{
+	size_t bpp = getPixelFormatSize(pixelFormat);
+
+	// Glyphs in a shared atlas can't be moved, since other Fonts use its pages.
+	if (atlas->isShared())
 	{
-		recreatetexture = true;
-		size = nextsize;
-		images.pop_back();
-	}
+		if (atlas->pack(w, h, page, rect))
+			return;
 
-	Image::Settings settings;
-	image = gfx->newImage(TEXTURE_2D, pixelFormat, size.width, size.height, 1, settings);
-	image->setFilter(filter);
+		int64 pagesize = (int64) atlas->getWidth() * atlas->getHeight() * bpp;
 
+		// The budget includes other Fonts' glyphs, but only this Font's can be
+		// evicted. Their space is reused once no other Font uses them either.
+		if (!isWithinAtlasBudget(atlas->getMemorySize() + pagesize) && evictGlyphs() > 0)
+		{
+			// Text can't keep using the evicted glyphs' space.
+			textureCacheID++;
+
+			if (atlas->pack(w, h, page, rect))
+				return;
+		}
+
+		atlas->addPage();
+
+		if (!atlas->pack(w, h, page, rect))
+			throw love::Exception("Glyph is too large to fit in the font's texture atlas.");
+
+		return;
+	}
+
+	while (!atlas->pack(w, h, page, rect))
 	{
-		size_t bpp = getPixelFormatSize(pixelFormat);
-		size_t pixelcount = size.width * size.height;
+		int pagecount = atlas->getPageCount();
+		int64 pagesize = (int64) textureWidth * textureHeight * bpp;
+		TextureSize nextsize = getNextTextureSize();
 
-		// Initialize the texture with transparent white for Luminance-Alpha
-		// formats (since we keep luminance constant and vary alpha in those
-		// glyphs), and transparent black otherwise.
-		std::vector<uint8> emptydata(pixelcount * bpp, 0);
+		// Growing the only texture is preferred over adding a second one, since
+		// a single texture reduces texture switches and draw calls.
+		bool cangrow = pagecount == 1 && (nextsize.width > textureWidth || nextsize.height > textureHeight);
 
-		if (pixelFormat == PIXELFORMAT_LA8)
+		if (cangrow && isWithinAtlasBudget((int64) nextsize.width * nextsize.height * bpp))
 		{
-			for (size_t i = 0; i < pixelcount; i++)
-				emptydata[i * 2 + 0] = 255;
+			rebuildAtlas(nextsize);
+			continue;
 		}
 
-		Rect rect = {0, 0, size.width, size.height};
-		image->replacePixels(emptydata.data(), emptydata.size(), 0, 0, rect, false);
+		// Without room for another page, make room by evicting old glyphs. If
+		// every glyph is in use, the budget is exceeded instead.
+		if (isWithinAtlasBudget(pagesize * (pagecount + 1)) || evictGlyphs() == 0)
+		{
+			atlas->addPage();
+
+			if (!atlas->pack(w, h, page, rect))
+				throw love::Exception("Glyph is too large to fit in the font's texture atlas.");
+
+			return;
+		}
+
+		// Compact the remaining glyphs into the pages which are left.
+		TextureSize size = {textureWidth, textureHeight};
+		rebuildAtlas(size);
+		atlasCompactionCount++;
 	}
+}
 
-	images.emplace_back(image, Acquire::NORETAIN);
+void Font::rebuildAtlas(const TextureSize &size)
+{
+	StrongRef<GlyphAtlas> oldatlas = atlas;
 
-	textureWidth  = size.width;
+	textureWidth = size.width;
 	textureHeight = size.height;
 
-	rowHeight = textureX = textureY = TEXTURE_PADDING;
+	atlas.set(new GlyphAtlas(pixelFormat, filter, textureWidth, textureHeight, false), Acquire::NORETAIN);
+
+	textureCacheID++;
+
+	std::vector<Glyph *> atlasglyphs;
+	atlasglyphs.reserve(glyphs.size());
+
+	for (auto &glyphpair : glyphs)
+	{
+		if (glyphpair.second.page >= 0)
+			atlasglyphs.push_back(&glyphpair.second);
+	}
+
+	// Packing the tallest glyphs first keeps the skyline flatter.
+	std::sort(atlasglyphs.begin(), atlasglyphs.end(), [](const Glyph *a, const Glyph *b)
+	{
+		return a->rect.h > b->rect.h;
+	});
+
+	atlas->addPage();
+
+	size_t bpp = getPixelFormatSize(pixelFormat);
+	size_t oldpitch = oldatlas->getWidth();
 
-	// Re-add the old glyphs if we re-created the existing texture object.
-	if (recreatetexture)
+	// The glyphs' pixels are copied from the old pages rather than being
+	// rasterized again.
+	for (Glyph *g : atlasglyphs)
 	{
-		textureCacheID++;
+		const uint8 *src = oldatlas->getPixels(g->page) + (g->rect.y * oldpitch + g->rect.x) * bpp;
+
+		int page = 0;
+		Rect rect = {};
 
-		std::vector<uint32> glyphstoadd;
+		if (!atlas->pack(g->rect.w, g->rect.h, page, rect))
+		{
+			atlas->addPage();
 
-		for (const auto &glyphpair : glyphs)
-			glyphstoadd.push_back(glyphpair.first);
+			if (!atlas->pack(g->rect.w, g->rect.h, page, rect))
+				throw love::Exception("Glyph is too large to fit in the font's texture atlas.");
+		}
 
-		glyphs.clear();
-		
-		for (uint32 g : glyphstoadd)
-			addGlyph(g);
+		atlas->writePixels(page, rect, src, oldpitch * bpp);
+
+		g->page = page;
+		g->rect = rect;
+		g->texture = atlas->getImage(page);
+		setGlyphTexCoords(*g);
 	}
 }
 
-void Font::unloadVolatile()
+int Font::evictGlyphs()
 {
-	glyphs.clear();
-	images.clear();
+	// Pairs of (last use, glyph), for glyphs not used by the current layout.
+	std::vector<std::pair<uint32, uint32>> candidates;
+
+	for (const auto &glyphpair : glyphs)
+	{
+		const Glyph &g = glyphpair.second;
+		if (g.page >= 0 && g.lastUsed != glyphUseStamp)
+			candidates.emplace_back(g.lastUsed, glyphpair.first);
+	}
+
+	if (candidates.empty())
+		return 0;
+
+	// Evicting half of them at once avoids compacting the atlas for every
+	// new glyph when text changes steadily.
+	size_t count = (candidates.size() + 1) / 2;
+
+	std::sort(candidates.begin(), candidates.end());
+
+	for (size_t i = 0; i < count; i++)
+	{
+		auto it = glyphs.find(candidates[i].second);
+
+		if (it->second.atlasEntry >= 0)
+			atlas->releaseGlyph(it->second.atlasEntry);
+
+		setGlyphTableEntry(it->first, nullptr);
+		glyphs.erase(it);
+	}
+
+	evictedGlyphCount += count;
+	return (int) count;
+}
+
+void Font::setGlyphTexCoords(Glyph &g) const
+{
+	double tX     = (double) g.rect.x,     tY      = (double) g.rect.y;
+	double tW     = (double) g.rect.w,     tH      = (double) g.rect.h;
+	double tWidth = (double) atlas->getWidth(), tHeight = (double) atlas->getHeight();
+
+	// The quad is extruded by 1 pixel, see addGlyph.
+	int o = 1;
+
+	g.vertices[0].s = normToUint16((tX-o)/tWidth);
+	g.vertices[0].t = normToUint16((tY-o)/tHeight);
+	g.vertices[1].s = normToUint16((tX-o)/tWidth);
+	g.vertices[1].t = normToUint16((tY+tH+o)/tHeight);
+	g.vertices[2].s = normToUint16((tX+tW+o)/tWidth);
+	g.vertices[2].t = normToUint16((tY-o)/tHeight);
+	g.vertices[3].s = normToUint16((tX+tW+o)/tWidth);
+	g.vertices[3].t = normToUint16((tY+tH+o)/tHeight);
+}
+
+bool Font::isWithinAtlasBudget(int64 bytes) const
+{
+	return atlasMemoryBudget <= 0 || bytes <= atlasMemoryBudget;
 }
 
 love::font::GlyphData *Font::getRasterizerGlyphData(uint32 glyph)
 {
+	love::thread::Lock lock(rasterizerMutex);
+
 	// Use spaces for the tab 'glyph'.
 	if (glyph == 9 && useSpacesAsTab)
 	{
+		love::thread::Lock rlock(rasterizers[0]->getMutex());
+
 		love::font::GlyphData *spacegd = rasterizers[0]->getGlyphData(32);
 		PixelFormat fmt = spacegd->getFormat();
 
@@ -221,59 +553,80 @@ love::font::GlyphData *Font::getRasterizerGlyphData(uint32 glyph)
 
 	for (const StrongRef<love::font::Rasterizer> &r : rasterizers)
 	{
+		love::thread::Lock rlock(r->getMutex());
 		if (r->hasGlyph(glyph))
 			return r->getGlyphData(glyph);
 	}
 
+	love::thread::Lock rlock(rasterizers[0]->getMutex());
 	return rasterizers[0]->getGlyphData(glyph);
 }
 
-const Font::Glyph &Font::addGlyph(uint32 glyph)
+int Font::getRasterizerGlyphAdvance(uint32 glyph)
 {
-	StrongRef<love::font::GlyphData> gd(getRasterizerGlyphData(glyph), Acquire::NORETAIN);
+	love::thread::Lock lock(rasterizerMutex);
 
-	int w = gd->getWidth();
-	int h = gd->getHeight();
+	if (glyph == 9 && useSpacesAsTab)
+	{
+		love::thread::Lock rlock(rasterizers[0]->getMutex());
+		return rasterizers[0]->getGlyphAdvance(32) * SPACES_PER_TAB;
+	}
 
-	if (w + TEXTURE_PADDING * 2 < textureWidth && h + TEXTURE_PADDING * 2 < textureHeight)
+	for (const StrongRef<love::font::Rasterizer> &r : rasterizers)
 	{
-		if (textureX + w + TEXTURE_PADDING > textureWidth)
-		{
-			// Out of space - new row!
-			textureX = TEXTURE_PADDING;
-			textureY += rowHeight;
-			rowHeight = TEXTURE_PADDING;
-		}
+		love::thread::Lock rlock(r->getMutex());
+		if (r->hasGlyph(glyph))
+			return r->getGlyphAdvance(glyph);
+	}
 
-		if (textureY + h + TEXTURE_PADDING > textureHeight)
-		{
-			// Totally out of space - new texture!
-			createTexture();
+	love::thread::Lock rlock(rasterizers[0]->getMutex());
+	return rasterizers[0]->getGlyphAdvance(glyph);
+}
 
-			// Makes sure the above code for checking if the glyph can fit at
-			// the current position in the texture is run again for this glyph.
-			return addGlyph(glyph);
-		}
-	}
+const Font::Glyph &Font::addGlyph(uint32 glyph)
+{
+	StrongRef<love::font::GlyphData> gd(getRasterizerGlyphData(glyph), Acquire::NORETAIN);
+	return addGlyph(gd);
+}
+
+const Font::Glyph &Font::addGlyph(love::font::GlyphData *gd)
+{
+	uint32 glyph = gd->getGlyph();
+
+	int w = gd->getWidth();
+	int h = gd->getHeight();
 
 	Glyph g;
 
 	g.texture = 0;
 	g.spacing = floorf(gd->getAdvance() / dpiScale + 0.5f);
+	g.page = -1;
+	g.rect = {0, 0, w, h};
+	g.lastUsed = glyphUseStamp;
+	g.atlasEntry = -1;
 
 	memset(g.vertices, 0, sizeof(GlyphVertex) * 4);
 
 	// Don't waste space for empty glyphs.
 	if (w > 0 && h > 0)
 	{
-		Image *image = images.back();
-		g.texture = image;
+		// Another Font with the same Rasterizers may have added the glyph to
+		// the shared atlas already.
+		if (atlas->isShared())
+			g.atlasEntry = atlas->acquireGlyph(atlasKey, glyph, g.page, g.rect);
 
-		Rect rect = {textureX, textureY, gd->getWidth(), gd->getHeight()};
-		image->replacePixels(gd->getData(), gd->getSize(), 0, 0, rect, false);
+		if (g.atlasEntry < 0)
+		{
+			packGlyph(w, h, g.page, g.rect);
+
+			size_t pitch = w * getPixelFormatSize(pixelFormat);
+			atlas->writePixels(g.page, g.rect, (const uint8 *) gd->getData(), pitch);
+
+			if (atlas->isShared())
+				g.atlasEntry = atlas->addGlyph(atlasKey, glyph, g.page, g.rect);
+		}
 
-		double tX     = (double) textureX,     tY      = (double) textureY;
-		double tWidth = (double) textureWidth, tHeight = (double) textureHeight;
+		g.texture = atlas->getImage(g.page);
 
 		Color32 c(255, 255, 255, 255);
 
@@ -287,10 +640,10 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 		// 1---3
 		const GlyphVertex verts[4] =
 		{
-			{float(-o),      float(-o),      normToUint16((tX-o)/tWidth),   normToUint16((tY-o)/tHeight),   c},
-			{float(-o),      (h+o)/dpiScale, normToUint16((tX-o)/tWidth),   normToUint16((tY+h+o)/tHeight), c},
-			{(w+o)/dpiScale, float(-o),      normToUint16((tX+w+o)/tWidth), normToUint16((tY-o)/tHeight),   c},
-			{(w+o)/dpiScale, (h+o)/dpiScale, normToUint16((tX+w+o)/tWidth), normToUint16((tY+h+o)/tHeight), c}
+			{float(-o),      float(-o),      0, 0, c},
+			{float(-o),      (h+o)/dpiScale, 0, 0, c},
+			{(w+o)/dpiScale, float(-o),      0, 0, c},
+			{(w+o)/dpiScale, (h+o)/dpiScale, 0, 0, c}
 		};
 
 		// Copy vertex data to the glyph and set proper bearing.
@@ -301,36 +654,279 @@ const Font::Glyph &Font::addGlyph(uint32 glyph)
 			g.vertices[i].y -= gd->getBearingY() / dpiScale;
 		}
 
-		textureX += w + TEXTURE_PADDING;
-		rowHeight = std::max(rowHeight, h + TEXTURE_PADDING);
+		setGlyphTexCoords(g);
+
+		if (!batchingGlyphUploads)
+			flushGlyphUploads();
 	}
 
-	glyphs[glyph] = g;
-	return glyphs[glyph];
+	// Elements of an unordered_map stay at the same address when it grows, so
+	// the glyph table can point to them.
+	Glyph &stored = glyphs[glyph];
+	stored = g;
+	setGlyphTableEntry(glyph, &stored);
+
+	return stored;
 }
 
 const Font::Glyph &Font::findGlyph(uint32 glyph)
 {
-	const auto it = glyphs.find(glyph);
+	Glyph *g = lookupGlyph(glyph);
 
-	if (it != glyphs.end())
-		return it->second;
+	if (g != nullptr)
+	{
+		g->lastUsed = glyphUseStamp;
+		return *g;
+	}
+
+	if (glyphLoadMode == GLYPH_LOAD_SYNC)
+		return addGlyph(glyph);
 
-	return addGlyph(glyph);
+	queueGlyph(glyph);
+
+	// The placeholder itself is always loaded immediately.
+	if (hasPlaceholderGlyph && placeholderGlyph != glyph)
+	{
+		Glyph *pg = lookupGlyph(placeholderGlyph);
+		if (pg != nullptr)
+		{
+			pg->lastUsed = glyphUseStamp;
+			return *pg;
+		}
+
+		return addGlyph(placeholderGlyph);
+	}
+
+	return pendingGlyph;
+}
+
+int Font::getGlyphSpacing(uint32 glyph)
+{
+	Glyph *g = lookupGlyph(glyph);
+
+	if (g == nullptr && glyphLoadMode != GLYPH_LOAD_SYNC)
+	{
+		// Measurements mustn't change once the glyph has loaded, so they use
+		// the Rasterizer's metrics instead of the placeholder's.
+		queueGlyph(glyph);
+		return (int) floorf(getRasterizerGlyphAdvance(glyph) / dpiScale + 0.5f);
+	}
+
+	return findGlyph(glyph).spacing;
+}
+
+Font::Glyph *Font::lookupGlyph(uint32 glyph)
+{
+	if (glyph < GLYPH_TABLE_SIZE)
+	{
+		const std::vector<Glyph *> &page = glyphTable[glyph >> GLYPH_TABLE_PAGE_BITS];
+		return page.empty() ? nullptr : page[glyph & (GLYPH_TABLE_PAGE_SIZE - 1)];
+	}
+
+	auto it = glyphs.find(glyph);
+	return it != glyphs.end() ? &it->second : nullptr;
+}
+
+void Font::setGlyphTableEntry(uint32 glyph, Glyph *g)
+{
+	if (glyph >= GLYPH_TABLE_SIZE)
+		return;
+
+	std::vector<Glyph *> &page = glyphTable[glyph >> GLYPH_TABLE_PAGE_BITS];
+
+	if (page.empty())
+	{
+		if (g == nullptr)
+			return;
+
+		page.resize(GLYPH_TABLE_PAGE_SIZE, nullptr);
+	}
+
+	page[glyph & (GLYPH_TABLE_PAGE_SIZE - 1)] = g;
+}
+
+void Font::clearGlyphs()
+{
+	for (const auto &glyphpair : glyphs)
+	{
+		if (glyphpair.second.atlasEntry >= 0)
+			atlas->releaseGlyph(glyphpair.second.atlasEntry);
+	}
+
+	glyphs.clear();
+
+	for (std::vector<Glyph *> &page : glyphTable)
+		page.clear();
+}
+
+void Font::queueGlyph(uint32 glyph)
+{
+	{
+		love::thread::Lock lock(glyphMutex);
+
+		if (!pendingGlyphs.insert(glyph).second)
+			return;
+
+		queuedGlyphs.push_back(glyph);
+	}
+
+	GlyphWorker::getShared()->addFont(this);
+	usingGlyphWorker = true;
+}
+
+bool Font::rasterizeQueuedGlyph()
+{
+	uint32 glyph = 0;
+
+	{
+		love::thread::Lock lock(glyphMutex);
+
+		if (queuedGlyphs.empty())
+			return false;
+
+		glyph = queuedGlyphs.front();
+		queuedGlyphs.pop_front();
+	}
+
+	love::font::GlyphData *gd = nullptr;
+
+	try
+	{
+		gd = getRasterizerGlyphData(glyph);
+	}
+	catch (love::Exception &)
+	{
+	}
+
+	love::thread::Lock lock(glyphMutex);
+
+	// Failed glyphs are forgotten, so they'll be queued again when used.
+	if (gd != nullptr)
+	{
+		loadedGlyphs.emplace_back(gd, Acquire::NORETAIN);
+		hasLoadedGlyphs = true;
+	}
+	else
+		pendingGlyphs.erase(glyph);
+
+	return true;
+}
+
+bool Font::hasQueuedGlyphs() const
+{
+	love::thread::Lock lock(glyphMutex);
+	return !queuedGlyphs.empty();
+}
+
+void Font::uploadLoadedGlyphs()
+{
+	if (!hasLoadedGlyphs)
+		return;
+
+	std::vector<StrongRef<love::font::GlyphData>> loaded;
+
+	{
+		love::thread::Lock lock(glyphMutex);
+
+		loaded.swap(loadedGlyphs);
+		hasLoadedGlyphs = false;
+
+		for (const auto &gd : loaded)
+			pendingGlyphs.erase(gd->getGlyph());
+	}
+
+	batchingGlyphUploads = true;
+
+	try
+	{
+		for (const auto &gd : loaded)
+		{
+			if (lookupGlyph(gd->getGlyph()) == nullptr)
+				addGlyph(gd);
+		}
+
+		flushGlyphUploads();
+	}
+	catch (love::Exception &)
+	{
+		// Pages which are still dirty get uploaded with the next glyph.
+		batchingGlyphUploads = false;
+		throw;
+	}
+
+	batchingGlyphUploads = false;
+
+	// Text laid out while the glyphs were loading has to be regenerated.
+	textureCacheID++;
+}
+
+void Font::flushGlyphUploads()
+{
+	atlas->flush();
+}
+
+int Font::getKerningIndex(uint32 glyph)
+{
+	if (glyph >= GLYPH_TABLE_SIZE)
+		return -1;
+
+	std::vector<uint16> &page = kerningIndexTable[glyph >> GLYPH_TABLE_PAGE_BITS];
+
+	if (page.empty())
+	{
+		if (kerningGlyphCount >= MAX_KERNING_GLYPHS)
+			return -1;
+
+		page.resize(GLYPH_TABLE_PAGE_SIZE, 0);
+	}
+
+	uint16 &index = page[glyph & (GLYPH_TABLE_PAGE_SIZE - 1)];
+
+	if (index == 0)
+	{
+		if (kerningGlyphCount >= MAX_KERNING_GLYPHS)
+			return -1;
+
+		index = (uint16) ++kerningGlyphCount;
+		kerningMatrix.resize(kerningGlyphCount * MAX_KERNING_GLYPHS, std::numeric_limits<float>::quiet_NaN());
+	}
+
+	return index - 1;
 }
 
 float Font::getKerning(uint32 leftglyph, uint32 rightglyph)
 {
 	uint64 packedglyphs = ((uint64) leftglyph << 32) | (uint64) rightglyph;
 
-	const auto it = kerning.find(packedglyphs);
-	if (it != kerning.end())
-		return it->second;
+	int leftindex = getKerningIndex(leftglyph);
+	int rightindex = getKerningIndex(rightglyph);
+
+	float *cached = nullptr;
+
+	if (leftindex >= 0 && rightindex >= 0)
+	{
+		cached = &kerningMatrix[leftindex * MAX_KERNING_GLYPHS + rightindex];
+		if (!std::isnan(*cached))
+			return *cached;
+	}
+	else
+	{
+		const auto it = kerning.find(packedglyphs);
+		if (it != kerning.end())
+			return it->second;
+	}
+
+	love::thread::Lock lock(rasterizerMutex);
 
-	float k = rasterizers[0]->getKerning(leftglyph, rightglyph);
+	float k = 0.0f;
+	{
+		love::thread::Lock rlock(rasterizers[0]->getMutex());
+		k = rasterizers[0]->getKerning(leftglyph, rightglyph);
+	}
 
 	for (const auto &r : rasterizers)
 	{
+		love::thread::Lock rlock(r->getMutex());
 		if (r->hasGlyph(leftglyph) && r->hasGlyph(rightglyph))
 		{
 			k = floorf(r->getKerning(leftglyph, rightglyph) / dpiScale + 0.5f);
@@ -338,7 +934,11 @@ float Font::getKerning(uint32 leftglyph, uint32 rightglyph)
 		}
 	}
 
-	kerning[packedglyphs] = k;
+	if (cached != nullptr)
+		*cached = k;
+	else
+		kerning[packedglyphs] = k;
+
 	return k;
 }
 
@@ -399,6 +999,10 @@ float Font::getHeight() const
 
 std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &codepoints, const Colorf &constantcolor, std::vector<GlyphVertex> &vertices, float extra_spacing, Vector2 offset, TextInfo *info)
 {
+	GlyphUseScope usescope(this);
+
+	uploadLoadedGlyphs();
+
 	// Spacing counter and newline handling.
 	float dx = offset.x;
 	float dy = offset.y;
@@ -418,6 +1022,7 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 	vertices.reserve(vertstartsize + codepoints.cps.size() * 4);
 
 	uint32 prevglyph = 0;
+	int lines = 0;
 
 	Colorf linearconstantcolor = gammaCorrectColor(constantcolor);
 
@@ -454,6 +1059,7 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 			dy += floorf(getHeight() * getLineHeight() + 0.5f);
 			dx = offset.x;
 			prevglyph = 0;
+			lines++;
 			continue;
 		}
 
@@ -475,6 +1081,7 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 			commands.clear();
 			vertices.resize(vertstartsize);
 			prevglyph = 0;
+			lines = 0;
 			curcolori = -1;
 			curcolor = toColor32(constantcolor);
 			continue;
@@ -508,8 +1115,13 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 			commands.back().vertexcount += 4;
 		}
 
-		// Advance the x position for the next glyph.
-		dx += glyph.spacing;
+		// Advance the x position for the next glyph. Glyphs which are still
+		// loading take up their own space rather than the placeholder's, to
+		// match getWidth and getWrap.
+		if (glyphLoadMode != GLYPH_LOAD_SYNC && lookupGlyph(g) == nullptr)
+			dx += getGlyphSpacing(g);
+		else
+			dx += glyph.spacing;
 
 		// Account for extra spacing given to space characters.
 		if (g == ' ' && extra_spacing != 0.0f)
@@ -536,15 +1148,20 @@ std::vector<Font::DrawCommand> Font::generateVertices(const ColoredCodepoints &c
 	{
 		info->width = maxwidth - offset.x;
 		info->height = (int) dy + (dx > 0.0f ? floorf(getHeight() * getLineHeight() + 0.5f) : 0) - offset.y;
+		info->lines = lines + (dx > offset.x ? 1 : 0);
 	}
 
 	return commands;
 }
 
-std::vector<Font::DrawCommand> Font::generateVerticesFormatted(const ColoredCodepoints &text, const Colorf &constantcolor, float wrap, AlignMode align, std::vector<GlyphVertex> &vertices, TextInfo *info)
+std::vector<Font::DrawCommand> Font::generateVerticesFormatted(const ColoredCodepoints &text, const Colorf &constantcolor, float wrap, AlignMode align, std::vector<GlyphVertex> &vertices, TextInfo *info, int firstline)
 {
 	wrap = std::max(wrap, 0.0f);
 
+	GlyphUseScope usescope(this);
+
+	uploadLoadedGlyphs();
+
 	uint32 cacheid = textureCacheID;
 
 	std::vector<DrawCommand> drawcommands;
@@ -555,6 +1172,7 @@ std::vector<Font::DrawCommand> Font::generateVerticesFormatted(const ColoredCode
 
 	getWrap(text, wrap, lines, &widths);
 
+	float lineadvance = getHeight() * getLineHeight();
 	float y = 0.0f;
 	float maxwidth = 0.0f;
 
@@ -562,6 +1180,10 @@ std::vector<Font::DrawCommand> Font::generateVerticesFormatted(const ColoredCode
 	{
 		const auto &line = lines[i];
 
+		// Multiplied rather than accumulated, so a line's position doesn't
+		// depend on whether the lines before it were generated in this call.
+		y = (firstline + i) * lineadvance;
+
 		float width = (float) widths[i];
 		love::Vector2 offset(0.0f, floorf(y));
 		float extraspacing = 0.0f;
@@ -612,20 +1234,19 @@ std::vector<Font::DrawCommand> Font::generateVerticesFormatted(const ColoredCode
 			// Append the new draw commands to the list we're building.
 			drawcommands.insert(drawcommands.end(), firstcmd, newcommands.end());
 		}
-
-		y += getHeight() * getLineHeight();
 	}
 
 	if (info != nullptr)
 	{
 		info->width = (int) maxwidth;
-		info->height = (int) y;
+		info->height = (int) (lines.size() * lineadvance);
+		info->lines = (int) lines.size();
 	}
 
 	if (cacheid != textureCacheID)
 	{
 		vertices.clear();
-		drawcommands = generateVerticesFormatted(text, constantcolor, wrap, align, vertices);
+		drawcommands = generateVerticesFormatted(text, constantcolor, wrap, align, vertices, nullptr, firstline);
 	}
 
 	return drawcommands;
@@ -637,25 +1258,144 @@ void Font::printv(graphics::Graphics *gfx, const Matrix4 &t, const std::vector<D
 		return;
 
 	Matrix4 m(gfx->getTransform(), t);
+	Shader::StandardShader shadertype = getStandardShaderType();
+
+	for (const DrawCommand &cmd : drawcommands)
+	{
+		Graphics::StreamDrawCommand streamcmd;
+		streamcmd.formats[0] = vertexFormat;
+		streamcmd.indexMode = vertex::TriangleIndexMode::QUADS;
+		streamcmd.vertexCount = cmd.vertexcount;
+		streamcmd.texture = cmd.texture;
+		streamcmd.standardShaderType = shadertype;
+
+		Graphics::StreamVertexData data = gfx->requestStreamDraw(streamcmd);
+		GlyphVertex *vertexdata = (GlyphVertex *) data.stream[0];
+
+		memcpy(vertexdata, &vertices[cmd.startvertex], sizeof(GlyphVertex) * cmd.vertexcount);
+		m.transformXY(vertexdata, &vertices[cmd.startvertex], cmd.vertexcount);
+	}
+}
+
+static size_t getTextSize(const std::vector<Font::ColoredString> &text)
+{
+	size_t size = 0;
+	for (const Font::ColoredString &cstr : text)
+		size += cstr.str.size();
+	return size;
+}
+
+const Font::CachedLayout *Font::getCachedLayout(const std::vector<ColoredString> &text, const Colorf &constantcolor, float wrap, AlignMode align)
+{
+	if (getTextSize(text) > MAX_CACHED_LAYOUT_SIZE)
+		return nullptr;
+
+	uploadLoadedGlyphs();
+
+	if (layoutCacheID != textureCacheID)
+	{
+		layoutCache.clear();
+		layoutCacheID = textureCacheID;
+	}
+
+	uint64 hash = hashBytes(&constantcolor, sizeof(Colorf));
+	hash = hashBytes(&wrap, sizeof(float), hash);
+	hash = hashBytes(&align, sizeof(AlignMode), hash);
+
+	for (const ColoredString &cstr : text)
+	{
+		hash = hashBytes(cstr.str.data(), cstr.str.size(), hash);
+		hash = hashBytes(&cstr.color, sizeof(Colorf), hash);
+	}
+
+	for (auto it = layoutCache.begin(); it != layoutCache.end(); ++it)
+	{
+		if (it->hash != hash || it->wrap != wrap || it->align != align || it->color != constantcolor || it->text.size() != text.size())
+			continue;
+
+		bool sametext = true;
+		for (size_t i = 0; i < text.size() && sametext; i++)
+			sametext = it->text[i].str == text[i].str && it->text[i].color == text[i].color;
+
+		if (!sametext)
+			continue;
+
+		// Glyphs drawn through cached layouts are still in use, and shouldn't
+		// be the first ones evicted from the atlas.
+		if (atlasMemoryBudget > 0)
+		{
+			GlyphUseScope usescope(this);
+
+			for (uint32 g : it->glyphs)
+			{
+				Glyph *glyph = lookupGlyph(g);
+				if (glyph != nullptr)
+					glyph->lastUsed = glyphUseStamp;
+			}
+		}
+
+		layoutCache.splice(layoutCache.begin(), layoutCache, it);
+		return &layoutCache.front();
+	}
+
+	// Remember the layout the first time it's printed, and only cache it if
+	// it's printed again soon. 0 marks unused candidate slots.
+	uint64 candidate = hash != 0 ? hash : 1;
+	uint64 *candidatesend = layoutCandidates + MAX_LAYOUT_CANDIDATES;
+
+	uint64 *found = std::find(layoutCandidates, candidatesend, candidate);
+	if (found == candidatesend)
+	{
+		layoutCandidates[nextLayoutCandidate] = candidate;
+		nextLayoutCandidate = (nextLayoutCandidate + 1) % MAX_LAYOUT_CANDIDATES;
+		return nullptr;
+	}
+
+	*found = 0;
+
+	ColoredCodepoints codepoints;
+	getCodepointsFromString(text, codepoints);
+
+	CachedLayout layout;
+	layout.hash = hash;
+	layout.text = text;
+	layout.color = constantcolor;
+	layout.wrap = wrap;
+	layout.align = align;
+
+	if (align == ALIGN_MAX_ENUM)
+		layout.commands = generateVertices(codepoints, constantcolor, layout.vertices);
+	else
+		layout.commands = generateVerticesFormatted(codepoints, constantcolor, wrap, align, layout.vertices);
 
-	for (const DrawCommand &cmd : drawcommands)
+	// Adding glyphs may have invalidated the other cached layouts.
+	if (layoutCacheID != textureCacheID)
 	{
-		Graphics::StreamDrawCommand streamcmd;
-		streamcmd.formats[0] = vertexFormat;
-		streamcmd.indexMode = vertex::TriangleIndexMode::QUADS;
-		streamcmd.vertexCount = cmd.vertexcount;
-		streamcmd.texture = cmd.texture;
+		layoutCache.clear();
+		layoutCacheID = textureCacheID;
+	}
 
-		Graphics::StreamVertexData data = gfx->requestStreamDraw(streamcmd);
-		GlyphVertex *vertexdata = (GlyphVertex *) data.stream[0];
+	layout.glyphs = codepoints.cps;
+	std::sort(layout.glyphs.begin(), layout.glyphs.end());
+	layout.glyphs.erase(std::unique(layout.glyphs.begin(), layout.glyphs.end()), layout.glyphs.end());
 
-		memcpy(vertexdata, &vertices[cmd.startvertex], sizeof(GlyphVertex) * cmd.vertexcount);
-		m.transformXY(vertexdata, &vertices[cmd.startvertex], cmd.vertexcount);
-	}
+	layoutCache.push_front(std::move(layout));
+
+	if (layoutCache.size() > MAX_CACHED_LAYOUTS)
+		layoutCache.pop_back();
+
+	return &layoutCache.front();
 }
 
 void Font::print(graphics::Graphics *gfx, const std::vector<ColoredString> &text, const Matrix4 &m, const Colorf &constantcolor)
 {
+	const CachedLayout *layout = getCachedLayout(text, constantcolor, -1.0f, ALIGN_MAX_ENUM);
+	if (layout != nullptr)
+	{
+		printv(gfx, m, layout->commands, layout->vertices);
+		return;
+	}
+
 	ColoredCodepoints codepoints;
 	getCodepointsFromString(text, codepoints);
 
@@ -667,6 +1407,13 @@ void Font::print(graphics::Graphics *gfx, const std::vector<ColoredString> &text
 
 void Font::printf(graphics::Graphics *gfx, const std::vector<ColoredString> &text, float wrap, AlignMode align, const Matrix4 &m, const Colorf &constantcolor)
 {
+	const CachedLayout *layout = getCachedLayout(text, constantcolor, wrap, align);
+	if (layout != nullptr)
+	{
+		printv(gfx, m, layout->commands, layout->vertices);
+		return;
+	}
+
 	ColoredCodepoints codepoints;
 	getCodepointsFromString(text, codepoints);
 
@@ -680,52 +1427,51 @@ int Font::getWidth(const std::string &str)
 {
 	if (str.size() == 0) return 0;
 
-	std::istringstream iss(str);
-	std::string line;
-	int max_width = 0;
-
-	while (getline(iss, line, '\n'))
-	{
-		int width = 0;
-		uint32 prevglyph = 0;
-		try
-		{
-			utf8::iterator<std::string::const_iterator> i(line.begin(), line.begin(), line.end());
-			utf8::iterator<std::string::const_iterator> end(line.end(), line.begin(), line.end());
+	Codepoints codepoints;
+	getCodepointsFromString(str, codepoints);
 
-			while (i != end)
-			{
-				uint32 c = *i++;
+	return getCodepointsWidth(codepoints);
+}
 
-				// Ignore carriage returns
-				if (c == '\r')
-					continue;
+int Font::getCodepointsWidth(const Codepoints &codepoints)
+{
+	GlyphUseScope usescope(this);
 
-				const Glyph &g = findGlyph(c);
-				width += g.spacing + getKerning(prevglyph, c);
+	int max_width = 0;
+	int width = 0;
+	uint32 prevglyph = 0;
 
-				prevglyph = c;
-			}
-		}
-		catch (utf8::exception &e)
+	for (uint32 c : codepoints)
+	{
+		if (c == '\n')
 		{
-			throw love::Exception("UTF-8 decoding error: %s", e.what());
+			max_width = std::max(max_width, width);
+			width = 0;
+			prevglyph = 0;
+			continue;
 		}
 
-		max_width = std::max(max_width, width);
+		// Ignore carriage returns
+		if (c == '\r')
+			continue;
+
+		width += getGlyphSpacing(c) + getKerning(prevglyph, c);
+
+		prevglyph = c;
 	}
 
-	return max_width;
+	return std::max(max_width, width);
 }
 
 int Font::getWidth(char character)
 {
-	const Glyph &g = findGlyph(character);
-	return g.spacing;
+	return getGlyphSpacing(character);
 }
 
 void Font::getWrap(const ColoredCodepoints &codepoints, float wraplimit, std::vector<ColoredCodepoints> &lines, std::vector<int> *linewidths)
 {
+	GlyphUseScope usescope(this);
+
 	// Per-line info.
 	float width = 0.0f;
 	float widthbeforelastspace = 0.0f;
@@ -788,8 +1534,7 @@ void Font::getWrap(const ColoredCodepoints &codepoints, float wraplimit, std::ve
 			continue;
 		}
 
-		const Glyph &g = findGlyph(c);
-		float charwidth = g.spacing + getKerning(prevglyph, c);
+		float charwidth = getGlyphSpacing(c) + getKerning(prevglyph, c);
 		float newwidth = width + charwidth;
 
 		// Wrap the line if it exceeds the wrap limit. Don't wrap yet if we're
@@ -908,9 +1653,71 @@ void Font::getWrap(const std::vector<ColoredString> &text, float wraplimit, std:
 	}
 }
 
+void Font::getWidths(const char *text, const int *offsets, int count, float wraplimit, int *widths, int *linecounts)
+{
+	GlyphUseScope usescope(this);
+
+	// Reused for every string, to avoid reallocating them.
+	ColoredCodepoints codepoints;
+	std::vector<ColoredCodepoints> lines;
+	std::vector<int> linewidths;
+
+	for (int i = 0; i < count; i++)
+	{
+		const char *begin = text + offsets[i];
+		const char *end = text + offsets[i + 1];
+
+		codepoints.cps.clear();
+
+		try
+		{
+			utf8::iterator<const char *> it(begin, begin, end);
+			utf8::iterator<const char *> itend(end, begin, end);
+
+			while (it != itend)
+				codepoints.cps.push_back(*it++);
+		}
+		catch (utf8::exception &e)
+		{
+			throw love::Exception("UTF-8 decoding error: %s", e.what());
+		}
+
+		if (wraplimit < 0.0f)
+		{
+			widths[i] = getCodepointsWidth(codepoints.cps);
+
+			if (linecounts)
+			{
+				const Codepoints &cps = codepoints.cps;
+				int newlines = (int) std::count(cps.begin(), cps.end(), (uint32) '\n');
+				linecounts[i] = newlines + ((!cps.empty() && cps.back() != '\n') ? 1 : 0);
+			}
+
+			continue;
+		}
+
+		lines.clear();
+		linewidths.clear();
+
+		getWrap(codepoints, wraplimit, lines, &linewidths);
+
+		int maxwidth = 0;
+		for (int width : linewidths)
+			maxwidth = std::max(maxwidth, width);
+
+		widths[i] = maxwidth;
+
+		if (linecounts)
+			linecounts[i] = (int) lines.size();
+	}
+}
+
 void Font::setLineHeight(float height)
 {
 	lineHeight = height;
+
+	// Cached layouts have the old line height baked into their vertices.
+	layoutCache.clear();
 }
 
 float Font::getLineHeight() const
@@ -920,10 +1727,14 @@ float Font::getLineHeight() const
 
 void Font::setFilter(const Texture::Filter &f)
 {
-	for (const auto &image : images)
-		image->setFilter(f);
-
 	filter = f;
+
+	// Other Fonts using the shared atlas keep their filter, so the glyphs
+	// move to the shared atlas for the new one.
+	if (atlas->isShared())
+		setAtlasShared(true);
+	else
+		atlas->setFilter(f);
 }
 
 const Texture::Filter &Font::getFilter() const
@@ -954,8 +1765,11 @@ float Font::getBaseline() const
 
 bool Font::hasGlyph(uint32 glyph) const
 {
+	love::thread::Lock lock(rasterizerMutex);
+
 	for (const StrongRef<love::font::Rasterizer> &r : rasterizers)
 	{
+		love::thread::Lock rlock(r->getMutex());
 		if (r->hasGlyph(glyph))
 			return true;
 	}
@@ -995,13 +1809,67 @@ void Font::setFallbacks(const std::vector<Font *> &fallbacks)
 	{
 		if (f->rasterizers[0]->getDataType() != this->rasterizers[0]->getDataType())
 			throw love::Exception("Font fallbacks must be of the same font type.");
+
+		if (f->rasterizers[0]->isDistanceField() != this->rasterizers[0]->isDistanceField())
+			throw love::Exception("Font fallbacks must all use distance fields, or none of them.");
+	}
+
+	{
+		love::thread::Lock lock(rasterizerMutex);
+
+		rasterizers.resize(1);
+
+		// NOTE: this won't invalidate already-rasterized glyphs.
+		for (const Font *f : fallbacks)
+			rasterizers.push_back(f->rasterizers[0]);
 	}
 
-	rasterizers.resize(1);
+	// New glyphs can come from the fallbacks, so they're only shared with
+	// Fonts which have the same ones.
+	if (atlas->isShared())
+		atlasKey = getGlyphCacheKey();
+}
 
-	// NOTE: this won't invalidate already-rasterized glyphs.
-	for (const Font *f : fallbacks)
-		rasterizers.push_back(f->rasterizers[0]);
+void Font::setGlyphLoadMode(GlyphLoadMode mode)
+{
+	glyphLoadMode = mode;
+}
+
+Font::GlyphLoadMode Font::getGlyphLoadMode() const
+{
+	return glyphLoadMode;
+}
+
+void Font::setGlyphPlaceholder(uint32 glyph)
+{
+	placeholderGlyph = glyph;
+	hasPlaceholderGlyph = true;
+}
+
+void Font::setGlyphPlaceholder()
+{
+	hasPlaceholderGlyph = false;
+}
+
+bool Font::getGlyphPlaceholder(uint32 &glyph) const
+{
+	glyph = placeholderGlyph;
+	return hasPlaceholderGlyph;
+}
+
+void Font::preloadGlyphs(const Codepoints &codepoints)
+{
+	for (uint32 glyph : codepoints)
+	{
+		if (lookupGlyph(glyph) == nullptr)
+			queueGlyph(glyph);
+	}
+}
+
+int Font::getPendingGlyphCount() const
+{
+	love::thread::Lock lock(glyphMutex);
+	return (int) pendingGlyphs.size();
 }
 
 float Font::getDPIScale() const
@@ -1009,6 +1877,290 @@ float Font::getDPIScale() const
 	return dpiScale;
 }
 
+void Font::setAtlasMemoryBudget(int64 bytes)
+{
+	atlasMemoryBudget = std::max(bytes, (int64) 0);
+}
+
+int64 Font::getAtlasMemoryBudget() const
+{
+	return atlasMemoryBudget;
+}
+
+void Font::setAtlasShared(bool shared)
+{
+	StrongRef<GlyphAtlas> newatlas;
+
+	if (shared)
+		newatlas.set(GlyphAtlas::getShared(pixelFormat, filter), Acquire::NORETAIN);
+	else if (atlas->isShared())
+		newatlas.set(new GlyphAtlas(pixelFormat, filter, textureWidth, textureHeight, false), Acquire::NORETAIN);
+	else
+		return;
+
+	if (newatlas == atlas)
+		return;
+
+	// Glyphs are rasterized again as they're used. Their space in the old
+	// atlas is reused if it's shared.
+	clearGlyphs();
+	atlas = newatlas;
+	textureCacheID++;
+
+	atlasKey = shared ? getGlyphCacheKey() : std::string();
+
+	if (atlas->getPageCount() == 0)
+		atlas->addPage();
+}
+
+bool Font::isAtlasShared() const
+{
+	return atlas->isShared();
+}
+
+void Font::getAtlasStats(AtlasStats &stats) const
+{
+	int pagecount = 0;
+	int64 pagearea = (int64) atlas->getWidth() * atlas->getHeight();
+	int64 usedarea = 0;
+
+	// Pages of a shared atlas which no Font uses have been freed.
+	for (int i = 0; i < atlas->getPageCount(); i++)
+	{
+		if (atlas->isPageAllocated(i))
+		{
+			pagecount++;
+			usedarea += atlas->getUsedArea(i);
+		}
+	}
+
+	stats.pages = pagecount;
+	stats.glyphs = (int) glyphs.size();
+	stats.memory = pagearea * pagecount * getPixelFormatSize(pixelFormat);
+	stats.occupancy = pagecount == 0 ? 0.0f : (float) ((double) usedarea / (double) (pagearea * pagecount));
+	stats.evictions = evictedGlyphCount;
+	stats.compactions = atlasCompactionCount;
+}
+
+std::string Font::getGlyphCacheKey()
+{
+	love::thread::Lock lock(rasterizerMutex);
+
+	std::stringstream ss;
+
+	for (const StrongRef<love::font::Rasterizer> &r : rasterizers)
+	{
+		std::string key = r->getCacheKey();
+		if (key.empty())
+			return std::string();
+
+		ss << key << "\n";
+	}
+
+	ss << "spacesastab:" << useSpacesAsTab;
+	return ss.str();
+}
+
+void Font::saveGlyphCache(const std::string &filename)
+{
+	std::string key = getGlyphCacheKey();
+	if (key.empty())
+		throw love::Exception("Glyph caches are only supported for TrueType fonts.");
+
+	if (atlas->isShared())
+		throw love::Exception("Glyph caches can't be used with a shared texture atlas.");
+
+	auto fs = Module::getInstance<filesystem::Filesystem>(Module::M_FILESYSTEM);
+	if (fs == nullptr)
+		throw love::Exception("love.filesystem must be loaded in order to save a glyph cache.");
+
+	// Include glyphs which have finished loading in the background.
+	uploadLoadedGlyphs();
+
+	std::vector<uint8> out;
+
+	out.insert(out.end(), GLYPH_CACHE_MAGIC, GLYPH_CACHE_MAGIC + sizeof(GLYPH_CACHE_MAGIC));
+	writeCacheValue(out, GLYPH_CACHE_VERSION);
+	writeCacheValue(out, (uint32) key.size());
+	out.insert(out.end(), key.begin(), key.end());
+
+	writeCacheValue(out, (int32) pixelFormat);
+	writeCacheValue(out, (int32) atlas->getWidth());
+	writeCacheValue(out, (int32) atlas->getHeight());
+	writeCacheValue(out, (uint32) atlas->getPageCount());
+
+	size_t pagesize = (size_t) atlas->getWidth() * atlas->getHeight() * getPixelFormatSize(pixelFormat);
+
+	for (int i = 0; i < atlas->getPageCount(); i++)
+		out.insert(out.end(), atlas->getPixels(i), atlas->getPixels(i) + pagesize);
+
+	writeCacheValue(out, (uint32) glyphs.size());
+
+	for (const auto &glyphpair : glyphs)
+	{
+		const Glyph &g = glyphpair.second;
+
+		writeCacheValue(out, glyphpair.first);
+		writeCacheValue(out, (int32) g.spacing);
+		writeCacheValue(out, (int32) g.page);
+		writeCacheValue(out, g.rect);
+
+		for (int i = 0; i < 4; i++)
+		{
+			writeCacheValue(out, g.vertices[i].x);
+			writeCacheValue(out, g.vertices[i].y);
+		}
+	}
+
+	fs->write(filename.c_str(), out.data(), (int64) out.size());
+}
+
+bool Font::loadGlyphCache(const std::string &filename)
+{
+	std::string key = getGlyphCacheKey();
+	if (key.empty())
+		return false;
+
+	if (atlas->isShared())
+		throw love::Exception("Glyph caches can't be used with a shared texture atlas.");
+
+	auto fs = Module::getInstance<filesystem::Filesystem>(Module::M_FILESYSTEM);
+	if (fs == nullptr)
+		throw love::Exception("love.filesystem must be loaded in order to load a glyph cache.");
+
+	filesystem::Filesystem::Info info = {};
+	if (!fs->getInfo(filename.c_str(), info) || info.type != filesystem::Filesystem::FILETYPE_FILE)
+		return false;
+
+	StrongRef<filesystem::FileData> filedata(fs->read(filename.c_str()), Acquire::NORETAIN);
+
+	GlyphCacheReader r = {(const uint8 *) filedata->getData(), filedata->getSize(), 0};
+
+	char magic[sizeof(GLYPH_CACHE_MAGIC)];
+	uint32 version = 0;
+	uint32 keysize = 0;
+
+	if (!readCacheBytes(r, magic, sizeof(magic)) || memcmp(magic, GLYPH_CACHE_MAGIC, sizeof(magic)) != 0)
+		return false;
+
+	if (!readCacheValue(r, version) || version != GLYPH_CACHE_VERSION)
+		return false;
+
+	// A different font, size, DPI scale, hinting or render mode.
+	if (!readCacheValue(r, keysize) || keysize != key.size() || r.size - r.offset < keysize)
+		return false;
+
+	if (memcmp(r.data + r.offset, key.data(), keysize) != 0)
+		return false;
+
+	r.offset += keysize;
+
+	int32 format = 0;
+	int32 width = 0;
+	int32 height = 0;
+	uint32 pagecount = 0;
+
+	if (!readCacheValue(r, format) || format != (int32) pixelFormat)
+		return false;
+
+	if (!readCacheValue(r, width) || !readCacheValue(r, height) || !readCacheValue(r, pagecount))
+		return false;
+
+	int maxsize = 2048;
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+	if (gfx != nullptr)
+		maxsize = (int) gfx->getCapabilities().limits[Graphics::LIMIT_TEXTURE_SIZE];
+
+	if (width <= GlyphAtlas::PADDING || height <= GlyphAtlas::PADDING || width > maxsize || height > maxsize)
+		return false;
+
+	size_t pagesize = (size_t) width * height * getPixelFormatSize(pixelFormat);
+
+	if (pagecount == 0 || (r.size - r.offset) / pagesize < pagecount)
+		return false;
+
+	// The cached pages are only used as a source of pixels for the new atlas,
+	// so they never get textures.
+	StrongRef<GlyphAtlas> cachedatlas(new GlyphAtlas(pixelFormat, filter, width, height, false), Acquire::NORETAIN);
+
+	for (uint32 i = 0; i < pagecount; i++)
+	{
+		cachedatlas->addPage(r.data + r.offset);
+		r.offset += pagesize;
+	}
+
+	uint32 glyphcount = 0;
+	if (!readCacheValue(r, glyphcount))
+		return false;
+
+	std::vector<std::pair<uint32, Glyph>> cachedglyphs;
+	cachedglyphs.reserve(std::min<size_t>(glyphcount, r.size - r.offset));
+
+	for (uint32 i = 0; i < glyphcount; i++)
+	{
+		uint32 codepoint = 0;
+		int32 spacing = 0;
+		int32 page = 0;
+
+		Glyph g = {};
+
+		if (!readCacheValue(r, codepoint) || !readCacheValue(r, spacing) || !readCacheValue(r, page) || !readCacheValue(r, g.rect))
+			return false;
+
+		if (page < -1 || page >= (int32) pagecount)
+			return false;
+
+		const Rect &rect = g.rect;
+		if (page >= 0 && (rect.x < 0 || rect.y < 0 || rect.w <= 0 || rect.h <= 0 || rect.x + rect.w > width || rect.y + rect.h > height))
+			return false;
+
+		Color32 c = page >= 0 ? Color32(255, 255, 255, 255) : Color32(0, 0, 0, 0);
+
+		for (int j = 0; j < 4; j++)
+		{
+			if (!readCacheValue(r, g.vertices[j].x) || !readCacheValue(r, g.vertices[j].y))
+				return false;
+
+			g.vertices[j].color = c;
+		}
+
+		g.spacing = spacing;
+		g.page = page;
+		g.lastUsed = glyphUseStamp;
+		g.atlasEntry = -1;
+
+		cachedglyphs.emplace_back(codepoint, g);
+	}
+
+	// Replace the current atlas. The cached pages are repacked into new
+	// textures, which also restores the packers' state.
+	clearGlyphs();
+	atlas = cachedatlas;
+
+	for (const auto &glyphpair : cachedglyphs)
+	{
+		Glyph &stored = glyphs[glyphpair.first];
+		stored = glyphpair.second;
+		setGlyphTableEntry(glyphpair.first, &stored);
+	}
+
+	TextureSize size = {width, height};
+	rebuildAtlas(size);
+	flushGlyphUploads();
+
+	return true;
+}
+
+Shader::StandardShader Font::getStandardShaderType() const
+{
+	// Without the shader (if it failed to compile), the distance field is
+	// drawn as-is, which looks blurry but still readable.
+	if (rasterizers[0]->isDistanceField() && Shader::standardShaders[Shader::STANDARD_DISTANCE_FIELD] != nullptr)
+		return Shader::STANDARD_DISTANCE_FIELD;
+
+	return Shader::STANDARD_DEFAULT;
+}
+
 uint32 Font::getTextureCacheID() const
 {
 	return textureCacheID;
@@ -1029,6 +2181,21 @@ std::vector<std::string> Font::getConstants(AlignMode)
 	return alignModes.getNames();
 }
 
+bool Font::getConstant(const char *in, GlyphLoadMode &out)
+{
+	return glyphLoadModes.find(in, out);
+}
+
+bool Font::getConstant(GlyphLoadMode in, const char *&out)
+{
+	return glyphLoadModes.find(in, out);
+}
+
+std::vector<std::string> Font::getConstants(GlyphLoadMode)
+{
+	return glyphLoadModes.getNames();
+}
+
 StringMap<Font::AlignMode, Font::ALIGN_MAX_ENUM>::Entry Font::alignModeEntries[] =
 {
 	{ "left", ALIGN_LEFT },
@@ -1039,5 +2206,13 @@ StringMap<Font::AlignMode, Font::ALIGN_MAX_ENUM>::Entry Font::alignModeEntries[]
 
 StringMap<Font::AlignMode, Font::ALIGN_MAX_ENUM> Font::alignModes(Font::alignModeEntries, sizeof(Font::alignModeEntries));
 
+StringMap<Font::GlyphLoadMode, Font::GLYPH_LOAD_MAX_ENUM>::Entry Font::glyphLoadModeEntries[] =
+{
+	{ "sync",  GLYPH_LOAD_SYNC  },
+	{ "async", GLYPH_LOAD_ASYNC },
+};
+
+StringMap<Font::GlyphLoadMode, Font::GLYPH_LOAD_MAX_ENUM> Font::glyphLoadModes(Font::glyphLoadModeEntries, sizeof(Font::glyphLoadModeEntries));
+
 } // graphics
 } // love
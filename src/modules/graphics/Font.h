@@ -21,7 +21,11 @@
 #pragma once
 
 // STD
+#include <atomic>
+#include <deque>
+#include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <vector>
 #include <stddef.h>
@@ -33,7 +37,10 @@
 #include "common/Vector.h"
 
 #include "font/Rasterizer.h"
+#include "thread/threads.h"
+#include "GlyphAtlas.h"
 #include "Image.h"
+#include "Shader.h"
 #include "vertex.h"
 #include "Volatile.h"
 
@@ -43,6 +50,7 @@ namespace graphics
 {
 
 class Graphics;
+class GlyphWorker;
 
 class Font : public Object, public Volatile
 {
@@ -64,6 +72,13 @@ class Font : public Object, public Volatile
 		ALIGN_MAX_ENUM
 	};
 
+	enum GlyphLoadMode
+	{
+		GLYPH_LOAD_SYNC,
+		GLYPH_LOAD_ASYNC,
+		GLYPH_LOAD_MAX_ENUM
+	};
+
 	struct ColoredString
 	{
 		std::string str;
@@ -86,6 +101,17 @@ class Font : public Object, public Volatile
 	{
 		int width;
 		int height;
+		int lines;
+	};
+
+	struct AtlasStats
+	{
+		int pages;
+		int glyphs;
+		int64 memory;
+		float occupancy;
+		int64 evictions;
+		int compactions;
 	};
 
 	// Used to determine when to change textures in the generated vertex array.
@@ -103,14 +129,20 @@ class Font : public Object, public Volatile
 	std::vector<DrawCommand> generateVertices(const ColoredCodepoints &codepoints, const Colorf &constantColor, std::vector<GlyphVertex> &vertices,
 	                                          float extra_spacing = 0.0f, Vector2 offset = {}, TextInfo *info = nullptr);
 
+	/**
+	 * Generates vertices for wrapped and aligned text. The first line is
+	 * placed where the given line of a longer text would be, so separately
+	 * generated paragraphs line up exactly with text generated all at once.
+	 **/
 	std::vector<DrawCommand> generateVerticesFormatted(const ColoredCodepoints &text, const Colorf &constantColor, float wrap, AlignMode align,
-	                                                   std::vector<GlyphVertex> &vertices, TextInfo *info = nullptr);
+	                                                   std::vector<GlyphVertex> &vertices, TextInfo *info = nullptr, int firstline = 0);
 
 	static void getCodepointsFromString(const std::string &str, Codepoints &codepoints);
 	static void getCodepointsFromString(const std::vector<ColoredString> &strs, ColoredCodepoints &codepoints);
 
 	/**
-	 * Draws the specified text.
+	 * Draws the specified text. Recently drawn text reuses its generated
+	 * vertices, as long as the Font's texture cache hasn't been invalidated.
 	 **/
 	void print(graphics::Graphics *gfx, const std::vector<ColoredString> &text, const Matrix4 &m, const Colorf &constantColor);
 	void printf(graphics::Graphics *gfx, const std::vector<ColoredString> &text, float wrap, AlignMode align, const Matrix4 &m, const Colorf &constantColor);
@@ -146,6 +178,15 @@ class Font : public Object, public Volatile
 	void getWrap(const std::vector<ColoredString> &text, float wraplimit, std::vector<std::string> &lines, std::vector<int> *line_widths = nullptr);
 	void getWrap(const ColoredCodepoints &codepoints, float wraplimit, std::vector<ColoredCodepoints> &lines, std::vector<int> *line_widths = nullptr);
 
+	/**
+	 * Measures many strings at once. String i is the UTF-8 text from
+	 * offsets[i] to offsets[i + 1] in text, so offsets has count + 1 entries.
+	 * If wraplimit is negative, widths get the same values as getWidth.
+	 * Otherwise they get the widest line after wrapping, as with getWrap.
+	 * linecounts (optional) receives the number of lines in each string.
+	 **/
+	void getWidths(const char *text, const int *offsets, int count, float wraplimit, int *widths, int *linecounts = nullptr);
+
 	/**
 	 * Sets the line height (which should be a number to multiply the font size by,
 	 * example: line height = 1.2 and size = 12 means that rendered line height = 12*1.2)
@@ -171,8 +212,83 @@ class Font : public Object, public Volatile
 
 	void setFallbacks(const std::vector<Font *> &fallbacks);
 
+	/**
+	 * Sets whether glyphs which aren't in the texture atlas yet are rasterized
+	 * as soon as they're used, or queued for a background thread. Queued
+	 * glyphs use the placeholder glyph (or nothing, if there's no placeholder)
+	 * until they've been added to the atlas.
+	 **/
+	void setGlyphLoadMode(GlyphLoadMode mode);
+	GlyphLoadMode getGlyphLoadMode() const;
+
+	void setGlyphPlaceholder(uint32 glyph);
+	void setGlyphPlaceholder();
+	bool getGlyphPlaceholder(uint32 &glyph) const;
+
+	/**
+	 * Queues glyphs to be rasterized in the background, regardless of the
+	 * glyph load mode.
+	 **/
+	void preloadGlyphs(const Codepoints &codepoints);
+
+	/**
+	 * Gets the number of glyphs which are queued or rasterized, but haven't
+	 * been added to the texture atlas yet.
+	 **/
+	int getPendingGlyphCount() const;
+
+	/**
+	 * Adds glyphs which have finished rasterizing in the background to the
+	 * texture atlas, using one upload per modified atlas page. Invalidates the
+	 * texture cache if any glyphs were added.
+	 **/
+	void uploadLoadedGlyphs();
+
+	/**
+	 * Sets the amount of texture memory (in bytes) the glyph atlas should try
+	 * to stay within, or 0 for no limit. When the atlas is full and can't
+	 * grow, the least recently used glyphs are evicted and the remaining ones
+	 * are compacted. The limit is exceeded if the text currently being laid
+	 * out doesn't fit otherwise.
+	 **/
+	void setAtlasMemoryBudget(int64 bytes);
+	int64 getAtlasMemoryBudget() const;
+
+	void getAtlasStats(AtlasStats &stats) const;
+
+	/**
+	 * Sets whether the Font's glyphs go in a texture atlas shared with other
+	 * Fonts which use the same pixel format and filter. Text in Fonts sharing
+	 * an atlas can be drawn with the same draw calls. Identical glyphs of
+	 * Fonts with the same Rasterizers are only stored once. Shared atlases
+	 * never move glyphs, so they get more pages when full. The memory budget
+	 * then applies to the whole shared atlas, and only evicts the Font's own
+	 * glyphs. Changing this rasterizes the Font's glyphs again.
+	 **/
+	void setAtlasShared(bool shared);
+	bool isAtlasShared() const;
+
+	/**
+	 * Saves the glyphs in the texture atlas and their metrics to a file in the
+	 * save directory, so they don't have to be rasterized on later runs.
+	 **/
+	void saveGlyphCache(const std::string &filename);
+
+	/**
+	 * Replaces the glyphs in the texture atlas with ones saved by
+	 * saveGlyphCache. Returns false if the file doesn't exist or was saved
+	 * with different font data, size, DPI scale, hinting or render mode.
+	 **/
+	bool loadGlyphCache(const std::string &filename);
+
 	float getDPIScale() const;
 
+	/**
+	 * Gets the standard shader the Font's glyphs are drawn with when no custom
+	 * shader is active.
+	 **/
+	Shader::StandardShader getStandardShaderType() const;
+
 	uint32 getTextureCacheID() const;
 
 	// Implements Volatile.
@@ -183,15 +299,25 @@ class Font : public Object, public Volatile
 	static bool getConstant(AlignMode in, const char *&out);
 	static std::vector<std::string> getConstants(AlignMode);
 
+	static bool getConstant(const char *in, GlyphLoadMode &out);
+	static bool getConstant(GlyphLoadMode in, const char *&out);
+	static std::vector<std::string> getConstants(GlyphLoadMode);
+
 	static int fontCount;
 
 private:
 
+	friend class GlyphWorker;
+
 	struct Glyph
 	{
 		Texture *texture;
 		int spacing;
 		GlyphVertex vertices[4];
+		int page; // -1 for empty glyphs, which aren't in the atlas.
+		Rect rect;
+		uint32 lastUsed;
+		int atlasEntry; // The glyph's entry in a shared atlas, or -1.
 	};
 
 	struct TextureSize
@@ -200,15 +326,61 @@ class Font : public Object, public Volatile
 		int height;
 	};
 
-	void createTexture();
+	// Glyphs used within the outermost layout call share a use stamp, so
+	// they can't be evicted while that call still references them.
+	class GlyphUseScope
+	{
+	public:
+		GlyphUseScope(Font *font);
+		~GlyphUseScope();
+	private:
+		Font *font;
+	};
+
+	void packGlyph(int w, int h, int &page, Rect &rect);
+	void rebuildAtlas(const TextureSize &size);
+	int evictGlyphs();
+	void setGlyphTexCoords(Glyph &g) const;
+	bool isWithinAtlasBudget(int64 bytes) const;
 
 	TextureSize getNextTextureSize() const;
 	love::font::GlyphData *getRasterizerGlyphData(uint32 glyph);
+	int getRasterizerGlyphAdvance(uint32 glyph);
 	const Glyph &addGlyph(uint32 glyph);
+	const Glyph &addGlyph(love::font::GlyphData *gd);
 	const Glyph &findGlyph(uint32 glyph);
+
+	// Gets the spacing of a glyph for measuring text. Unlike findGlyph, this
+	// is never a placeholder's while the glyph loads asynchronously.
+	int getGlyphSpacing(uint32 glyph);
+	Glyph *lookupGlyph(uint32 glyph);
+	void setGlyphTableEntry(uint32 glyph, Glyph *g);
+	void clearGlyphs();
+	void queueGlyph(uint32 glyph);
+	bool rasterizeQueuedGlyph();
+	bool hasQueuedGlyphs() const;
+	void flushGlyphUploads();
 	float getKerning(uint32 leftglyph, uint32 rightglyph);
+	int getCodepointsWidth(const Codepoints &codepoints);
+	std::string getGlyphCacheKey();
+	int getKerningIndex(uint32 glyph);
 	void printv(Graphics *gfx, const Matrix4 &t, const std::vector<DrawCommand> &drawcommands, const std::vector<GlyphVertex> &vertices);
 
+	struct CachedLayout
+	{
+		uint64 hash;
+		std::vector<ColoredString> text;
+		Colorf color;
+		float wrap;
+		AlignMode align;
+		std::vector<GlyphVertex> vertices;
+		std::vector<DrawCommand> commands;
+		Codepoints glyphs;
+	};
+
+	// Returns null if the text's layout isn't (yet) worth caching.
+	const CachedLayout *getCachedLayout(const std::vector<ColoredString> &text, const Colorf &constantcolor, float wrap, AlignMode align);
+
 	std::vector<StrongRef<love::font::Rasterizer>> rasterizers;
 
 	int height;
@@ -217,38 +389,109 @@ class Font : public Object, public Volatile
 	int textureWidth;
 	int textureHeight;
 
-	std::vector<StrongRef<love::graphics::Image>> images;
+	StrongRef<GlyphAtlas> atlas;
+
+	// Identifies the Font's glyphs in a shared atlas, so Fonts with the same
+	// Rasterizers can use the same glyphs. Empty if they can't be shared.
+	std::string atlasKey;
 
 	// maps glyphs to glyph texture information
 	std::unordered_map<uint32, Glyph> glyphs;
 
-	// map of left/right glyph pairs to horizontal kerning.
+	// Glyphs in the Basic Multilingual Plane are found through a two-level
+	// table of pointers into the glyphs map. Pages are allocated on first use.
+	std::vector<std::vector<Glyph *>> glyphTable;
+
+	// map of left/right glyph pairs to horizontal kerning, for glyphs which
+	// don't have a dense kerning index.
 	std::unordered_map<uint64, float> kerning;
 
+	// Dense indices (plus one) of the glyphs in the kerning matrix, in the
+	// same two-level layout as glyphTable.
+	std::vector<std::vector<uint16>> kerningIndexTable;
+
+	// Kerning between pairs of indexed glyphs, NaN until it's first needed.
+	std::vector<float> kerningMatrix;
+	int kerningGlyphCount;
+
 	PixelFormat pixelFormat;
 
 	Texture::Filter filter;
 
 	float dpiScale;
 
-	int textureX, textureY;
-	int rowHeight;
-
 	bool useSpacesAsTab;
 
 	// ID which is incremented when the texture cache is invalidated.
 	uint32 textureCacheID;
 
-	// 1 pixel of transparent padding between glyphs (so quads won't pick up
-	// other glyphs), plus one pixel of transparent padding that the quads will
-	// use, for edge antialiasing.
-	static const int TEXTURE_PADDING = 2;
+	GlyphLoadMode glyphLoadMode;
+
+	uint32 placeholderGlyph;
+	bool hasPlaceholderGlyph;
+
+	// Used in place of glyphs which are still loading, without a placeholder.
+	Glyph pendingGlyph;
+
+	// Guards the list of rasterizers, which the glyph worker thread shares.
+	// Each Rasterizer is also locked while in use, since other Fonts may use
+	// it as a fallback.
+	love::thread::MutexRef rasterizerMutex;
+
+	// Guards the queued and loaded glyph lists.
+	love::thread::MutexRef glyphMutex;
+
+	std::deque<uint32> queuedGlyphs;
+	std::unordered_set<uint32> pendingGlyphs;
+	std::vector<StrongRef<love::font::GlyphData>> loadedGlyphs;
+	std::atomic<bool> hasLoadedGlyphs;
+
+	bool usingGlyphWorker;
+
+	// Whether dirty atlas pages are uploaded after each added glyph, or once
+	// all loaded glyphs have been added.
+	bool batchingGlyphUploads;
+
+	// Texture memory the atlas tries to stay within, or 0 for no limit.
+	int64 atlasMemoryBudget;
+
+	uint32 glyphUseStamp;
+	int glyphUseDepth;
+
+	int64 evictedGlyphCount;
+	int atlasCompactionCount;
+
+	// Most recently used layouts first. Only valid for layoutCacheID.
+	std::list<CachedLayout> layoutCache;
+	uint32 layoutCacheID;
+
+	static const size_t MAX_CACHED_LAYOUTS = 64;
+	static const size_t MAX_LAYOUT_CANDIDATES = 128;
+
+	// Hashes of recently printed layouts which aren't cached. A layout is only
+	// cached when it's printed again while still in here, so text which
+	// changes every frame doesn't churn the cache.
+	uint64 layoutCandidates[MAX_LAYOUT_CANDIDATES];
+	size_t nextLayoutCandidate;
+
+	// Text longer than this (in bytes) isn't worth keeping vertices around for.
+	static const size_t MAX_CACHED_LAYOUT_SIZE = 1024;
+
+	static const uint32 GLYPH_TABLE_PAGE_BITS = 8;
+	static const uint32 GLYPH_TABLE_PAGE_SIZE = 1 << GLYPH_TABLE_PAGE_BITS;
+	static const uint32 GLYPH_TABLE_SIZE = 0x10000;
+
+	// Glyphs beyond this many use the kerning map. The full matrix is 256 KB.
+	static const int MAX_KERNING_GLYPHS = 256;
 
 	// This will be used if the Rasterizer doesn't have a tab character itself.
 	static const int SPACES_PER_TAB = 4;
 
 	static StringMap<AlignMode, ALIGN_MAX_ENUM>::Entry alignModeEntries[];
 	static StringMap<AlignMode, ALIGN_MAX_ENUM> alignModes;
+
+	static StringMap<GlyphLoadMode, GLYPH_LOAD_MAX_ENUM>::Entry glyphLoadModeEntries[];
+	static StringMap<GlyphLoadMode, GLYPH_LOAD_MAX_ENUM> glyphLoadModes;
 	
 }; // Font
 
@@ -0,0 +1,480 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "GlyphAtlas.h"
+#include "Graphics.h"
+
+// C++
+#include <algorithm>
+
+namespace love
+{
+namespace graphics
+{
+
+std::vector<GlyphAtlas *> GlyphAtlas::sharedAtlases;
+
+// Transparent white for Luminance-Alpha formats (since we keep luminance
+// constant and vary alpha in those glyphs), and transparent black otherwise.
+static void fillEmptyPixels(PixelFormat format, uint8 *data, size_t pixelcount)
+{
+	memset(data, 0, pixelcount * getPixelFormatSize(format));
+
+	if (format == PIXELFORMAT_LA8)
+	{
+		for (size_t i = 0; i < pixelcount; i++)
+			data[i * 2 + 0] = 255;
+	}
+}
+
+static bool isSameFilter(const Texture::Filter &a, const Texture::Filter &b)
+{
+	return a.min == b.min && a.mag == b.mag && a.mipmap == b.mipmap && a.anisotropy == b.anisotropy;
+}
+
+GlyphAtlas::GlyphAtlas(PixelFormat format, const Texture::Filter &filter, int width, int height, bool shared)
+	: format(format)
+	, filter(filter)
+	, width(width)
+	, height(height)
+	, shared(shared)
+{
+	if (shared)
+		sharedAtlases.push_back(this);
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	if (shared)
+		sharedAtlases.erase(std::remove(sharedAtlases.begin(), sharedAtlases.end(), this), sharedAtlases.end());
+}
+
+GlyphAtlas *GlyphAtlas::getShared(PixelFormat format, const Texture::Filter &filter)
+{
+	for (GlyphAtlas *atlas : sharedAtlases)
+	{
+		if (atlas->format == format && isSameFilter(atlas->filter, filter))
+		{
+			atlas->retain();
+			return atlas;
+		}
+	}
+
+	// Shared pages are never resized, so they start out large enough to hold
+	// the glyphs of several Fonts.
+	int size = 1024;
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+	if (gfx != nullptr)
+		size = std::min(size, (int) gfx->getCapabilities().limits[Graphics::LIMIT_TEXTURE_SIZE]);
+
+	return new GlyphAtlas(format, filter, size, size, true);
+}
+
+void GlyphAtlas::addPage(const uint8 *pixels)
+{
+	Page page = {
+		StrongRef<Image>(),
+		// The packer doesn't include the right and bottom border padding.
+		SkylinePacker(width - PADDING, height - PADDING),
+		std::vector<uint8>(),
+		{0, 0, width, height},
+		true,
+		std::vector<Rect>(),
+		0,
+		0
+	};
+
+	allocatePixels(page, pixels);
+	pages.push_back(std::move(page));
+}
+
+void GlyphAtlas::allocatePixels(Page &page, const uint8 *pixels)
+{
+	size_t pixelcount = (size_t) width * height;
+	size_t size = pixelcount * getPixelFormatSize(format);
+
+	if (pixels != nullptr)
+		page.pixels.assign(pixels, pixels + size);
+	else
+	{
+		page.pixels.resize(size);
+		fillEmptyPixels(format, page.pixels.data(), pixelcount);
+	}
+
+	page.dirtyRect = {0, 0, width, height};
+	page.dirty = true;
+}
+
+bool GlyphAtlas::pack(int w, int h, int &page, Rect &rect)
+{
+	// Each glyph reserves the padding to its top and left.
+	int pw = w + PADDING;
+	int ph = h + PADDING;
+
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		Page &p = pages[i];
+
+		// Use the smallest free rect the glyph fits in, and give the rest of
+		// it back as two smaller free rects.
+		int best = -1;
+		int64 bestarea = 0;
+
+		for (size_t j = 0; j < p.freeRects.size(); j++)
+		{
+			const Rect &r = p.freeRects[j];
+			int64 area = (int64) r.w * r.h;
+
+			if (r.w >= pw && r.h >= ph && (best < 0 || area < bestarea))
+			{
+				best = (int) j;
+				bestarea = area;
+			}
+		}
+
+		if (best >= 0)
+		{
+			Rect r = p.freeRects[best];
+
+			p.freeRects[best] = p.freeRects.back();
+			p.freeRects.pop_back();
+
+			if (r.w > pw)
+				p.freeRects.push_back({r.x + pw, r.y, r.w - pw, ph});
+			if (r.h > ph)
+				p.freeRects.push_back({r.x, r.y + ph, r.w, r.h - ph});
+
+			p.freeArea -= (int64) pw * ph;
+
+			page = (int) i;
+			rect = {r.x + PADDING, r.y + PADDING, w, h};
+			return true;
+		}
+
+		int x = 0;
+		int y = 0;
+
+		if (p.packer.pack(pw, ph, x, y))
+		{
+			if (p.pixels.empty())
+				allocatePixels(p, nullptr);
+
+			page = (int) i;
+			rect = {x + PADDING, y + PADDING, w, h};
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int GlyphAtlas::acquireGlyph(const std::string &key, uint32 glyph, int &page, Rect &rect)
+{
+	if (key.empty())
+		return -1;
+
+	auto keyit = entryLookup.find(key);
+	if (keyit == entryLookup.end())
+		return -1;
+
+	auto it = keyit->second.find(glyph);
+	if (it == keyit->second.end())
+		return -1;
+
+	Entry &e = entries[it->second];
+	e.references++;
+
+	page = e.page;
+	rect = e.rect;
+	return it->second;
+}
+
+int GlyphAtlas::addGlyph(const std::string &key, uint32 glyph, int page, const Rect &rect)
+{
+	int id = (int) entries.size();
+
+	if (!freeEntries.empty())
+	{
+		id = freeEntries.back();
+		freeEntries.pop_back();
+	}
+	else
+		entries.push_back(Entry());
+
+	Entry &e = entries[id];
+
+	e.key = nullptr;
+	e.glyph = glyph;
+	e.page = page;
+	e.rect = rect;
+	e.references = 1;
+
+	if (!key.empty())
+	{
+		auto keyit = entryLookup.emplace(key, std::unordered_map<uint32, int>()).first;
+		keyit->second[glyph] = id;
+
+		// Keys of the lookup map stay at the same address while it has them.
+		e.key = &keyit->first;
+	}
+
+	pages[page].glyphCount++;
+	return id;
+}
+
+void GlyphAtlas::releaseGlyph(int entry)
+{
+	Entry &e = entries[entry];
+
+	if (--e.references > 0)
+		return;
+
+	if (e.key != nullptr)
+	{
+		auto keyit = entryLookup.find(*e.key);
+		keyit->second.erase(e.glyph);
+
+		if (keyit->second.empty())
+			entryLookup.erase(keyit);
+
+		e.key = nullptr;
+	}
+
+	freeEntries.push_back(entry);
+
+	Page &p = pages[e.page];
+
+	if (--p.glyphCount == 0)
+	{
+		freePage(e.page);
+		return;
+	}
+
+	Rect r = {e.rect.x - PADDING, e.rect.y - PADDING, e.rect.w + PADDING, e.rect.h + PADDING};
+	size_t bpp = getPixelFormatSize(format);
+
+	// A smaller glyph packed here later won't overwrite all of the old one,
+	// and the rest of it would show up in the new glyph's padding.
+	for (int y = 0; y < r.h; y++)
+		fillEmptyPixels(format, &p.pixels[((r.y + y) * width + r.x) * bpp], r.w);
+
+	addDirtyRect(p, r);
+
+	p.freeRects.push_back(r);
+	p.freeArea += (int64) r.w * r.h;
+}
+
+void GlyphAtlas::freePage(int page)
+{
+	Page &p = pages[page];
+
+	if (p.image.get() != nullptr)
+	{
+		// Batched draws may still use the page's texture.
+		auto gfx = Module::getInstance<graphics::Graphics>(Module::M_GRAPHICS);
+		if (gfx != nullptr)
+			gfx->flushStreamDraws();
+
+		p.image.set(nullptr);
+	}
+
+	p.packer.reset(width - PADDING, height - PADDING);
+	p.freeRects.clear();
+	p.freeArea = 0;
+	p.dirty = false;
+
+	std::vector<uint8>().swap(p.pixels);
+
+	// Other pages keep their indices, so only unused pages at the end can be
+	// removed.
+	while (!pages.empty() && pages.back().glyphCount == 0 && pages.back().pixels.empty())
+		pages.pop_back();
+}
+
+void GlyphAtlas::writePixels(int page, const Rect &rect, const uint8 *data, size_t pitch)
+{
+	Page &p = pages[page];
+	size_t bpp = getPixelFormatSize(format);
+	size_t rowsize = rect.w * bpp;
+
+	for (int y = 0; y < rect.h; y++)
+	{
+		uint8 *dst = &p.pixels[((rect.y + y) * width + rect.x) * bpp];
+		memcpy(dst, data + y * pitch, rowsize);
+	}
+
+	addDirtyRect(p, rect);
+}
+
+void GlyphAtlas::addDirtyRect(Page &p, const Rect &rect)
+{
+	if (p.dirty)
+	{
+		int right = std::max(p.dirtyRect.x + p.dirtyRect.w, rect.x + rect.w);
+		int bottom = std::max(p.dirtyRect.y + p.dirtyRect.h, rect.y + rect.h);
+
+		p.dirtyRect.x = std::min(p.dirtyRect.x, rect.x);
+		p.dirtyRect.y = std::min(p.dirtyRect.y, rect.y);
+		p.dirtyRect.w = right - p.dirtyRect.x;
+		p.dirtyRect.h = bottom - p.dirtyRect.y;
+	}
+	else
+	{
+		p.dirtyRect = rect;
+		p.dirty = true;
+	}
+}
+
+void GlyphAtlas::flush()
+{
+	size_t bpp = getPixelFormatSize(format);
+	std::vector<uint8> rectdata;
+
+	// Everything written to a page since the last flush is uploaded as one
+	// rectangle, copied from the page's CPU-side pixels.
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		Page &page = pages[i];
+
+		if (!page.dirty)
+			continue;
+
+		Image *image = getImage((int) i);
+
+		const Rect &r = page.dirtyRect;
+		size_t rowsize = r.w * bpp;
+
+		rectdata.resize(rowsize * r.h);
+
+		for (int y = 0; y < r.h; y++)
+		{
+			const uint8 *src = &page.pixels[((r.y + y) * width + r.x) * bpp];
+			memcpy(&rectdata[y * rowsize], src, rowsize);
+		}
+
+		image->replacePixels(rectdata.data(), rectdata.size(), 0, 0, r, false);
+		page.dirty = false;
+	}
+}
+
+void GlyphAtlas::clear()
+{
+	pages.clear();
+	entries.clear();
+	freeEntries.clear();
+	entryLookup.clear();
+}
+
+Image *GlyphAtlas::getImage(int page)
+{
+	Page &p = pages[page];
+
+	if (p.image.get() == nullptr)
+	{
+		auto gfx = Module::getInstance<graphics::Graphics>(Module::M_GRAPHICS);
+		gfx->flushStreamDraws();
+
+		Image::Settings settings;
+		Image *image = gfx->newImage(TEXTURE_2D, format, width, height, 1, settings);
+		image->setFilter(filter);
+
+		p.image.set(image, Acquire::NORETAIN);
+
+		// The new texture's contents are undefined until they're uploaded.
+		p.dirtyRect = {0, 0, width, height};
+		p.dirty = true;
+	}
+
+	return p.image;
+}
+
+const uint8 *GlyphAtlas::getPixels(int page) const
+{
+	return pages[page].pixels.data();
+}
+
+int64 GlyphAtlas::getUsedArea(int page) const
+{
+	return pages[page].packer.getUsedArea() - pages[page].freeArea;
+}
+
+int GlyphAtlas::getPageCount() const
+{
+	return (int) pages.size();
+}
+
+bool GlyphAtlas::isPageAllocated(int page) const
+{
+	return !pages[page].pixels.empty();
+}
+
+int64 GlyphAtlas::getMemorySize() const
+{
+	int64 pagesize = (int64) width * height * getPixelFormatSize(format);
+	int64 size = 0;
+
+	for (const Page &page : pages)
+	{
+		if (!page.pixels.empty())
+			size += pagesize;
+	}
+
+	return size;
+}
+
+int GlyphAtlas::getWidth() const
+{
+	return width;
+}
+
+int GlyphAtlas::getHeight() const
+{
+	return height;
+}
+
+PixelFormat GlyphAtlas::getFormat() const
+{
+	return format;
+}
+
+void GlyphAtlas::setFilter(const Texture::Filter &f)
+{
+	for (const Page &page : pages)
+	{
+		if (page.image.get() != nullptr)
+			page.image->setFilter(f);
+	}
+
+	filter = f;
+}
+
+const Texture::Filter &GlyphAtlas::getFilter() const
+{
+	return filter;
+}
+
+bool GlyphAtlas::isShared() const
+{
+	return shared;
+}
+
+} // graphics
+} // love
@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/int.h"
+#include "common/math.h"
+#include "common/Object.h"
+#include "common/pixelformat.h"
+#include "Image.h"
+#include "SkylinePacker.h"
+#include "Texture.h"
+
+// C++
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace love
+{
+namespace graphics
+{
+
+/**
+ * Pages of glyph images used by Fonts, with a CPU-side copy of each page so
+ * new glyphs can be uploaded in batches and moved when a Font rebuilds its
+ * atlas.
+ *
+ * A Font normally has an atlas of its own, which grows and is compacted as
+ * needed. Fonts can instead use an atlas shared with all other Fonts of the
+ * same pixel format and filter, so text in different Fonts can be batched
+ * into the same draw calls. Shared atlases don't move glyphs. Instead, each
+ * glyph in them is reference counted by the Fonts using it, and its space is
+ * reused once no Font references it any more.
+ **/
+class GlyphAtlas : public love::Object
+{
+public:
+
+	// 1 pixel of transparent padding between glyphs (so quads won't pick up
+	// other glyphs), plus one pixel of transparent padding that the quads will
+	// use, for edge antialiasing.
+	static const int PADDING = 2;
+
+	GlyphAtlas(PixelFormat format, const Texture::Filter &filter, int width, int height, bool shared);
+	virtual ~GlyphAtlas();
+
+	/**
+	 * Gets the shared atlas for glyphs of the given format and filter,
+	 * creating it if needed. The returned atlas is retained.
+	 **/
+	static GlyphAtlas *getShared(PixelFormat format, const Texture::Filter &filter);
+
+	/**
+	 * Adds an empty page, or one with the given pixels. The page's texture is
+	 * created the first time it's needed.
+	 **/
+	void addPage(const uint8 *pixels = nullptr);
+
+	/**
+	 * Finds space for a w*h glyph in the existing pages. The glyph's rect
+	 * excludes the padding around it.
+	 **/
+	bool pack(int w, int h, int &page, Rect &rect);
+
+	/**
+	 * Finds a glyph already added with the same key (which identifies the
+	 * Rasterizers used for it) and adds a reference to it. Returns the glyph's
+	 * entry, or -1 if it isn't in the atlas. Glyphs with an empty key are
+	 * never found.
+	 **/
+	int acquireGlyph(const std::string &key, uint32 glyph, int &page, Rect &rect);
+
+	/**
+	 * Adds a reference counted entry for a glyph packed with pack(), with one
+	 * reference. Returns the glyph's entry.
+	 **/
+	int addGlyph(const std::string &key, uint32 glyph, int page, const Rect &rect);
+
+	/**
+	 * Removes a reference to a glyph's entry. The glyph's space can be packed
+	 * again once it has no references, and pages without glyphs are freed.
+	 **/
+	void releaseGlyph(int entry);
+
+	void writePixels(int page, const Rect &rect, const uint8 *data, size_t pitch);
+
+	/**
+	 * Uploads everything written to each page since the last flush.
+	 **/
+	void flush();
+
+	/**
+	 * Removes all pages.
+	 **/
+	void clear();
+
+	Image *getImage(int page);
+	const uint8 *getPixels(int page) const;
+	int64 getUsedArea(int page) const;
+	int getPageCount() const;
+
+	/**
+	 * Whether the page has pixels. Pages of shared atlases are freed when
+	 * their glyphs are released, and reallocated when glyphs are packed in
+	 * them again.
+	 **/
+	bool isPageAllocated(int page) const;
+	int64 getMemorySize() const;
+
+	int getWidth() const;
+	int getHeight() const;
+	PixelFormat getFormat() const;
+
+	void setFilter(const Texture::Filter &f);
+	const Texture::Filter &getFilter() const;
+
+	bool isShared() const;
+
+private:
+
+	struct Page
+	{
+		StrongRef<Image> image;
+		SkylinePacker packer;
+		std::vector<uint8> pixels;
+		Rect dirtyRect;
+		bool dirty;
+
+		// Padded space of released glyphs, which is packed again before the
+		// skyline grows.
+		std::vector<Rect> freeRects;
+		int64 freeArea;
+		int glyphCount;
+	};
+
+	struct Entry
+	{
+		const std::string *key;
+		uint32 glyph;
+		int page;
+		Rect rect;
+		int references;
+	};
+
+	void allocatePixels(Page &page, const uint8 *pixels);
+	void freePage(int page);
+	void addDirtyRect(Page &page, const Rect &rect);
+
+	std::vector<Page> pages;
+
+	std::vector<Entry> entries;
+	std::vector<int> freeEntries;
+
+	// Entries of glyphs which can be shared, by key and glyph.
+	std::unordered_map<std::string, std::unordered_map<uint32, int>> entryLookup;
+
+	PixelFormat format;
+	Texture::Filter filter;
+
+	int width;
+	int height;
+
+	bool shared;
+
+	static std::vector<GlyphAtlas *> sharedAtlases;
+
+}; // GlyphAtlas
+
+} // graphics
+} // love
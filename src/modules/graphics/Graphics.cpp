@@ -35,7 +35,9 @@
 
 // C++
 #include <algorithm>
+#include <limits>
 #include <stdlib.h>
+#include <string.h>
 
 namespace love
 {
@@ -43,6 +45,7 @@ namespace graphics
 {
 
 static bool gammaCorrect = false;
+static size_t streamBufferSize = 1024 * 1024;
 static bool debugMode = false;
 static bool debugModeQueried = false;
 
@@ -56,6 +59,16 @@ bool isGammaCorrect()
 	return gammaCorrect;
 }
 
+void setStreamBufferSize(size_t size)
+{
+	streamBufferSize = size;
+}
+
+size_t getStreamBufferSize()
+{
+	return streamBufferSize;
+}
+
 void gammaCorrectColor(Colorf &c)
 {
 	if (isGammaCorrect())
@@ -115,10 +128,13 @@ Graphics::Graphics()
 	, active(true)
 	, writingToStencil(false)
 	, streamBufferState()
+	, batchMode(BATCH_IMMEDIATE)
 	, projectionMatrix()
 	, canvasSwitchCount(0)
 	, drawCalls(0)
 	, drawCallsBatched(0)
+	, batchesMerged(0)
+	, streamBytes(0)
 	, quadIndexBuffer(nullptr)
 	, capabilities()
 	, cachedShaderStages()
@@ -160,6 +176,7 @@ Graphics::~Graphics()
 	delete streamBufferState.vb[0];
 	delete streamBufferState.vb[1];
 	delete streamBufferState.indexBuffer;
+	delete streamBufferState.textureIndexBuffer;
 
 	for (int i = 0; i < (int) ShaderStage::STAGE_MAX_ENUM; i++)
 		cachedShaderStages[i].clear();
@@ -195,7 +212,7 @@ Font *Graphics::newDefaultFont(int size, font::TrueTypeRasterizer::Hinting hinti
 	if (!fontmodule)
 		throw love::Exception("Font module has not been loaded.");
 
-	StrongRef<font::Rasterizer> r(fontmodule->newTrueTypeRasterizer(size, hinting), Acquire::NORETAIN);
+	StrongRef<font::Rasterizer> r(fontmodule->newTrueTypeRasterizer(size, hinting, font::TrueTypeRasterizer::RENDER_NORMAL), Acquire::NORETAIN);
 	return newFont(r.get(), filter);
 }
 
@@ -204,9 +221,9 @@ Video *Graphics::newVideo(love::video::VideoStream *stream, float dpiscale)
 	return new Video(this, stream, dpiscale);
 }
 
-love::graphics::SpriteBatch *Graphics::newSpriteBatch(Texture *texture, int size, vertex::Usage usage)
+love::graphics::SpriteBatch *Graphics::newSpriteBatch(Texture *texture, int size, vertex::Usage usage, bool instanced)
 {
-	return new SpriteBatch(this, texture, size, usage);
+	return new SpriteBatch(this, texture, size, usage, instanced);
 }
 
 love::graphics::ParticleSystem *Graphics::newParticleSystem(Texture *texture, int size)
@@ -933,6 +950,55 @@ void Graphics::getDefaultMipmapFilter(Texture::FilterMode *filter, float *sharpn
 	*sharpness = Texture::defaultMipmapSharpness;
 }
 
+void Graphics::setBatchMode(BatchMode mode)
+{
+	if (mode != batchMode)
+		flushStreamDraws();
+
+	batchMode = mode;
+}
+
+Graphics::BatchMode Graphics::getBatchMode() const
+{
+	return batchMode;
+}
+
+void Graphics::beginRecording()
+{
+	if (recordingState.active)
+		throw love::Exception("Draws are already being recorded.");
+
+	flushStreamDraws();
+
+	recordingState.active = true;
+}
+
+DrawList *Graphics::endRecording()
+{
+	RecordingState &state = recordingState;
+
+	if (!state.active)
+		throw love::Exception("Draws are not being recorded.");
+
+	state.active = false;
+
+	// Take the recorded data out of the state first, so it's cleared even if
+	// creating the DrawList fails.
+	std::vector<DrawList::Command> commands;
+	std::vector<uint8> data[2];
+
+	commands.swap(state.commands);
+	data[0].swap(state.data[0]);
+	data[1].swap(state.data[1]);
+
+	return new DrawList(this, commands, data);
+}
+
+bool Graphics::isRecording() const
+{
+	return recordingState.active;
+}
+
 void Graphics::setLineWidth(float width)
 {
 	states.back().lineWidth = width;
@@ -982,19 +1048,38 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 {
 	using namespace vertex;
 
+	if (recordingState.active)
+		return requestRecordedStreamDraw(cmd);
+
+	if (batchMode == BATCH_DEFERRED && !deferredStreamState.replaying)
+	{
+		// Videos set their textures on the active shader right after
+		// requesting their vertices, so they can't be deferred.
+		if (cmd.standardShaderType != Shader::STANDARD_VIDEO)
+			return requestDeferredStreamDraw(cmd);
+
+		flushStreamDraws();
+	}
+
 	StreamBufferState &state = streamBufferState;
 
 	bool shouldflush = false;
 	bool shouldresize = false;
+	int textureslot = 0;
 
 	if (cmd.primitiveMode != state.primitiveMode
 		|| cmd.formats[0] != state.formats[0] || cmd.formats[1] != state.formats[1]
 		|| ((cmd.indexMode != TriangleIndexMode::NONE) != (state.indexCount > 0))
-		|| cmd.texture != state.texture
 		|| cmd.standardShaderType != state.standardShaderType)
 	{
 		shouldflush = true;
 	}
+	else
+	{
+		textureslot = getBatchTextureSlot(cmd);
+		if (textureslot < 0)
+			shouldflush = true;
+	}
 
 	int totalvertices = state.vertexCount + cmd.vertexCount;
 
@@ -1006,7 +1091,7 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 	size_t reqIndexSize = reqIndexCount * sizeof(uint16);
 
 	size_t newdatasizes[2] = {0, 0};
-	size_t buffersizes[3] = {0, 0, 0};
+	size_t buffersizes[4] = {0, 0, 0, 0};
 
 	for (int i = 0; i < 2; i++)
 	{
@@ -1042,6 +1127,20 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 		}
 	}
 
+	if (!shouldflush && (textureslot > 0 || state.textureCount > 1))
+	{
+		size_t datasize = sizeof(float) * totalvertices;
+
+		if (state.textureIndexMap.data != nullptr && datasize > state.textureIndexMap.size)
+			shouldflush = true;
+
+		if (datasize > state.textureIndexBuffer->getUsableSize())
+		{
+			buffersizes[3] = std::max(datasize, state.textureIndexBuffer->getSize() * 2);
+			shouldresize = true;
+		}
+	}
+
 	if (shouldflush || shouldresize)
 	{
 		flushStreamDraws();
@@ -1049,8 +1148,14 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 		state.primitiveMode = cmd.primitiveMode;
 		state.formats[0] = cmd.formats[0];
 		state.formats[1] = cmd.formats[1];
-		state.texture = cmd.texture;
+		state.textures[0] = cmd.texture;
 		state.standardShaderType = cmd.standardShaderType;
+
+		textureslot = 0;
+	}
+	else if (textureslot == state.textureCount)
+	{
+		state.textures[state.textureCount++] = cmd.texture;
 	}
 
 	if (state.vertexCount == 0 && Shader::isDefaultActive())
@@ -1075,6 +1180,12 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 			delete state.indexBuffer;
 			state.indexBuffer = newStreamBuffer(BUFFER_INDEX, buffersizes[2]);
 		}
+
+		if (state.textureIndexBuffer->getSize() < buffersizes[3])
+		{
+			delete state.textureIndexBuffer;
+			state.textureIndexBuffer = newStreamBuffer(BUFFER_VERTEX, buffersizes[3]);
+		}
 	}
 
 	if (cmd.indexMode != TriangleIndexMode::NONE)
@@ -1088,6 +1199,24 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 		state.indexBufferMap.data += reqIndexSize;
 	}
 
+	if (state.textureCount > 1)
+	{
+		if (state.textureIndexMap.data == nullptr)
+		{
+			// The batch just started using more than one texture. Everything
+			// that's already in it uses the first one.
+			state.textureIndexMap = state.textureIndexBuffer->map(sizeof(float) * totalvertices);
+			memset(state.textureIndexMap.data, 0, sizeof(float) * state.vertexCount);
+			state.textureIndexMap.data += sizeof(float) * state.vertexCount;
+		}
+
+		float *textureindices = (float *) state.textureIndexMap.data;
+		for (int i = 0; i < cmd.vertexCount; i++)
+			textureindices[i] = (float) textureslot;
+
+		state.textureIndexMap.data += sizeof(float) * cmd.vertexCount;
+	}
+
 	StreamVertexData d;
 
 	for (int i = 0; i < 2; i++)
@@ -1112,10 +1241,263 @@ Graphics::StreamVertexData Graphics::requestStreamDraw(const StreamDrawCommand &
 	return d;
 }
 
+static bool isBatchTextureCompatible(Texture *texture)
+{
+	return texture != nullptr
+		&& texture->getTextureType() == TEXTURE_2D
+		&& texture->isReadable()
+		&& !texture->getDepthSampleMode().hasValue;
+}
+
+int Graphics::getBatchTextureSlot(const StreamDrawCommand &cmd) const
+{
+	const StreamBufferState &state = streamBufferState;
+
+	for (int i = 0; i < state.textureCount; i++)
+	{
+		if (state.textures[i].get() == cmd.texture)
+			return i;
+	}
+
+	// Different textures can only share a batch when the default shader is
+	// used, since it's replaced with one that picks the texture per-vertex.
+	if (state.vertexCount == 0 || state.textureCount >= MAX_BATCH_TEXTURES)
+		return -1;
+
+	if (Shader::standardShaders[Shader::STANDARD_MULTITEXTURE] == nullptr || !Shader::isDefaultActive())
+		return -1;
+
+	if (cmd.standardShaderType != Shader::STANDARD_DEFAULT)
+		return -1;
+
+	if (!isBatchTextureCompatible(cmd.texture) || !isBatchTextureCompatible(state.textures[0]))
+		return -1;
+
+	return state.textureCount;
+}
+
+Graphics::StreamVertexData Graphics::requestDeferredStreamDraw(const StreamDrawCommand &cmd)
+{
+	using namespace vertex;
+
+	DeferredStreamState &state = deferredStreamState;
+
+	DeferredStreamDraw draw;
+	draw.primitiveMode = cmd.primitiveMode;
+	draw.indexMode = cmd.indexMode;
+	draw.vertexCount = cmd.vertexCount;
+	draw.texture.set(cmd.texture);
+	draw.standardShaderType = cmd.standardShaderType;
+	draw.batch = -1;
+
+	StreamVertexData d;
+
+	for (int i = 0; i < 2; i++)
+	{
+		draw.formats[i] = cmd.formats[i];
+		draw.dataOffsets[i] = state.data[i].size();
+		d.stream[i] = nullptr;
+
+		if (cmd.formats[i] == CommonFormat::NONE)
+			continue;
+
+		// The returned pointer only has to stay valid until the next request,
+		// so growing the vector here is fine.
+		state.data[i].resize(draw.dataOffsets[i] + getFormatStride(cmd.formats[i]) * cmd.vertexCount);
+		d.stream[i] = &state.data[i][draw.dataOffsets[i]];
+	}
+
+	state.draws.push_back(draw);
+
+	return d;
+}
+
+Graphics::StreamVertexData Graphics::requestRecordedStreamDraw(const StreamDrawCommand &cmd)
+{
+	using namespace vertex;
+
+	// Videos update their shader's textures after requesting vertices.
+	if (cmd.standardShaderType == Shader::STANDARD_VIDEO)
+		throw love::Exception("Videos cannot be recorded into a DrawList.");
+
+	RecordingState &state = recordingState;
+
+	DrawList::Command command;
+	command.primitiveMode = cmd.primitiveMode;
+	command.indexMode = cmd.indexMode;
+	command.vertexCount = cmd.vertexCount;
+	command.texture.set(cmd.texture);
+	command.standardShaderType = cmd.standardShaderType;
+
+	StreamVertexData d;
+
+	for (int i = 0; i < 2; i++)
+	{
+		command.formats[i] = cmd.formats[i];
+		command.dataOffsets[i] = state.data[i].size();
+		d.stream[i] = nullptr;
+
+		if (cmd.formats[i] == CommonFormat::NONE)
+			continue;
+
+		state.data[i].resize(command.dataOffsets[i] + getFormatStride(cmd.formats[i]) * cmd.vertexCount);
+		d.stream[i] = &state.data[i][command.dataOffsets[i]];
+	}
+
+	state.commands.push_back(command);
+
+	return d;
+}
+
+void Graphics::getDeferredDrawBounds(const DeferredStreamDraw &draw, float &minx, float &miny, float &maxx, float &maxy) const
+{
+	using namespace vertex;
+
+	minx = miny = std::numeric_limits<float>::max();
+	maxx = maxy = std::numeric_limits<float>::lowest();
+
+	// Vertices with a z component may be perspective-projected later, so we
+	// can't reason about their screen-space bounds. Treat them as covering
+	// everything.
+	if (draw.formats[0] == CommonFormat::NONE || getFormatPositionComponents(draw.formats[0]) != 2)
+	{
+		minx = miny = std::numeric_limits<float>::lowest();
+		maxx = maxy = std::numeric_limits<float>::max();
+		return;
+	}
+
+	size_t stride = getFormatStride(draw.formats[0]);
+	const uint8 *data = &deferredStreamState.data[0][draw.dataOffsets[0]];
+
+	for (int i = 0; i < draw.vertexCount; i++)
+	{
+		const float *pos = (const float *) (data + stride * i);
+		minx = std::min(minx, pos[0]);
+		miny = std::min(miny, pos[1]);
+		maxx = std::max(maxx, pos[0]);
+		maxy = std::max(maxy, pos[1]);
+	}
+}
+
+void Graphics::flushDeferredStreamDraws()
+{
+	DeferredStreamState &state = deferredStreamState;
+
+	if (state.draws.empty() || state.replaying)
+		return;
+
+	state.batches.clear();
+
+	// Assign each draw to the most recent compatible batch, as long as it
+	// doesn't overlap anything in the batches it would be moved in front of.
+	// Otherwise it starts a new batch.
+	for (int i = 0; i < (int) state.draws.size(); i++)
+	{
+		DeferredStreamDraw &draw = state.draws[i];
+
+		DeferredBatch bounds;
+		getDeferredDrawBounds(draw, bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+
+		int target = -1;
+		int lookbackend = std::max(0, (int) state.batches.size() - MAX_DEFERRED_BATCH_LOOKBACK);
+
+		for (int b = (int) state.batches.size() - 1; b >= lookbackend; b--)
+		{
+			const DeferredBatch &batch = state.batches[b];
+
+			if (state.draws[batch.firstDraw].isBatchCompatible(draw))
+			{
+				target = b;
+				break;
+			}
+
+			bool overlaps = bounds.minX <= batch.maxX && bounds.maxX >= batch.minX
+				&& bounds.minY <= batch.maxY && bounds.maxY >= batch.minY;
+
+			if (overlaps)
+				break;
+		}
+
+		if (target == -1)
+		{
+			bounds.firstDraw = i;
+			state.batches.push_back(bounds);
+			target = (int) state.batches.size() - 1;
+		}
+		else
+		{
+			DeferredBatch &batch = state.batches[target];
+			batch.minX = std::min(batch.minX, bounds.minX);
+			batch.minY = std::min(batch.minY, bounds.minY);
+			batch.maxX = std::max(batch.maxX, bounds.maxX);
+			batch.maxY = std::max(batch.maxY, bounds.maxY);
+
+			// The draw only saves a batch if it wasn't going to be merged
+			// with its predecessor anyway.
+			if (target != state.draws[i - 1].batch)
+				batchesMerged++;
+		}
+
+		draw.batch = target;
+	}
+
+	// Stable counting sort of the draws by batch.
+	std::vector<int> &order = state.drawOrder;
+	order.assign(state.batches.size() + 1, 0);
+
+	for (const DeferredStreamDraw &draw : state.draws)
+		order[draw.batch + 1]++;
+
+	for (size_t b = 1; b < order.size(); b++)
+		order[b] += order[b - 1];
+
+	std::vector<int> offsets(order.begin(), order.end() - 1);
+	order.resize(state.draws.size());
+
+	for (int i = 0; i < (int) state.draws.size(); i++)
+		order[offsets[state.draws[i].batch]++] = i;
+
+	// Submit the draws through the regular batching path in their new order.
+	state.replaying = true;
+
+	for (int i : order)
+	{
+		const DeferredStreamDraw &draw = state.draws[i];
+
+		StreamDrawCommand cmd;
+		cmd.primitiveMode = draw.primitiveMode;
+		cmd.formats[0] = draw.formats[0];
+		cmd.formats[1] = draw.formats[1];
+		cmd.indexMode = draw.indexMode;
+		cmd.vertexCount = draw.vertexCount;
+		cmd.texture = draw.texture.get();
+		cmd.standardShaderType = draw.standardShaderType;
+
+		StreamVertexData data = requestStreamDraw(cmd);
+
+		for (int s = 0; s < 2; s++)
+		{
+			if (draw.formats[s] == vertex::CommonFormat::NONE)
+				continue;
+
+			size_t size = vertex::getFormatStride(draw.formats[s]) * draw.vertexCount;
+			memcpy(data.stream[s], &state.data[s][draw.dataOffsets[s]], size);
+		}
+	}
+
+	state.replaying = false;
+
+	state.draws.clear();
+	state.data[0].clear();
+	state.data[1].clear();
+}
+
 void Graphics::flushStreamDraws()
 {
 	using namespace vertex;
 
+	flushDeferredStreamDraws();
+
 	auto &sbstate = streamBufferState;
 
 	if (sbstate.vertexCount == 0 && sbstate.indexCount == 0)
@@ -1124,7 +1506,7 @@ void Graphics::flushStreamDraws()
 	Attributes attributes;
 	BufferBindings buffers;
 
-	size_t usedsizes[3] = {0, 0, 0};
+	size_t usedsizes[4] = {0, 0, 0, 0};
 
 	for (int i = 0; i < 2; i++)
 	{
@@ -1143,6 +1525,38 @@ void Graphics::flushStreamDraws()
 	if (attributes.enableBits == 0)
 		return;
 
+	if (sbstate.textureCount > 1)
+	{
+		attributes.set(ATTRIB_TEXTUREINDEX, DATA_FLOAT, 1, 0, 2);
+		attributes.setBufferLayout(2, sizeof(float));
+
+		usedsizes[3] = sizeof(float) * sbstate.vertexCount;
+
+		size_t offset = sbstate.textureIndexBuffer->unmap(usedsizes[3]);
+		buffers.set(2, sbstate.textureIndexBuffer, offset);
+		sbstate.textureIndexMap = StreamBuffer::MapInfo();
+
+		// Attaching a shader flushes pending stream draws, so the batch is
+		// marked as empty while it's swapped in.
+		if (Shader::current != Shader::standardShaders[Shader::STANDARD_MULTITEXTURE])
+		{
+			int vertexcount = sbstate.vertexCount;
+			int indexcount = sbstate.indexCount;
+			sbstate.vertexCount = sbstate.indexCount = 0;
+
+			Shader::attachDefault(Shader::STANDARD_MULTITEXTURE);
+
+			sbstate.vertexCount = vertexcount;
+			sbstate.indexCount = indexcount;
+		}
+
+		Texture *textures[MAX_BATCH_TEXTURES - 1] = {};
+		for (int i = 1; i < sbstate.textureCount; i++)
+			textures[i - 1] = sbstate.textures[i];
+
+		Shader::current->setBatchTextures(textures, MAX_BATCH_TEXTURES - 1);
+	}
+
 	Colorf nc = getColor();
 	if (attributes.isEnabled(ATTRIB_COLOR))
 		setColor(Colorf(1.0f, 1.0f, 1.0f, 1.0f));
@@ -1158,7 +1572,7 @@ void Graphics::flushStreamDraws()
 		cmd.indexCount = sbstate.indexCount;
 		cmd.indexType = INDEX_UINT16;
 		cmd.indexBufferOffset = sbstate.indexBuffer->unmap(usedsizes[2]);
-		cmd.texture = sbstate.texture;
+		cmd.texture = sbstate.textures[0];
 		draw(cmd);
 
 		sbstate.indexBufferMap = StreamBuffer::MapInfo();
@@ -1169,7 +1583,7 @@ void Graphics::flushStreamDraws()
 		cmd.primitiveType = sbstate.primitiveMode;
 		cmd.vertexStart = 0;
 		cmd.vertexCount = sbstate.vertexCount;
-		cmd.texture = sbstate.texture;
+		cmd.texture = sbstate.textures[0];
 		draw(cmd);
 	}
 
@@ -1182,13 +1596,23 @@ void Graphics::flushStreamDraws()
 	if (usedsizes[2] > 0)
 		sbstate.indexBuffer->markUsed(usedsizes[2]);
 
+	if (usedsizes[3] > 0)
+		sbstate.textureIndexBuffer->markUsed(usedsizes[3]);
+
+	for (size_t size : usedsizes)
+		streamBytes += size;
+
 	popTransform();
 
 	if (attributes.isEnabled(ATTRIB_COLOR))
 		setColor(nc);
 
+	for (int i = 1; i < sbstate.textureCount; i++)
+		sbstate.textures[i].set(nullptr);
+
 	streamBufferState.vertexCount = 0;
 	streamBufferState.indexCount = 0;
+	streamBufferState.textureCount = 1;
 }
 
 void Graphics::flushStreamDrawsGlobal()
@@ -1590,11 +2014,35 @@ Graphics::Stats Graphics::getStats() const
 	getAPIStats(stats.shaderSwitches);
 
 	stats.drawCalls = drawCalls;
-	if (streamBufferState.vertexCount > 0)
+	if (streamBufferState.vertexCount > 0 || !deferredStreamState.draws.empty())
 		stats.drawCalls++;
 
 	stats.canvasSwitches = canvasSwitchCount;
 	stats.drawCallsBatched = drawCallsBatched;
+	stats.batchesMerged = batchesMerged;
+	stats.streamBytes = streamBytes;
+	stats.streamBufferWraps = 0;
+	stats.streamStallTime = 0.0;
+
+	getGPUTimings(stats.gpuTimings);
+
+	const StreamBuffer *streambuffers[] =
+	{
+		streamBufferState.vb[0],
+		streamBufferState.vb[1],
+		streamBufferState.indexBuffer,
+		streamBufferState.textureIndexBuffer,
+	};
+
+	for (const StreamBuffer *buffer : streambuffers)
+	{
+		if (buffer != nullptr)
+		{
+			stats.streamBufferWraps += buffer->getWrapCount();
+			stats.streamStallTime += buffer->getStallTime();
+		}
+	}
+
 	stats.canvases = Canvas::canvasCount;
 	stats.images = Image::imageCount;
 	stats.fonts = Font::fontCount;
@@ -1873,6 +2321,21 @@ std::vector<std::string> Graphics::getConstants(StackType)
 	return stackTypes.getNames();
 }
 
+bool Graphics::getConstant(const char *in, BatchMode &out)
+{
+	return batchModes.find(in, out);
+}
+
+bool Graphics::getConstant(BatchMode in, const char *&out)
+{
+	return batchModes.find(in, out);
+}
+
+std::vector<std::string> Graphics::getConstants(BatchMode)
+{
+	return batchModes.getNames();
+}
+
 StringMap<Graphics::DrawMode, Graphics::DRAW_MAX_ENUM>::Entry Graphics::drawModeEntries[] =
 {
 	{ "line", DRAW_LINE },
@@ -1940,6 +2403,7 @@ StringMap<Graphics::Feature, Graphics::FEATURE_MAX_ENUM>::Entry Graphics::featur
 	{ "shaderderivatives",  FEATURE_SHADER_DERIVATIVES   },
 	{ "glsl3",              FEATURE_GLSL3                },
 	{ "instancing",         FEATURE_INSTANCING           },
+	{ "timerquery",         FEATURE_TIMER_QUERY          },
 };
 
 StringMap<Graphics::Feature, Graphics::FEATURE_MAX_ENUM> Graphics::features(Graphics::featureEntries, sizeof(Graphics::featureEntries));
@@ -1966,5 +2430,13 @@ StringMap<Graphics::StackType, Graphics::STACK_MAX_ENUM>::Entry Graphics::stackT
 
 StringMap<Graphics::StackType, Graphics::STACK_MAX_ENUM> Graphics::stackTypes(Graphics::stackTypeEntries, sizeof(Graphics::stackTypeEntries));
 
+StringMap<Graphics::BatchMode, Graphics::BATCH_MAX_ENUM>::Entry Graphics::batchModeEntries[] =
+{
+	{ "immediate", BATCH_IMMEDIATE },
+	{ "deferred",  BATCH_DEFERRED  },
+};
+
+StringMap<Graphics::BatchMode, Graphics::BATCH_MAX_ENUM> Graphics::batchModes(Graphics::batchModeEntries, sizeof(Graphics::batchModeEntries));
+
 } // graphics
 } // love
@@ -38,6 +38,7 @@
 #include "Shader.h"
 #include "Quad.h"
 #include "Mesh.h"
+#include "DrawList.h"
 #include "Image.h"
 #include "Deprecations.h"
 #include "depthstencil.h"
@@ -67,6 +68,11 @@ typedef Optional<Colorf> OptionalColorf;
 
 const int MAX_COLOR_RENDER_TARGETS = 8;
 
+// The maximum number of different textures a single automatic batch can use.
+// Must match the value used by the multi-texture shader in
+// wrap_GraphicsShader.lua.
+const int MAX_BATCH_TEXTURES = 8;
+
 /**
  * Globally sets whether gamma correction is enabled. Ideally this should be set
  * prior to using any Graphics module function.
@@ -78,6 +84,18 @@ void setGammaCorrect(bool gammacorrect);
  **/
 bool isGammaCorrect();
 
+/**
+ * Globally sets the amount of vertex data in bytes which can be streamed each
+ * frame before the stream buffers have to wait for the GPU or grow. Must be set
+ * before the window is first created to have an effect.
+ **/
+void setStreamBufferSize(size_t size);
+
+/**
+ * Gets the per-frame stream buffer size.
+ **/
+size_t getStreamBufferSize();
+
 /**
  * Gamma-corrects a color (converts it from sRGB to linear RGB, if
  * gamma correction is enabled.)
@@ -164,6 +182,7 @@ class Graphics : public Module
 		FEATURE_SHADER_DERIVATIVES,
 		FEATURE_GLSL3,
 		FEATURE_INSTANCING,
+		FEATURE_TIMER_QUERY,
 		FEATURE_MAX_ENUM
 	};
 
@@ -194,6 +213,13 @@ class Graphics : public Module
 		STACK_MAX_ENUM
 	};
 
+	enum BatchMode
+	{
+		BATCH_IMMEDIATE,
+		BATCH_DEFERRED,
+		BATCH_MAX_ENUM
+	};
+
 	enum TemporaryRenderTargetFlags
 	{
 		TEMPORARY_RT_DEPTH   = (1 << 0),
@@ -215,10 +241,22 @@ class Graphics : public Module
 		std::string device;
 	};
 
+	struct GPUTiming
+	{
+		std::string name;
+		double time; // In seconds.
+		int depth; // 0 for canvas passes, 1 and up for nested timer regions.
+	};
+
 	struct Stats
 	{
 		int drawCalls;
 		int drawCallsBatched;
+		int batchesMerged;
+		int64 streamBytes;
+		int streamBufferWraps;
+		double streamStallTime;
+		std::vector<GPUTiming> gpuTimings;
 		int canvasSwitches;
 		int shaderSwitches;
 		int canvases;
@@ -479,7 +517,7 @@ class Graphics : public Module
 	Font *newDefaultFont(int size, font::TrueTypeRasterizer::Hinting hinting, const Texture::Filter &filter = Texture::defaultFilter);
 	Video *newVideo(love::video::VideoStream *stream, float dpiscale);
 
-	SpriteBatch *newSpriteBatch(Texture *texture, int size, vertex::Usage usage);
+	SpriteBatch *newSpriteBatch(Texture *texture, int size, vertex::Usage usage, bool instanced = false);
 	ParticleSystem *newParticleSystem(Texture *texture, int size);
 
 	virtual Canvas *newCanvas(const Canvas::Settings &settings) = 0;
@@ -675,6 +713,27 @@ class Graphics : public Module
 	void setDefaultMipmapFilter(Texture::FilterMode filter, float sharpness);
 	void getDefaultMipmapFilter(Texture::FilterMode *filter, float *sharpness) const;
 
+	/**
+	 * Sets whether automatically batched draws are submitted immediately, or
+	 * recorded and reordered by texture, shader and vertex format before being
+	 * flushed. Draws are only reordered when they don't overlap each other.
+	 **/
+	void setBatchMode(BatchMode mode);
+	BatchMode getBatchMode() const;
+
+	/**
+	 * Starts capturing automatically batched draws into a DrawList instead of
+	 * drawing them. Draws which don't go through the stream batcher (Meshes,
+	 * SpriteBatches, etc.) are still drawn immediately while recording.
+	 **/
+	void beginRecording();
+
+	/**
+	 * Stops recording and returns the recorded draws as a new DrawList.
+	 **/
+	DrawList *endRecording();
+	bool isRecording() const;
+
 	/**
 	 * Sets the line width.
 	 * @param width The new width of the line.
@@ -849,6 +908,22 @@ class Graphics : public Module
 	 **/
 	Stats getStats() const;
 
+	/**
+	 * Enables or disables measuring how long each canvas pass and timer region
+	 * takes on the GPU. The results are reported in getStats a few frames
+	 * later. Requires FEATURE_TIMER_QUERY.
+	 **/
+	virtual void setGPUTimingEnabled(bool enable) = 0;
+	virtual bool isGPUTimingEnabled() const = 0;
+
+	/**
+	 * Starts or ends a named region of GPU work to measure, when GPU timing is
+	 * enabled. Regions can be nested, and are ended when the frame is
+	 * presented.
+	 **/
+	virtual void pushTimerRegion(const std::string &name) = 0;
+	virtual void popTimerRegion() = 0;
+
 	size_t getStackDepth() const;
 	void push(StackType type = STACK_TRANSFORM);
 	void pop();
@@ -927,6 +1002,10 @@ class Graphics : public Module
 	static bool getConstant(StackType in, const char *&out);
 	static std::vector<std::string> getConstants(StackType);
 
+	static bool getConstant(const char *in, BatchMode &out);
+	static bool getConstant(BatchMode in, const char *&out);
+	static std::vector<std::string> getConstants(BatchMode);
+
 	// Default shader code (a shader is always required internally.)
 	static DefaultShaderCode defaultShaderCode[Shader::STANDARD_MAX_ENUM][Shader::LANGUAGE_MAX_ENUM][2];
 
@@ -977,16 +1056,19 @@ class Graphics : public Module
 	{
 		StreamBuffer *vb[2];
 		StreamBuffer *indexBuffer = nullptr;
+		StreamBuffer *textureIndexBuffer = nullptr;
 
 		PrimitiveType primitiveMode = PRIMITIVE_TRIANGLES;
 		vertex::CommonFormat formats[2];
-		StrongRef<Texture> texture;
+		StrongRef<Texture> textures[MAX_BATCH_TEXTURES];
+		int textureCount = 1;
 		Shader::StandardShader standardShaderType = Shader::STANDARD_DEFAULT;
 		int vertexCount = 0;
 		int indexCount = 0;
 
 		StreamBuffer::MapInfo vbMap[2];
 		StreamBuffer::MapInfo indexBufferMap = StreamBuffer::MapInfo();
+		StreamBuffer::MapInfo textureIndexMap = StreamBuffer::MapInfo();
 
 		StreamBufferState()
 		{
@@ -996,6 +1078,49 @@ class Graphics : public Module
 		}
 	};
 
+	struct DeferredStreamDraw
+	{
+		PrimitiveType primitiveMode;
+		vertex::CommonFormat formats[2];
+		vertex::TriangleIndexMode indexMode;
+		int vertexCount;
+		StrongRef<Texture> texture;
+		Shader::StandardShader standardShaderType;
+		size_t dataOffsets[2];
+		int batch;
+
+		bool isBatchCompatible(const DeferredStreamDraw &other) const
+		{
+			return primitiveMode == other.primitiveMode
+				&& formats[0] == other.formats[0] && formats[1] == other.formats[1]
+				&& (indexMode != vertex::TriangleIndexMode::NONE) == (other.indexMode != vertex::TriangleIndexMode::NONE)
+				&& texture.get() == other.texture.get()
+				&& standardShaderType == other.standardShaderType;
+		}
+	};
+
+	struct DeferredBatch
+	{
+		int firstDraw;
+		float minX, minY, maxX, maxY;
+	};
+
+	struct DeferredStreamState
+	{
+		std::vector<DeferredStreamDraw> draws;
+		std::vector<DeferredBatch> batches;
+		std::vector<int> drawOrder;
+		std::vector<uint8> data[2];
+		bool replaying = false;
+	};
+
+	struct RecordingState
+	{
+		std::vector<DrawList::Command> commands;
+		std::vector<uint8> data[2];
+		bool active = false;
+	};
+
 	struct TemporaryCanvas
 	{
 		Canvas *canvas;
@@ -1015,6 +1140,7 @@ class Graphics : public Module
 
 	virtual void initCapabilities() = 0;
 	virtual void getAPIStats(int &shaderswitches) const = 0;
+	virtual void getGPUTimings(std::vector<GPUTiming> &timings) const = 0;
 
 	void createQuadIndexBuffer();
 
@@ -1043,6 +1169,11 @@ class Graphics : public Module
 
 	StreamBufferState streamBufferState;
 
+	BatchMode batchMode;
+	DeferredStreamState deferredStreamState;
+
+	RecordingState recordingState;
+
 	std::vector<Matrix4> transformStack;
 	Matrix4 projectionMatrix;
 
@@ -1056,6 +1187,8 @@ class Graphics : public Module
 	int canvasSwitchCount;
 	int drawCalls;
 	int drawCallsBatched;
+	int batchesMerged;
+	int64 streamBytes;
 
 	Buffer *quadIndexBuffer;
 
@@ -1066,11 +1199,22 @@ class Graphics : public Module
 	static const size_t MAX_USER_STACK_DEPTH = 128;
 	static const int MAX_TEMPORARY_CANVAS_UNUSED_FRAMES = 16;
 
+	// How many earlier batches a deferred draw can be moved past.
+	static const int MAX_DEFERRED_BATCH_LOOKBACK = 64;
+
 private:
 
 	void checkSetDefaultFont();
 	int calculateEllipsePoints(float rx, float ry) const;
 
+	int getBatchTextureSlot(const StreamDrawCommand &command) const;
+
+	StreamVertexData requestDeferredStreamDraw(const StreamDrawCommand &command);
+	void flushDeferredStreamDraws();
+	void getDeferredDrawBounds(const DeferredStreamDraw &draw, float &minx, float &miny, float &maxx, float &maxy) const;
+
+	StreamVertexData requestRecordedStreamDraw(const StreamDrawCommand &command);
+
 	std::vector<uint8> scratchBuffer;
 
 	std::unordered_map<std::string, ShaderStage *> cachedShaderStages[ShaderStage::STAGE_MAX_ENUM];
@@ -1102,6 +1246,9 @@ class Graphics : public Module
 	static StringMap<StackType, STACK_MAX_ENUM>::Entry stackTypeEntries[];
 	static StringMap<StackType, STACK_MAX_ENUM> stackTypes;
 
+	static StringMap<BatchMode, BATCH_MAX_ENUM>::Entry batchModeEntries[];
+	static StringMap<BatchMode, BATCH_MAX_ENUM> batchModes;
+
 }; // Graphics
 
 } // graphics
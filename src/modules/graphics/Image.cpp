@@ -130,9 +130,6 @@ void Image::replacePixels(love::image::ImageDataBase *d, int slice, int mipmap,
 	if (getHandle() == 0 || usingDefaultTexture)
 		return;
 
-	if (d->getFormat() != getPixelFormat())
-		throw love::Exception("Pixel formats must match.");
-
 	if (mipmap < 0 || (mipmapsType != MIPMAPS_DATA && mipmap > 0) || mipmap >= getMipmapCount())
 		throw love::Exception("Invalid image mipmap index %d.", mipmap + 1);
 
@@ -154,6 +151,23 @@ void Image::replacePixels(love::image::ImageDataBase *d, int slice, int mipmap,
 		throw love::Exception("Invalid rectangle dimensions (x=%d, y=%d, w=%d, h=%d) for %dx%d Image.", rect.x, rect.y, rect.w, rect.h, mipw, miph);
 	}
 
+	StrongRef<love::image::ImageData> converted;
+
+	// ImageData in a different format is converted when it can be pasted
+	// into the Image's format.
+	if (d->getFormat() != getPixelFormat())
+	{
+		auto id = dynamic_cast<love::image::ImageData *>(d);
+		auto imagemodule = Module::getInstance<love::image::Image>(Module::M_IMAGE);
+
+		if (id == nullptr || imagemodule == nullptr || !love::image::ImageData::canPaste(id->getFormat(), getPixelFormat()))
+			throw love::Exception("Pixel formats must match.");
+
+		converted.set(imagemodule->newImageData(id->getWidth(), id->getHeight(), getPixelFormat()), Acquire::NORETAIN);
+		converted->paste(id, 0, 0, 0, 0, id->getWidth(), id->getHeight());
+		d = converted.get();
+	}
+
 	love::image::ImageDataBase *oldd = data.get(slice, mipmap);
 
 	if (oldd == nullptr)
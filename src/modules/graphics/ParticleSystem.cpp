@@ -25,11 +25,32 @@
 
 #include "common/math.h"
 #include "modules/math/RandomGenerator.h"
+#include "modules/thread/WorkerPool.h"
 
 // STD
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
+
+#if defined(LOVE_SIMD_SSE)
+#include <xmmintrin.h>
+#endif
+
+// The SIMD and scalar particle integration must round identically, so a*b+c
+// may not be fused into one instruction. GCC ignores this pragma, so the build
+// passes -ffp-contract=off for this file instead.
+#if defined(__clang__)
+#	pragma STDC FP_CONTRACT OFF
+#elif defined(_MSC_VER)
+#	pragma fp_contract (off)
+#endif
+
+// NEON only has division and square root instructions on AArch64.
+#if defined(LOVE_SIMD_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LOVE_PARTICLE_SIMD_NEON
+#endif
 
 namespace love
 {
@@ -39,9 +60,11 @@ namespace graphics
 namespace
 {
 
-love::math::RandomGenerator rng;
+// Only used to seed the random generator of each ParticleSystem, so the
+// particles of a system don't depend on which thread updates it.
+love::math::RandomGenerator seedRNG;
 
-float calculate_variation(float inner, float outer, float var)
+float calculate_variation(love::math::RandomGenerator &rng, float inner, float outer, float var)
 {
 	float low = inner - (outer/2.0f)*var;
 	float high = inner + (outer/2.0f)*var;
@@ -49,15 +72,30 @@ float calculate_variation(float inner, float outer, float var)
 	return low*(1-r)+high*r;
 }
 
+void sendShaderFloats(Shader *shader, const char *name, const float *values, int count)
+{
+	const Shader::UniformInfo *info = shader->getUniformInfo(name);
+	if (info == nullptr || info->baseType != Shader::UNIFORM_FLOAT)
+		return;
+
+	count = std::min(count, info->count);
+	memcpy(info->floats, values, sizeof(float) * info->components * count);
+	shader->updateUniform(info, count);
+}
+
+void sendShaderTexture(Shader *shader, const char *name, Texture *texture)
+{
+	const Shader::UniformInfo *info = shader->getUniformInfo(name);
+	if (info != nullptr)
+		shader->sendTextures(info, &texture, 1);
+}
+
 } // anonymous namespace
 
 love::Type ParticleSystem::type("ParticleSystem", &Drawable::type);
 
 ParticleSystem::ParticleSystem(Texture *texture, uint32 size)
 	: pMem(nullptr)
-	, pFree(nullptr)
-	, pHead(nullptr)
-	, pTail(nullptr)
 	, texture(texture)
 	, active(true)
 	, insertMode(INSERT_MODE_TOP)
@@ -95,7 +133,14 @@ ParticleSystem::ParticleSystem(Texture *texture, uint32 size)
 	, relativeRotation(false)
 	, vertexAttributes(vertex::CommonFormat::XYf_STf_RGBAub, 0)
 	, buffer(nullptr)
+	, verticesPrepared(false)
+	, simulationMode(SIMULATION_CPU)
+	, gpu(nullptr)
 {
+	love::math::RandomGenerator::Seed seed;
+	seed.b64 = seedRNG.rand();
+	rng.setSeed(seed);
+
 	if (size == 0 || size > MAX_PARTICLES)
 		throw love::Exception("Invalid ParticleSystem size.");
 
@@ -110,9 +155,6 @@ ParticleSystem::ParticleSystem(Texture *texture, uint32 size)
 
 ParticleSystem::ParticleSystem(const ParticleSystem &p)
 	: pMem(nullptr)
-	, pFree(nullptr)
-	, pHead(nullptr)
-	, pTail(nullptr)
 	, texture(p.texture)
 	, active(p.active)
 	, insertMode(p.insertMode)
@@ -156,7 +198,14 @@ ParticleSystem::ParticleSystem(const ParticleSystem &p)
 	, relativeRotation(p.relativeRotation)
 	, vertexAttributes(p.vertexAttributes)
 	, buffer(nullptr)
+	, verticesPrepared(false)
+	, simulationMode(p.simulationMode)
+	, gpu(nullptr)
 {
+	love::math::RandomGenerator::Seed seed;
+	seed.b64 = seedRNG.rand();
+	rng.setSeed(seed);
+
 	setBufferSize(maxParticles);
 }
 
@@ -185,7 +234,11 @@ void ParticleSystem::createBuffers(size_t size)
 {
 	try
 	{
-		pFree = pMem = new Particle[size];
+		if (simulationMode == SIMULATION_GPU)
+			createGPUSimulation(size);
+		else
+			pMem = new float[size * PARTICLE_ATTRIBUTE_MAX_ENUM];
+
 		maxParticles = (uint32) size;
 
 		auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
@@ -198,12 +251,18 @@ void ParticleSystem::createBuffers(size_t size)
 		deleteBuffers();
 		throw love::Exception("Out of memory");
 	}
+	catch (love::Exception &)
+	{
+		deleteBuffers();
+		throw;
+	}
 }
 
 void ParticleSystem::deleteBuffers()
 {
 	delete[] pMem;
 	delete buffer;
+	deleteGPUSimulation();
 
 	pMem = nullptr;
 	buffer = nullptr;
@@ -230,28 +289,38 @@ void ParticleSystem::addParticle(float t)
 	if (isFull())
 		return;
 
-	// Gets a free particle and updates the allocation pointer.
-	Particle *p = pFree++;
-	initParticle(p, t);
+	if (gpu != nullptr)
+	{
+		initParticle(allocateGPUSlot(), t);
+		activeParticles++;
+		return;
+	}
 
-	switch (insertMode)
+	uint32 index = activeParticles;
+	verticesPrepared = false;
+
+	// New particles are always appended when inserting at the top or bottom,
+	// since particles are stored in reverse draw order for the latter.
+	if (insertMode == INSERT_MODE_RANDOM)
 	{
-	default:
-	case INSERT_MODE_TOP:
-		insertTop(p);
-		break;
-	case INSERT_MODE_BOTTOM:
-		insertBottom(p);
-		break;
-	case INSERT_MODE_RANDOM:
-		insertRandom(p);
-		break;
+		// Nonuniform, but 64-bit is so large nobody will notice. Hopefully.
+		uint64 pos = rng.rand() % ((int64) activeParticles + 1);
+
+		// Moves the randomly selected particle to the end, to make room for
+		// the new one.
+		if (pos < activeParticles)
+		{
+			moveParticle(activeParticles, (uint32) pos);
+			index = (uint32) pos;
+		}
 	}
 
+	initParticle(index, t);
+
 	activeParticles++;
 }
 
-void ParticleSystem::initParticle(Particle *p, float t)
+void ParticleSystem::initParticle(uint32 index, float t)
 {
 	float min,max;
 
@@ -260,13 +329,13 @@ void ParticleSystem::initParticle(Particle *p, float t)
 
 	min = particleLifeMin;
 	max = particleLifeMax;
+	float plife;
 	if (min == max)
-		p->life = min;
+		plife = min;
 	else
-		p->life = (float) rng.random(min, max);
-	p->lifetime = p->life;
+		plife = (float) rng.random(min, max);
 
-	p->position = pos;
+	love::Vector2 ppos = pos;
 
 	min = direction - spread/2.0f;
 	max = direction + spread/2.0f;
@@ -282,15 +351,15 @@ void ParticleSystem::initParticle(Particle *p, float t)
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
 		rand_x = (float) rng.random(-emissionArea.x, emissionArea.x);
 		rand_y = (float) rng.random(-emissionArea.y, emissionArea.y);
-		p->position.x += c * rand_x - s * rand_y;
-		p->position.y += s * rand_x + c * rand_y;
+		ppos.x += c * rand_x - s * rand_y;
+		ppos.y += s * rand_x + c * rand_y;
 		break;
 	case DISTRIBUTION_NORMAL:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
 		rand_x = (float) rng.randomNormal(emissionArea.x);
 		rand_y = (float) rng.randomNormal(emissionArea.y);
-		p->position.x += c * rand_x - s * rand_y;
-		p->position.y += s * rand_x + c * rand_y;
+		ppos.x += c * rand_x - s * rand_y;
+		ppos.y += s * rand_x + c * rand_y;
 		break;
 	case DISTRIBUTION_ELLIPSE:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
@@ -298,16 +367,16 @@ void ParticleSystem::initParticle(Particle *p, float t)
 		rand_y = (float) rng.random(-1, 1);
 		min = emissionArea.x * (rand_x * sqrt(1 - 0.5f*pow(rand_y, 2)));
 		max = emissionArea.y * (rand_y * sqrt(1 - 0.5f*pow(rand_x, 2)));
-		p->position.x += c * min - s * max;
-		p->position.y += s * min + c * max;
+		ppos.x += c * min - s * max;
+		ppos.y += s * min + c * max;
 		break;
 	case DISTRIBUTION_BORDER_ELLIPSE:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
 		rand_x = (float) rng.random(0, LOVE_M_PI * 2);
 		min = cosf(rand_x) * emissionArea.x;
 		max = sinf(rand_x) * emissionArea.y;
-		p->position.x += c * min - s * max;
-		p->position.y += s * min + c * max;
+		ppos.x += c * min - s * max;
+		ppos.y += s * min + c * max;
 		break;
 	case DISTRIBUTION_BORDER_RECTANGLE:
 		c = cosf(emissionAreaAngle); s = sinf(emissionAreaAngle);
@@ -316,26 +385,26 @@ void ParticleSystem::initParticle(Particle *p, float t)
 		if (rand_x < -rand_y)
 		{
 			min = rand_x + rand_y + emissionArea.x;
-			p->position.x += c * min - s * -emissionArea.y;
-			p->position.y += s * min + c * -emissionArea.y;
+			ppos.x += c * min - s * -emissionArea.y;
+			ppos.y += s * min + c * -emissionArea.y;
 		}
 		else if (rand_x < 0)
 		{
 			max = rand_x + emissionArea.y;
-			p->position.x += c * -emissionArea.x - s * max;
-			p->position.y += s * -emissionArea.x + c * max;
+			ppos.x += c * -emissionArea.x - s * max;
+			ppos.y += s * -emissionArea.x + c * max;
 		}
 		else if (rand_x < rand_y)
 		{
 			max = rand_x - emissionArea.y;
-			p->position.x += c * emissionArea.x - s * max;
-			p->position.y += s * emissionArea.x + c * max;
+			ppos.x += c * emissionArea.x - s * max;
+			ppos.y += s * emissionArea.x + c * max;
 		}
 		else
 		{
 			min = rand_x - rand_y - emissionArea.x;
-			p->position.x += c * min - s * emissionArea.y;
-			p->position.y += s * min + c * emissionArea.y;
+			ppos.x += c * min - s * emissionArea.y;
+			ppos.y += s * min + c * emissionArea.y;
 		}
 		break;
 	case DISTRIBUTION_NONE:
@@ -345,154 +414,129 @@ void ParticleSystem::initParticle(Particle *p, float t)
 
 	// Determine if the origin of each particle is the center of the area
 	if (directionRelativeToEmissionCenter)
-		dir += atan2(p->position.y - pos.y, p->position.x - pos.x);
-
-	p->origin = pos;
+		dir += atan2(ppos.y - pos.y, ppos.x - pos.x);
 
 	min = speedMin;
 	max = speedMax;
 	float speed = (float) rng.random(min, max);
 
-	p->velocity = love::Vector2(cosf(dir), sinf(dir)) * speed;
+	love::Vector2 velocity = love::Vector2(cosf(dir), sinf(dir)) * speed;
 
-	p->linearAcceleration.x = (float) rng.random(linearAccelerationMin.x, linearAccelerationMax.x);
-	p->linearAcceleration.y = (float) rng.random(linearAccelerationMin.y, linearAccelerationMax.y);
+	float linearAccelerationX = (float) rng.random(linearAccelerationMin.x, linearAccelerationMax.x);
+	float linearAccelerationY = (float) rng.random(linearAccelerationMin.y, linearAccelerationMax.y);
 
 	min = radialAccelerationMin;
 	max = radialAccelerationMax;
-	p->radialAcceleration = (float) rng.random(min, max);
+	float radialAcceleration = (float) rng.random(min, max);
 
 	min = tangentialAccelerationMin;
 	max = tangentialAccelerationMax;
-	p->tangentialAcceleration = (float) rng.random(min, max);
+	float tangentialAcceleration = (float) rng.random(min, max);
 
 	min = linearDampingMin;
 	max = linearDampingMax;
-	p->linearDamping = (float) rng.random(min, max);
+	float linearDamping = (float) rng.random(min, max);
 
-	p->sizeOffset       = (float) rng.random(sizeVariation); // time offset for size change
-	p->sizeIntervalSize = (1.0f - (float) rng.random(sizeVariation)) - p->sizeOffset;
-	p->size = sizes[(size_t)(p->sizeOffset - .5f) * (sizes.size() - 1)];
+	float sizeOffset       = (float) rng.random(sizeVariation); // time offset for size change
+	float sizeIntervalSize = (1.0f - (float) rng.random(sizeVariation)) - sizeOffset;
 
 	min = rotationMin;
 	max = rotationMax;
-	p->spinStart = calculate_variation(spinStart, spinEnd, spinVariation);
-	p->spinEnd = calculate_variation(spinEnd, spinStart, spinVariation);
-	p->rotation = (float) rng.random(min, max);
+	float pspinStart = calculate_variation(rng, spinStart, spinEnd, spinVariation);
+	float pspinEnd = calculate_variation(rng, spinEnd, spinStart, spinVariation);
+	float rotation = (float) rng.random(min, max);
 
-	p->angle = p->rotation;
+	float angle = rotation;
 	if (relativeRotation)
-		p->angle += atan2f(p->velocity.y, p->velocity.x);
+		angle += atan2f(velocity.y, velocity.x);
 
-	p->color = colors[0];
+	if (gpu != nullptr)
+	{
+		// Spawn IDs are stored in floats, which represent 24 bit integers
+		// exactly. 0 is the ID of slots which have never been used.
+		gpu->spawnID = gpu->spawnID >= 0xFFFFFF ? 1 : gpu->spawnID + 1;
 
-	p->quadIndex = 0;
-}
+		const float data[GPU_DATA_MAX_ENUM][4] =
+		{
+			{ ppos.x, ppos.y, velocity.x, velocity.y },
+			{ pos.x, pos.y, linearAccelerationX, linearAccelerationY },
+			{ radialAcceleration, tangentialAcceleration, linearDamping, plife },
+			{ pspinStart, pspinEnd, rotation, (float) gpu->spawnID },
+			{ sizeOffset, sizeIntervalSize, 0.0f, 0.0f },
+		};
 
-void ParticleSystem::insertTop(Particle *p)
-{
-	if (pHead == nullptr)
-	{
-		pHead = p;
-		p->prev = nullptr;
-	}
-	else
-	{
-		pTail->next = p;
-		p->prev = pTail;
-	}
-	p->next = nullptr;
-	pTail = p;
-}
+		for (int i = 0; i < GPU_DATA_MAX_ENUM; i++)
+			memcpy(&gpu->dataMemory[i][index * 4], data[i], sizeof(float) * 4);
 
-void ParticleSystem::insertBottom(Particle *p)
-{
-	if (pTail == nullptr)
-	{
-		pTail = p;
-		p->next = nullptr;
+		gpu->deaths.push(GPUSimulation::Death(gpu->time + plife, index));
+		gpu->dirtySlots.push_back(index);
+
+		return;
 	}
-	else
+
+	getParticleAttribute(PARTICLE_LIFETIME)[index] = plife;
+	getParticleAttribute(PARTICLE_LIFE)[index] = plife;
+	getParticleAttribute(PARTICLE_POSITION_X)[index] = ppos.x;
+	getParticleAttribute(PARTICLE_POSITION_Y)[index] = ppos.y;
+	getParticleAttribute(PARTICLE_ORIGIN_X)[index] = pos.x;
+	getParticleAttribute(PARTICLE_ORIGIN_Y)[index] = pos.y;
+	getParticleAttribute(PARTICLE_VELOCITY_X)[index] = velocity.x;
+	getParticleAttribute(PARTICLE_VELOCITY_Y)[index] = velocity.y;
+	getParticleAttribute(PARTICLE_LINEAR_ACCELERATION_X)[index] = linearAccelerationX;
+	getParticleAttribute(PARTICLE_LINEAR_ACCELERATION_Y)[index] = linearAccelerationY;
+	getParticleAttribute(PARTICLE_RADIAL_ACCELERATION)[index] = radialAcceleration;
+	getParticleAttribute(PARTICLE_TANGENTIAL_ACCELERATION)[index] = tangentialAcceleration;
+	getParticleAttribute(PARTICLE_LINEAR_DAMPING)[index] = linearDamping;
+	getParticleAttribute(PARTICLE_SIZE)[index] = sizes[(size_t)(sizeOffset - .5f) * (sizes.size() - 1)];
+	getParticleAttribute(PARTICLE_SIZE_OFFSET)[index] = sizeOffset;
+	getParticleAttribute(PARTICLE_SIZE_INTERVAL_SIZE)[index] = sizeIntervalSize;
+	getParticleAttribute(PARTICLE_ROTATION)[index] = rotation;
+	getParticleAttribute(PARTICLE_ANGLE)[index] = angle;
+	getParticleAttribute(PARTICLE_SPIN_START)[index] = pspinStart;
+	getParticleAttribute(PARTICLE_SPIN_END)[index] = pspinEnd;
+	getParticleAttribute(PARTICLE_COLOR_R)[index] = colors[0].r;
+	getParticleAttribute(PARTICLE_COLOR_G)[index] = colors[0].g;
+	getParticleAttribute(PARTICLE_COLOR_B)[index] = colors[0].b;
+	getParticleAttribute(PARTICLE_COLOR_A)[index] = colors[0].a;
+}
+
+void ParticleSystem::moveParticle(uint32 dst, uint32 src)
+{
+	float *attribs = pMem;
+	for (int i = 0; i < PARTICLE_ATTRIBUTE_MAX_ENUM; i++)
 	{
-		pHead->prev = p;
-		p->next = pHead;
+		attribs[dst] = attribs[src];
+		attribs += maxParticles;
 	}
-	p->prev = nullptr;
-	pHead = p;
 }
 
-void ParticleSystem::insertRandom(Particle *p)
+void ParticleSystem::reverseParticles()
 {
-	// Nonuniform, but 64-bit is so large nobody will notice. Hopefully.
-	uint64 pos = rng.rand() % ((int64) activeParticles + 1);
+	if (pMem == nullptr || activeParticles == 0)
+		return;
 
-	// Special case where the particle gets inserted before the head.
-	if (pos == activeParticles)
+	float *attribs = pMem;
+	for (int i = 0; i < PARTICLE_ATTRIBUTE_MAX_ENUM; i++)
 	{
-		Particle *pA = pHead;
-		if (pA)
-			pA->prev = p;
-		p->prev = nullptr;
-		p->next = pA;
-		pHead = p;
-		return;
+		std::reverse(attribs, attribs + activeParticles);
+		attribs += maxParticles;
 	}
-
-	// Inserts the particle after the randomly selected particle.
-	Particle *pA = pMem + pos;
-	Particle *pB = pA->next;
-	pA->next = p;
-	if (pB)
-		pB->prev = p;
-	else
-		pTail = p;
-	p->prev = pA;
-	p->next = pB;
 }
 
-ParticleSystem::Particle *ParticleSystem::removeParticle(Particle *p)
+int ParticleSystem::getQuadIndex(uint32 index) const
 {
-	// The linked list is updated in this function and old pointers may be
-	// invalidated. The returned pointer will inform the caller of the new
-	// pointer to the next particle.
-	Particle *pNext = nullptr;
-
-	// Removes the particle from the linked list.
-	if (p->prev)
-		p->prev->next = p->next;
-	else
-		pHead = p->next;
+	size_t k = quads.size();
+	if (k == 0)
+		return 0;
 
-	if (p->next)
-	{
-		p->next->prev = p->prev;
-		pNext = p->next;
-	}
-	else
-		pTail = p->prev;
-
-	// The (in memory) last particle can now be moved into the free slot.
-	// It will skip the moving if it happens to be the removed particle.
-	pFree--;
-	if (p != pFree)
-	{
-		*p = *pFree;
-		if (pNext == pFree)
-			pNext = p;
+	const float *lifetimes = getParticleAttribute(PARTICLE_LIFETIME);
+	const float *lives = getParticleAttribute(PARTICLE_LIFE);
 
-		if (p->prev)
-			p->prev->next = p;
-		else
-			pHead = p;
+	float t = 1.0f - lives[index] / lifetimes[index];
 
-		if (p->next)
-			p->next->prev = p;
-		else
-			pTail = p;
-	}
-
-	activeParticles--;
-	return pNext;
+	float s = t * (float) k; // [0:numquads-1] (clamped below)
+	size_t i = (s > 0.0f) ? (size_t) s : 0;
+	return (int) ((i < k) ? i : k - 1);
 }
 
 void ParticleSystem::setTexture(Texture *tex)
@@ -504,6 +548,11 @@ void ParticleSystem::setTexture(Texture *tex)
 
 	if (defaultOffset)
 		resetOffset();
+
+	verticesPrepared = false;
+
+	if (gpu != nullptr)
+		gpu->slotVerticesValid = false;
 }
 
 Texture *ParticleSystem::getTexture() const
@@ -513,7 +562,12 @@ Texture *ParticleSystem::getTexture() const
 
 void ParticleSystem::setInsertMode(InsertMode mode)
 {
+	// Particles are stored in reverse draw order when inserting at the bottom.
+	if ((mode == INSERT_MODE_BOTTOM) != (insertMode == INSERT_MODE_BOTTOM))
+		reverseParticles();
+
 	insertMode = mode;
+	verticesPrepared = false;
 }
 
 ParticleSystem::InsertMode ParticleSystem::getInsertMode() const
@@ -521,6 +575,52 @@ ParticleSystem::InsertMode ParticleSystem::getInsertMode() const
 	return insertMode;
 }
 
+void ParticleSystem::setSimulationMode(SimulationMode mode)
+{
+	if (mode == simulationMode)
+		return;
+
+	if (mode == SIMULATION_GPU && !isGPUSimulationSupported())
+		throw love::Exception("GPU particle simulation is not supported on this system.");
+
+	uint32 size = maxParticles;
+	deleteBuffers();
+
+	SimulationMode oldmode = simulationMode;
+	simulationMode = mode;
+
+	try
+	{
+		createBuffers(size);
+	}
+	catch (love::Exception &)
+	{
+		simulationMode = oldmode;
+		createBuffers(size);
+		reset();
+		throw;
+	}
+
+	reset();
+}
+
+ParticleSystem::SimulationMode ParticleSystem::getSimulationMode() const
+{
+	return simulationMode;
+}
+
+bool ParticleSystem::isGPUSimulationSupported()
+{
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+
+	// The standard particle shaders are only created when the system supports
+	// float canvases, multiple render targets and vertex texture fetches.
+	return gfx != nullptr
+		&& Shader::standardShaders[Shader::STANDARD_PARTICLE_SIMULATION] != nullptr
+		&& Shader::standardShaders[Shader::STANDARD_PARTICLE_DRAW] != nullptr
+		&& gfx->isImageFormatSupported(PIXELFORMAT_RGBA32F);
+}
+
 void ParticleSystem::setEmissionRate(float rate)
 {
 	if (rate < 0.0f)
@@ -769,6 +869,7 @@ void ParticleSystem::setOffset(float x, float y)
 {
 	offset = love::Vector2(x, y);
 	defaultOffset = false;
+	verticesPrepared = false;
 }
 
 love::Vector2 ParticleSystem::getOffset() const
@@ -807,11 +908,14 @@ void ParticleSystem::setQuads(const std::vector<Quad *> &newQuads)
 
 	if (defaultOffset)
 		resetOffset();
+
+	verticesPrepared = false;
 }
 
 void ParticleSystem::setQuads()
 {
 	quads.clear();
+	verticesPrepared = false;
 }
 
 std::vector<Quad *> ParticleSystem::getQuads() const
@@ -859,15 +963,20 @@ void ParticleSystem::pause()
 
 void ParticleSystem::reset()
 {
-	if (pMem == nullptr)
+	if (maxParticles == 0)
 		return;
 
-	pFree = pMem;
-	pHead = nullptr;
-	pTail = nullptr;
 	activeParticles = 0;
 	life = lifetime;
 	emitCounter = 0;
+	verticesPrepared = false;
+
+	if (gpu != nullptr)
+	{
+		gpu->deaths = decltype(gpu->deaths)();
+		gpu->freeSlots.clear();
+		gpu->slotCount = 0;
+	}
 }
 
 void ParticleSystem::emit(uint32 num)
@@ -879,6 +988,10 @@ void ParticleSystem::emit(uint32 num)
 
 	while (num--)
 		addParticle(1.0f);
+
+	// Initialize the new particles right away, so they're drawn.
+	if (gpu != nullptr)
+		simulateGPU(Module::getInstance<Graphics>(Module::M_GRAPHICS), 0.0f);
 }
 
 bool ParticleSystem::isActive() const
@@ -906,101 +1019,238 @@ bool ParticleSystem::isFull() const
 	return activeParticles == maxParticles;
 }
 
-void ParticleSystem::update(float dt)
-{
-	if (pMem == nullptr || dt == 0.0f)
-		return;
+void ParticleSystem::integrateParticles(uint32 count, float dt)
+{
+	uint32 i = 0;
+
+	float *lifetimes = getParticleAttribute(PARTICLE_LIFETIME);
+	float *lives = getParticleAttribute(PARTICLE_LIFE);
+	float *positionsX = getParticleAttribute(PARTICLE_POSITION_X);
+	float *positionsY = getParticleAttribute(PARTICLE_POSITION_Y);
+	float *originsX = getParticleAttribute(PARTICLE_ORIGIN_X);
+	float *originsY = getParticleAttribute(PARTICLE_ORIGIN_Y);
+	float *velocitiesX = getParticleAttribute(PARTICLE_VELOCITY_X);
+	float *velocitiesY = getParticleAttribute(PARTICLE_VELOCITY_Y);
+	float *linearAccelerationsX = getParticleAttribute(PARTICLE_LINEAR_ACCELERATION_X);
+	float *linearAccelerationsY = getParticleAttribute(PARTICLE_LINEAR_ACCELERATION_Y);
+	float *radialAccelerations = getParticleAttribute(PARTICLE_RADIAL_ACCELERATION);
+	float *tangentialAccelerations = getParticleAttribute(PARTICLE_TANGENTIAL_ACCELERATION);
+	float *linearDampings = getParticleAttribute(PARTICLE_LINEAR_DAMPING);
+	float *rotations = getParticleAttribute(PARTICLE_ROTATION);
+	float *spinStarts = getParticleAttribute(PARTICLE_SPIN_START);
+	float *spinEnds = getParticleAttribute(PARTICLE_SPIN_END);
+
+	// The SIMD paths must perform exactly the same operations in the same
+	// order as the scalar loop below, so results are identical on all paths.
+	// Multiply-adds aren't contracted in this file (see the top) for the same
+	// reason.
+
+#if defined(LOVE_SIMD_SSE)
+
+	// The attribute arrays aren't guaranteed to be 16-byte aligned (their
+	// offsets depend on the buffer size), so we use unaligned loads/stores.
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signbit = _mm_set1_ps(-0.0f);
+	const __m128 vdt = _mm_set1_ps(dt);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 px = _mm_loadu_ps(positionsX + i);
+		__m128 py = _mm_loadu_ps(positionsY + i);
 
-	// Traverse all particles and update.
-	Particle *p = pHead;
+		__m128 rx = _mm_sub_ps(px, _mm_loadu_ps(originsX + i));
+		__m128 ry = _mm_sub_ps(py, _mm_loadu_ps(originsY + i));
 
-	while (p)
-	{
-		// Decrease lifespan.
-		p->life -= dt;
+		__m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)));
+		__m128 haslen = _mm_cmpgt_ps(len, zero);
+		__m128 m = _mm_div_ps(one, len);
+		rx = _mm_or_ps(_mm_and_ps(haslen, _mm_mul_ps(rx, m)), _mm_andnot_ps(haslen, rx));
+		ry = _mm_or_ps(_mm_and_ps(haslen, _mm_mul_ps(ry, m)), _mm_andnot_ps(haslen, ry));
 
-		if (p->life <= 0)
-			p = removeParticle(p);
-		else
-		{
-			// Temp variables.
-			love::Vector2 radial, tangential;
-			love::Vector2 ppos = p->position;
+		__m128 ra = _mm_loadu_ps(radialAccelerations + i);
+		__m128 ta = _mm_loadu_ps(tangentialAccelerations + i);
 
-			// Get vector from particle center to particle.
-			radial = ppos - p->origin;
-			radial.normalize();
-			tangential = radial;
+		__m128 ax = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, ra), _mm_mul_ps(_mm_xor_ps(ry, signbit), ta)), _mm_loadu_ps(linearAccelerationsX + i));
+		__m128 ay = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ry, ra), _mm_mul_ps(rx, ta)), _mm_loadu_ps(linearAccelerationsY + i));
 
-			// Resize radial acceleration.
-			radial *= p->radialAcceleration;
+		__m128 damping = _mm_div_ps(one, _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(linearDampings + i), vdt)));
+		__m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(velocitiesX + i), _mm_mul_ps(ax, vdt)), damping);
+		__m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(velocitiesY + i), _mm_mul_ps(ay, vdt)), damping);
 
-			// Calculate tangential acceleration.
-			{
-				float a = tangential.x;
-				tangential.x = -tangential.y;
-				tangential.y = a;
-			}
+		_mm_storeu_ps(velocitiesX + i, vx);
+		_mm_storeu_ps(velocitiesY + i, vy);
+
+		_mm_storeu_ps(positionsX + i, _mm_add_ps(px, _mm_mul_ps(vx, vdt)));
+		_mm_storeu_ps(positionsY + i, _mm_add_ps(py, _mm_mul_ps(vy, vdt)));
 
-			// Resize tangential.
-			tangential *= p->tangentialAcceleration;
+		__m128 t = _mm_sub_ps(one, _mm_div_ps(_mm_loadu_ps(lives + i), _mm_loadu_ps(lifetimes + i)));
+		__m128 spin = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(spinStarts + i), _mm_sub_ps(one, t)), _mm_mul_ps(_mm_loadu_ps(spinEnds + i), t));
+		_mm_storeu_ps(rotations + i, _mm_add_ps(_mm_loadu_ps(rotations + i), _mm_mul_ps(spin, vdt)));
+	}
 
-			// Update velocity.
-			p->velocity += (radial + tangential + p->linearAcceleration) * dt;
+#elif defined(LOVE_PARTICLE_SIMD_NEON)
 
-			// Apply damping.
-			p->velocity *= 1.0f / (1.0f + p->linearDamping * dt);
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t vdt = vdupq_n_f32(dt);
 
-			// Modify position.
-			ppos += p->velocity * dt;
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4_t px = vld1q_f32(positionsX + i);
+		float32x4_t py = vld1q_f32(positionsY + i);
 
-			p->position = ppos;
+		float32x4_t rx = vsubq_f32(px, vld1q_f32(originsX + i));
+		float32x4_t ry = vsubq_f32(py, vld1q_f32(originsY + i));
 
-			const float t = 1.0f - p->life / p->lifetime;
+		float32x4_t len = vsqrtq_f32(vaddq_f32(vmulq_f32(rx, rx), vmulq_f32(ry, ry)));
+		uint32x4_t haslen = vcgtq_f32(len, zero);
+		float32x4_t m = vdivq_f32(one, len);
+		rx = vbslq_f32(haslen, vmulq_f32(rx, m), rx);
+		ry = vbslq_f32(haslen, vmulq_f32(ry, m), ry);
 
-			// Rotate.
-			p->rotation += (p->spinStart * (1.0f - t) + p->spinEnd * t) * dt;
+		float32x4_t ra = vld1q_f32(radialAccelerations + i);
+		float32x4_t ta = vld1q_f32(tangentialAccelerations + i);
 
-			p->angle = p->rotation;
+		float32x4_t ax = vaddq_f32(vaddq_f32(vmulq_f32(rx, ra), vmulq_f32(vnegq_f32(ry), ta)), vld1q_f32(linearAccelerationsX + i));
+		float32x4_t ay = vaddq_f32(vaddq_f32(vmulq_f32(ry, ra), vmulq_f32(rx, ta)), vld1q_f32(linearAccelerationsY + i));
 
-			if (relativeRotation)
-				p->angle += atan2f(p->velocity.y, p->velocity.x);
+		float32x4_t damping = vdivq_f32(one, vaddq_f32(one, vmulq_f32(vld1q_f32(linearDampings + i), vdt)));
+		float32x4_t vx = vmulq_f32(vaddq_f32(vld1q_f32(velocitiesX + i), vmulq_f32(ax, vdt)), damping);
+		float32x4_t vy = vmulq_f32(vaddq_f32(vld1q_f32(velocitiesY + i), vmulq_f32(ay, vdt)), damping);
 
-			// Change size according to given intervals:
-			// i = 0       1       2      3          n-1
-			//     |-------|-------|------|--- ... ---|
-			// t = 0    1/(n-1)        3/(n-1)        1
-			//
-			// `s' is the interpolation variable scaled to the current
-			// interval width, e.g. if n = 5 and t = 0.3, then the current
-			// indices are 1,2 and s = 0.3 - 0.25 = 0.05
-			float s = p->sizeOffset + t * p->sizeIntervalSize; // size variation
-			s *= (float)(sizes.size() - 1); // 0 <= s < sizes.size()
-			size_t i = (size_t)s;
-			size_t k = (i == sizes.size() - 1) ? i : i + 1; // boundary check (prevents failing on t = 1.0f)
-			s -= (float)i; // transpose s to be in interval [0:1]: i <= s < i + 1 ~> 0 <= s < 1
-			p->size = sizes[i] * (1.0f - s) + sizes[k] * s;
+		vst1q_f32(velocitiesX + i, vx);
+		vst1q_f32(velocitiesY + i, vy);
 
-			// Update color according to given intervals (as above)
-			s = t * (float)(colors.size() - 1);
-			i = (size_t)s;
-			k = (i == colors.size() - 1) ? i : i + 1;
-			s -= (float)i;                            // 0 <= s <= 1
-			p->color = colors[i] * (1.0f - s) + colors[k] * s;
+		vst1q_f32(positionsX + i, vaddq_f32(px, vmulq_f32(vx, vdt)));
+		vst1q_f32(positionsY + i, vaddq_f32(py, vmulq_f32(vy, vdt)));
 
-			// Update the quad index.
-			k = quads.size();
-			if (k > 0)
-			{
-				s = t * (float) k; // [0:numquads-1] (clamped below)
-				i = (s > 0.0f) ? (size_t) s : 0;
-				p->quadIndex = (int) ((i < k) ? i : k - 1);
-			}
+		float32x4_t t = vsubq_f32(one, vdivq_f32(vld1q_f32(lives + i), vld1q_f32(lifetimes + i)));
+		float32x4_t spin = vaddq_f32(vmulq_f32(vld1q_f32(spinStarts + i), vsubq_f32(one, t)), vmulq_f32(vld1q_f32(spinEnds + i), t));
+		vst1q_f32(rotations + i, vaddq_f32(vld1q_f32(rotations + i), vmulq_f32(spin, vdt)));
+	}
 
-			// Next particle.
-			p = p->next;
+#endif
+
+	// Remaining particles (or all of them, without SIMD support.)
+	for (; i < count; i++)
+	{
+		// Get the normalized vector from particle center to particle.
+		float rx = positionsX[i] - originsX[i];
+		float ry = positionsY[i] - originsY[i];
+
+		float len = sqrtf(rx*rx + ry*ry);
+		if (len > 0)
+		{
+			float m = 1.0f / len;
+			rx *= m;
+			ry *= m;
 		}
+
+		// Radial acceleration, plus tangential acceleration (perpendicular to
+		// the radial direction), plus linear acceleration.
+		float ax = (rx * radialAccelerations[i] + (-ry) * tangentialAccelerations[i]) + linearAccelerationsX[i];
+		float ay = (ry * radialAccelerations[i] + rx * tangentialAccelerations[i]) + linearAccelerationsY[i];
+
+		// Update velocity and apply damping.
+		float damping = 1.0f / (1.0f + linearDampings[i] * dt);
+		float vx = (velocitiesX[i] + ax * dt) * damping;
+		float vy = (velocitiesY[i] + ay * dt) * damping;
+
+		velocitiesX[i] = vx;
+		velocitiesY[i] = vy;
+
+		// Modify position.
+		positionsX[i] += vx * dt;
+		positionsY[i] += vy * dt;
+
+		// Rotate.
+		const float t = 1.0f - lives[i] / lifetimes[i];
+		rotations[i] += (spinStarts[i] * (1.0f - t) + spinEnds[i] * t) * dt;
 	}
+}
+
+void ParticleSystem::updateParticleAppearance(uint32 i)
+{
+	const float t = 1.0f - getParticleAttribute(PARTICLE_LIFE)[i] / getParticleAttribute(PARTICLE_LIFETIME)[i];
+
+	float angle = getParticleAttribute(PARTICLE_ROTATION)[i];
+
+	if (relativeRotation)
+		angle += atan2f(getParticleAttribute(PARTICLE_VELOCITY_Y)[i], getParticleAttribute(PARTICLE_VELOCITY_X)[i]);
+
+	getParticleAttribute(PARTICLE_ANGLE)[i] = angle;
+
+	// Change size according to given intervals:
+	// i = 0       1       2      3          n-1
+	//     |-------|-------|------|--- ... ---|
+	// t = 0    1/(n-1)        3/(n-1)        1
+	//
+	// `s' is the interpolation variable scaled to the current
+	// interval width, e.g. if n = 5 and t = 0.3, then the current
+	// indices are 1,2 and s = 0.3 - 0.25 = 0.05
+	float s = getParticleAttribute(PARTICLE_SIZE_OFFSET)[i] + t * getParticleAttribute(PARTICLE_SIZE_INTERVAL_SIZE)[i]; // size variation
+	s *= (float)(sizes.size() - 1); // 0 <= s < sizes.size()
+	size_t j = (size_t)s;
+	size_t k = (j == sizes.size() - 1) ? j : j + 1; // boundary check (prevents failing on t = 1.0f)
+	s -= (float)j; // transpose s to be in interval [0:1]: j <= s < j + 1 ~> 0 <= s < 1
+	getParticleAttribute(PARTICLE_SIZE)[i] = sizes[j] * (1.0f - s) + sizes[k] * s;
+
+	// Update color according to given intervals (as above)
+	s = t * (float)(colors.size() - 1);
+	j = (size_t)s;
+	k = (j == colors.size() - 1) ? j : j + 1;
+	s -= (float)j;                            // 0 <= s <= 1
+	Colorf color = colors[j] * (1.0f - s) + colors[k] * s;
+
+	getParticleAttribute(PARTICLE_COLOR_R)[i] = color.r;
+	getParticleAttribute(PARTICLE_COLOR_G)[i] = color.g;
+	getParticleAttribute(PARTICLE_COLOR_B)[i] = color.b;
+	getParticleAttribute(PARTICLE_COLOR_A)[i] = color.a;
+}
+
+void ParticleSystem::updateCPU(float dt)
+{
+	float *lives = getParticleAttribute(PARTICLE_LIFE);
+
+	// Decrease lifespans, and remove dead particles by shifting the remaining
+	// ones down, which keeps them packed and in order.
+	uint32 alive = 0;
+
+	for (uint32 i = 0; i < activeParticles; i++)
+	{
+		lives[i] -= dt;
+
+		if (lives[i] <= 0)
+			continue;
+
+		if (alive != i)
+			moveParticle(alive, i);
+
+		alive++;
+	}
+
+	activeParticles = alive;
+
+	integrateParticles(activeParticles, dt);
+
+	// Sizes and colors are interpolated from lookup tables, which doesn't
+	// vectorize well.
+	for (uint32 i = 0; i < activeParticles; i++)
+		updateParticleAppearance(i);
+}
+
+void ParticleSystem::update(float dt)
+{
+	if (maxParticles == 0 || dt == 0.0f)
+		return;
+
+	verticesPrepared = false;
+
+	if (gpu != nullptr)
+		updateGPUSlots(dt);
+	else
+		updateCPU(dt);
 
 	// Make some more particles.
 	if (active)
@@ -1020,49 +1270,54 @@ void ParticleSystem::update(float dt)
 	}
 
 	prevPosition = position;
+
+	// New particles are initialized by the simulation shader as well.
+	if (gpu != nullptr)
+		simulateGPU(Module::getInstance<Graphics>(Module::M_GRAPHICS), dt);
 }
 
-void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
+void ParticleSystem::generateVertices(Vertex *pVerts) const
 {
-	uint32 pCount = getCount();
-
-	if (pCount == 0 || texture.get() == nullptr || pMem == nullptr || buffer == nullptr)
-		return;
-
-	gfx->flushStreamDraws();
-
-	if (Shader::isDefaultActive())
-		Shader::attachDefault(Shader::STANDARD_DEFAULT);
-
-	if (Shader::current && texture.get())
-		Shader::current->checkMainTexture(texture);
+	uint32 count = getCount();
 
 	const Vector2 *positions = texture->getQuad()->getVertexPositions();
 	const Vector2 *texcoords = texture->getQuad()->getVertexTexCoords();
 
-	Vertex *pVerts = (Vertex *) buffer->map();
-	Particle *p = pHead;
+	const float *positionsX = getParticleAttribute(PARTICLE_POSITION_X);
+	const float *positionsY = getParticleAttribute(PARTICLE_POSITION_Y);
+	const float *psizes = getParticleAttribute(PARTICLE_SIZE);
+	const float *angles = getParticleAttribute(PARTICLE_ANGLE);
+	const float *colorsR = getParticleAttribute(PARTICLE_COLOR_R);
+	const float *colorsG = getParticleAttribute(PARTICLE_COLOR_G);
+	const float *colorsB = getParticleAttribute(PARTICLE_COLOR_B);
+	const float *colorsA = getParticleAttribute(PARTICLE_COLOR_A);
 
 	bool useQuads = !quads.empty();
 
+	// Particles are stored in reverse draw order when inserting at the bottom.
+	bool reverse = insertMode == INSERT_MODE_BOTTOM;
+
 	Matrix3 t;
 
 	// set the vertex data for each particle (transformation, texcoords, color)
-	while (p)
+	for (uint32 n = 0; n < count; n++)
 	{
+		uint32 i = reverse ? count - n - 1 : n;
+
 		if (useQuads)
 		{
-			positions = quads[p->quadIndex]->getVertexPositions();
-			texcoords = quads[p->quadIndex]->getVertexTexCoords();
+			int quadindex = getQuadIndex(i);
+			positions = quads[quadindex]->getVertexPositions();
+			texcoords = quads[quadindex]->getVertexTexCoords();
 		}
 
 		// particle vertices are image vertices transformed by particle info
-		t.setTransformation(p->position.x, p->position.y, p->angle, p->size, p->size, offset.x, offset.y, 0.0f, 0.0f);
+		t.setTransformation(positionsX[i], positionsY[i], angles[i], psizes[i], psizes[i], offset.x, offset.y, 0.0f, 0.0f);
 		t.transformXY(pVerts, positions, 4);
 
 		// Particle colors are stored as floats (0-1) but vertex colors are
 		// unsigned bytes (0-255).
-		Color32 c = toColor32(p->color);
+		Color32 c = toColor32(Colorf(colorsR[i], colorsG[i], colorsB[i], colorsA[i]));
 
 		// set the texture coordinate and color data for particle vertices
 		for (int v = 0; v < 4; v++)
@@ -1073,9 +1328,83 @@ void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
 		}
 
 		pVerts += 4;
-		p = p->next;
+	}
+}
+
+void ParticleSystem::updateMultiple(const std::vector<ParticleSystem *> &systems, float dt)
+{
+	// Each system is updated on its own thread, so one can't be in the list
+	// more than once.
+	std::vector<ParticleSystem *> sorted(systems);
+	std::sort(sorted.begin(), sorted.end());
+	if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+		throw love::Exception("The same ParticleSystem cannot be updated more than once at a time.");
+
+	// GPU simulation uses the graphics API, so it has to happen on the main
+	// thread.
+	std::vector<ParticleSystem *> cpuSystems;
+	cpuSystems.reserve(systems.size());
+	for (ParticleSystem *ps : systems)
+	{
+		if (ps->gpu != nullptr)
+			ps->update(dt);
+		else
+			cpuSystems.push_back(ps);
 	}
 
+	// Mapping doesn't touch the graphics API, but we do it here anyway since
+	// only the main thread is allowed to use Buffers.
+	std::vector<Vertex *> vertices(cpuSystems.size());
+	for (size_t i = 0; i < cpuSystems.size(); i++)
+	{
+		if (cpuSystems[i]->pMem != nullptr && cpuSystems[i]->buffer != nullptr)
+			vertices[i] = (Vertex *) cpuSystems[i]->buffer->map();
+		else
+			vertices[i] = nullptr;
+	}
+
+	love::thread::WorkerPool::getShared()->parallelFor((int) cpuSystems.size(), [&](int i)
+	{
+		ParticleSystem *ps = cpuSystems[i];
+		ps->update(dt);
+
+		if (vertices[i] != nullptr && ps->texture.get() != nullptr)
+		{
+			ps->generateVertices(vertices[i]);
+			ps->verticesPrepared = true;
+		}
+	});
+}
+
+void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
+{
+	uint32 pCount = getCount();
+
+	if (pCount == 0 || texture.get() == nullptr || maxParticles == 0 || buffer == nullptr)
+		return;
+
+	gfx->flushStreamDraws();
+
+	if (gpu != nullptr)
+	{
+		drawGPU(gfx, m);
+		return;
+	}
+
+	if (Shader::isDefaultActive())
+		Shader::attachDefault(Shader::STANDARD_DEFAULT);
+
+	if (Shader::current && texture.get())
+		Shader::current->checkMainTexture(texture);
+
+	// The vertices may have already been generated by updateMultiple.
+	Vertex *pVerts = (Vertex *) buffer->map();
+
+	if (!verticesPrepared)
+		generateVertices(pVerts);
+
+	verticesPrepared = false;
+
 	buffer->unmap();
 
 	Graphics::TempTransform transform(gfx, m);
@@ -1086,6 +1415,314 @@ void ParticleSystem::draw(Graphics *gfx, const Matrix4 &m)
 	gfx->drawQuads(0, pCount, vertexAttributes, vertexbuffers, texture);
 }
 
+void ParticleSystem::createGPUSimulation(size_t size)
+{
+	if (!isGPUSimulationSupported())
+		throw love::Exception("GPU particle simulation is not supported on this system.");
+
+	// Slot indices are stored in the 24 bits of the vertex color's RGB
+	// components.
+	if (size > 0xFFFFFF)
+		throw love::Exception("GPU-simulated ParticleSystems can have at most %d particles.", 0xFFFFFF);
+
+	auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
+
+	// One pixel per particle slot, laid out in rows.
+	int width = 1;
+	while ((size_t) width * (size_t) width < size)
+		width *= 2;
+
+	int height = (int) ((size + width - 1) / width);
+
+	int maxsize = (int) gfx->getCapabilities().limits[Graphics::LIMIT_TEXTURE_SIZE];
+	if (width > maxsize || height > maxsize)
+		throw love::Exception("ParticleSystem buffer size is too large for GPU simulation on this system.");
+
+	gpu = new GPUSimulation();
+	gpu->width = width;
+	gpu->height = height;
+
+	Texture::Filter filter;
+	filter.min = filter.mag = Texture::FILTER_NEAREST;
+
+	Canvas::Settings settings;
+	settings.width = width;
+	settings.height = height;
+	settings.format = PIXELFORMAT_RGBA32F;
+	settings.readable.set(true);
+
+	for (int i = 0; i < 2; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			gpu->state[i][j].set(gfx->newCanvas(settings), Acquire::NORETAIN);
+			gpu->state[i][j]->setFilter(filter);
+		}
+	}
+
+	size_t components = (size_t) width * height * 4;
+	Rect rect = {0, 0, width, height};
+
+	for (int i = 0; i < GPU_DATA_MAX_ENUM; i++)
+	{
+		gpu->data[i].set(gfx->newImage(TEXTURE_2D, PIXELFORMAT_RGBA32F, width, height, 1, Image::Settings()), Acquire::NORETAIN);
+		gpu->data[i]->setFilter(filter);
+
+		// New images have undefined contents.
+		gpu->dataMemory[i].resize(components, 0.0f);
+		gpu->data[i]->replacePixels(gpu->dataMemory[i].data(), sizeof(float) * components, 0, 0, rect, false);
+	}
+
+	gpu->freeSlots.reserve(size);
+
+	gpu->quadBuffer = gfx->newBuffer(sizeof(Vertex) * 4, nullptr, BUFFER_VERTEX, vertex::USAGE_STREAM, 0);
+}
+
+void ParticleSystem::deleteGPUSimulation()
+{
+	if (gpu == nullptr)
+		return;
+
+	delete gpu->quadBuffer;
+	delete gpu;
+	gpu = nullptr;
+}
+
+uint32 ParticleSystem::allocateGPUSlot()
+{
+	if (!gpu->freeSlots.empty())
+	{
+		uint32 slot = gpu->freeSlots.back();
+		gpu->freeSlots.pop_back();
+		return slot;
+	}
+
+	return gpu->slotCount++;
+}
+
+void ParticleSystem::updateGPUSlots(float dt)
+{
+	// The GPU decrements its own copy of each life by the same deltas, so
+	// both agree on when a particle dies. Only the slots which die are
+	// touched here.
+	gpu->time += dt;
+
+	while (!gpu->deaths.empty() && gpu->deaths.top().first <= gpu->time)
+	{
+		gpu->freeSlots.push_back(gpu->deaths.top().second);
+		gpu->deaths.pop();
+		activeParticles--;
+	}
+
+	// Start over from the first slot once everything is dead, to keep the
+	// simulated and drawn ranges small.
+	if (activeParticles == 0)
+	{
+		gpu->freeSlots.clear();
+		gpu->slotCount = 0;
+	}
+}
+
+void ParticleSystem::uploadGPUData()
+{
+	std::vector<uint32> &slots = gpu->dirtySlots;
+	if (slots.empty())
+		return;
+
+	// A slot can be listed twice if it was freed and reused in between.
+	std::sort(slots.begin(), slots.end());
+	slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+	uint32 width = (uint32) gpu->width;
+
+	// Upload each contiguous run of new slots on its own, so slots which
+	// are still being simulated in between aren't sent again.
+	for (size_t first = 0; first < slots.size();)
+	{
+		size_t last = first;
+		while (last + 1 < slots.size() && slots[last + 1] == slots[last] + 1)
+			last++;
+
+		uint32 slot = slots[first];
+		uint32 end = slots[last] + 1;
+
+		while (slot < end)
+		{
+			uint32 x = slot % width;
+			uint32 y = slot / width;
+
+			// Whole rows at once, otherwise the part of a row in the run.
+			Rect rect;
+			uint32 count;
+			if (x == 0 && end - slot >= width)
+			{
+				uint32 rows = (end - slot) / width;
+				rect = {0, (int) y, (int) width, (int) rows};
+				count = rows * width;
+			}
+			else
+			{
+				count = std::min(end - slot, width - x);
+				rect = {(int) x, (int) y, (int) count, 1};
+			}
+
+			size_t size = sizeof(float) * 4 * count;
+
+			for (int i = 0; i < GPU_DATA_MAX_ENUM; i++)
+				gpu->data[i]->replacePixels(&gpu->dataMemory[i][(size_t) slot * 4], size, 0, 0, rect, false);
+
+			slot += count;
+		}
+
+		first = last + 1;
+	}
+
+	slots.clear();
+}
+
+void ParticleSystem::simulateGPU(Graphics *gfx, float dt)
+{
+	uploadGPUData();
+
+	Shader *shader = Shader::standardShaders[Shader::STANDARD_PARTICLE_SIMULATION];
+	if (shader == nullptr || gpu->slotCount == 0)
+		return;
+
+	int src = gpu->current;
+	int dst = 1 - src;
+
+	// Only the rows which contain used slots need to be simulated.
+	int rows = (int) ((gpu->slotCount + gpu->width - 1) / gpu->width);
+	float w = (float) gpu->width;
+	float h = (float) rows;
+	float v = h / (float) gpu->height;
+
+	Color32 white(255, 255, 255, 255);
+	const Vertex quad[4] =
+	{
+		{0.0f, 0.0f, 0.0f, 0.0f, white},
+		{0.0f, h, 0.0f, v, white},
+		{w, 0.0f, 1.0f, 0.0f, white},
+		{w, h, 1.0f, v, white},
+	};
+
+	memcpy(gpu->quadBuffer->map(), quad, sizeof(quad));
+	gpu->quadBuffer->unmap();
+
+	Graphics::RenderTargets rts;
+	rts.colors.emplace_back(gpu->state[dst][0].get());
+	rts.colors.emplace_back(gpu->state[dst][1].get());
+
+	gfx->push(Graphics::STACK_ALL);
+
+	try
+	{
+		gfx->origin();
+		gfx->setCanvas(rts);
+		gfx->setColor(Colorf(1.0f, 1.0f, 1.0f, 1.0f));
+		gfx->setBlendMode(Graphics::BLEND_REPLACE, Graphics::BLENDALPHA_PREMULTIPLIED);
+		gfx->setScissor();
+		gfx->setStencilTest();
+		gfx->setDepthMode();
+		gfx->setColorMask(Graphics::ColorMask());
+		gfx->setWireframe(false);
+		gfx->setShader(shader);
+
+		sendShaderTexture(shader, "love_ParticleLife", gpu->state[src][1]);
+		sendShaderTexture(shader, "love_ParticleSpawn", gpu->data[GPU_DATA_SPAWN]);
+		sendShaderTexture(shader, "love_ParticleMotion", gpu->data[GPU_DATA_MOTION]);
+		sendShaderTexture(shader, "love_ParticleForces", gpu->data[GPU_DATA_FORCES]);
+		sendShaderTexture(shader, "love_ParticleSpin", gpu->data[GPU_DATA_SPIN]);
+		sendShaderFloats(shader, "love_ParticleDelta", &dt, 1);
+
+		vertex::BufferBindings vertexbuffers;
+		vertexbuffers.set(0, gpu->quadBuffer, 0);
+
+		gfx->drawQuads(0, 1, vertexAttributes, vertexbuffers, gpu->state[src][0]);
+	}
+	catch (love::Exception &)
+	{
+		gfx->pop();
+		throw;
+	}
+
+	gfx->pop();
+
+	gpu->current = dst;
+}
+
+void ParticleSystem::drawGPU(Graphics *gfx, const Matrix4 &m)
+{
+	Shader *shader = Shader::standardShaders[Shader::STANDARD_PARTICLE_DRAW];
+	if (shader == nullptr || gpu->slotCount == 0)
+		return;
+
+	// Every slot's quad is the same, aside from its index (stored in the
+	// vertex color.) The draw shader moves them into place.
+	if (!gpu->slotVerticesValid)
+	{
+		const Vector2 *positions = texture->getQuad()->getVertexPositions();
+		const Vector2 *texcoords = texture->getQuad()->getVertexTexCoords();
+
+		Vertex *pVerts = (Vertex *) buffer->map();
+
+		for (uint32 slot = 0; slot < maxParticles; slot++)
+		{
+			Color32 c((slot >> 0) & 0xFF, (slot >> 8) & 0xFF, (slot >> 16) & 0xFF, 255);
+
+			for (int v = 0; v < 4; v++)
+			{
+				pVerts[v].x = positions[v].x;
+				pVerts[v].y = positions[v].y;
+				pVerts[v].s = texcoords[v].x;
+				pVerts[v].t = texcoords[v].y;
+				pVerts[v].color = c;
+			}
+
+			pVerts += 4;
+		}
+
+		buffer->unmap();
+		gpu->slotVerticesValid = true;
+	}
+
+	Shader *prevshader = Shader::current;
+
+	shader->attach();
+	shader->checkMainTexture(texture);
+
+	sendShaderTexture(shader, "love_ParticleState", gpu->state[gpu->current][0]);
+	sendShaderTexture(shader, "love_ParticleLife", gpu->state[gpu->current][1]);
+	sendShaderTexture(shader, "love_ParticleForces", gpu->data[GPU_DATA_FORCES]);
+	sendShaderTexture(shader, "love_ParticleSizeVariation", gpu->data[GPU_DATA_SIZE_VARIATION]);
+
+	float statesize[2] = {(float) gpu->width, (float) gpu->height};
+	float poffset[2] = {offset.x, offset.y};
+	float sizecount = (float) sizes.size();
+	float colorcount = (float) colors.size();
+	float relative = relativeRotation ? 1.0f : 0.0f;
+
+	sendShaderFloats(shader, "love_ParticleStateSize", statesize, 1);
+	sendShaderFloats(shader, "love_ParticleOffset", poffset, 1);
+	sendShaderFloats(shader, "love_ParticleSizes", sizes.data(), (int) sizes.size());
+	sendShaderFloats(shader, "love_ParticleSizeCount", &sizecount, 1);
+	sendShaderFloats(shader, "love_ParticleColors", &colors[0].r, (int) colors.size());
+	sendShaderFloats(shader, "love_ParticleColorCount", &colorcount, 1);
+	sendShaderFloats(shader, "love_ParticleRelativeRotation", &relative, 1);
+
+	{
+		Graphics::TempTransform transform(gfx, m);
+
+		vertex::BufferBindings vertexbuffers;
+		vertexbuffers.set(0, buffer, 0);
+
+		gfx->drawQuads(0, (int) gpu->slotCount, vertexAttributes, vertexbuffers, texture);
+	}
+
+	if (prevshader != nullptr && prevshader != shader)
+		prevshader->attach();
+}
+
 bool ParticleSystem::getConstant(const char *in, AreaSpreadDistribution &out)
 {
 	return distributions.find(in, out);
@@ -1116,6 +1753,21 @@ std::vector<std::string> ParticleSystem::getConstants(InsertMode)
 	return insertModes.getNames();
 }
 
+bool ParticleSystem::getConstant(const char *in, SimulationMode &out)
+{
+	return simulationModes.find(in, out);
+}
+
+bool ParticleSystem::getConstant(SimulationMode in, const char *&out)
+{
+	return simulationModes.find(in, out);
+}
+
+std::vector<std::string> ParticleSystem::getConstants(SimulationMode)
+{
+	return simulationModes.getNames();
+}
+
 StringMap<ParticleSystem::AreaSpreadDistribution, ParticleSystem::DISTRIBUTION_MAX_ENUM>::Entry ParticleSystem::distributionsEntries[] =
 {
 	{ "none",    DISTRIBUTION_NONE },
@@ -1137,5 +1789,13 @@ StringMap<ParticleSystem::InsertMode, ParticleSystem::INSERT_MODE_MAX_ENUM>::Ent
 
 StringMap<ParticleSystem::InsertMode, ParticleSystem::INSERT_MODE_MAX_ENUM> ParticleSystem::insertModes(ParticleSystem::insertModesEntries, sizeof(ParticleSystem::insertModesEntries));
 
+StringMap<ParticleSystem::SimulationMode, ParticleSystem::SIMULATION_MAX_ENUM>::Entry ParticleSystem::simulationModesEntries[] =
+{
+	{ "cpu", SIMULATION_CPU },
+	{ "gpu", SIMULATION_GPU },
+};
+
+StringMap<ParticleSystem::SimulationMode, ParticleSystem::SIMULATION_MAX_ENUM> ParticleSystem::simulationModes(ParticleSystem::simulationModesEntries, sizeof(ParticleSystem::simulationModesEntries));
+
 } // graphics
 } // love
@@ -29,9 +29,15 @@
 #include "Drawable.h"
 #include "Quad.h"
 #include "Texture.h"
+#include "Canvas.h"
+#include "Image.h"
 #include "Buffer.h"
+#include "math/RandomGenerator.h"
 
 // STL
+#include <functional>
+#include <queue>
+#include <utility>
 #include <vector>
 
 namespace love
@@ -76,6 +82,16 @@ class ParticleSystem : public Drawable
 		INSERT_MODE_MAX_ENUM
 	};
 
+	/**
+	 * Where particles are simulated: on the CPU, or on the GPU using shaders.
+	 */
+	enum SimulationMode
+	{
+		SIMULATION_CPU,
+		SIMULATION_GPU,
+		SIMULATION_MAX_ENUM
+	};
+
 	/**
 	 * Maximum numbers of particles in a ParticleSystem.
 	 * This limit comes from the fact that a quad requires four vertices and the
@@ -135,6 +151,22 @@ class ParticleSystem : public Drawable
 	 */
 	InsertMode getInsertMode() const;
 
+	/**
+	 * Sets where particles are simulated. In GPU mode the CPU only keeps track
+	 * of emission and particle lifetimes, and particles are always drawn in
+	 * the same order, with the whole texture (Quads and the insert mode are
+	 * ignored.) A custom shader can't be used to draw them either.
+	 * Changing the mode removes all existing particles.
+	 * @param mode The new simulation mode.
+	 **/
+	void setSimulationMode(SimulationMode mode);
+	SimulationMode getSimulationMode() const;
+
+	/**
+	 * Returns whether GPU particle simulation is supported on this system.
+	 **/
+	static bool isGPUSimulationSupported();
+
 	/**
 	 * Sets the emission rate.
 	 * @param rate The amount of particles per second.
@@ -510,6 +542,15 @@ class ParticleSystem : public Drawable
 	 **/
 	void update(float dt);
 
+	/**
+	 * Updates several particle systems at once, spreading the updates and the
+	 * generation of their vertices for the next draw across worker threads.
+	 * The results are the same as updating each system in turn.
+	 * @param systems The particle systems to update. Each may only be listed once.
+	 * @param dt Time since last update.
+	 **/
+	static void updateMultiple(const std::vector<ParticleSystem *> &systems, float dt);
+
 	// Implements Drawable.
 	void draw(Graphics *gfx, const Matrix4 &m) override;
 
@@ -521,68 +562,142 @@ class ParticleSystem : public Drawable
 	static bool getConstant(InsertMode in, const char *&out);
 	static std::vector<std::string> getConstants(InsertMode);
 
+	static bool getConstant(const char *in, SimulationMode &out);
+	static bool getConstant(SimulationMode in, const char *&out);
+	static std::vector<std::string> getConstants(SimulationMode);
+
 private:
 
-	// Represents a single particle.
-	struct Particle
+	// Per-particle attributes. Each one is stored in its own tightly packed
+	// array inside pMem, so update() and draw() only stream through the data
+	// they actually use.
+	enum ParticleAttribute
+	{
+		PARTICLE_LIFETIME,
+		PARTICLE_LIFE,
+		PARTICLE_POSITION_X,
+		PARTICLE_POSITION_Y,
+		PARTICLE_ORIGIN_X, // Particles gravitate towards this point.
+		PARTICLE_ORIGIN_Y,
+		PARTICLE_VELOCITY_X,
+		PARTICLE_VELOCITY_Y,
+		PARTICLE_LINEAR_ACCELERATION_X,
+		PARTICLE_LINEAR_ACCELERATION_Y,
+		PARTICLE_RADIAL_ACCELERATION,
+		PARTICLE_TANGENTIAL_ACCELERATION,
+		PARTICLE_LINEAR_DAMPING,
+		PARTICLE_SIZE,
+		PARTICLE_SIZE_OFFSET,
+		PARTICLE_SIZE_INTERVAL_SIZE,
+		PARTICLE_ROTATION, // Amount of rotation applied to the final angle.
+		PARTICLE_ANGLE,
+		PARTICLE_SPIN_START,
+		PARTICLE_SPIN_END,
+		PARTICLE_COLOR_R,
+		PARTICLE_COLOR_G,
+		PARTICLE_COLOR_B,
+		PARTICLE_COLOR_A,
+		PARTICLE_ATTRIBUTE_MAX_ENUM
+	};
+
+	void resetOffset();
+
+	void createBuffers(size_t size);
+	void deleteBuffers();
+
+	float *getParticleAttribute(ParticleAttribute attrib) const
 	{
-		Particle *prev;
-		Particle *next;
+		return pMem + (size_t) attrib * maxParticles;
+	}
+
+	void addParticle(float t);
 
-		float lifetime;
-		float life;
+	// Called by addParticle.
+	void initParticle(uint32 index, float t);
 
-		love::Vector2 position;
+	// Copies all attributes of one particle slot into another.
+	void moveParticle(uint32 dst, uint32 src);
 
-		// Particles gravitate towards this point.
-		love::Vector2 origin;
+	// Reverses the storage order of the active particles.
+	void reverseParticles();
 
-		love::Vector2 velocity;
-		love::Vector2 linearAcceleration;
-		float radialAcceleration;
-		float tangentialAcceleration;
+	// Integrates the motion and rotation of particles [0, count), 4 at a
+	// time when SIMD instructions are available.
+	void integrateParticles(uint32 count, float dt);
 
-		float linearDamping;
+	// Updates the angle, size and color of a particle after integration.
+	void updateParticleAppearance(uint32 index);
 
-		float size;
-		float sizeOffset;
-		float sizeIntervalSize;
+	// Removes dead particles and simulates the rest, in CPU simulation mode.
+	void updateCPU(float dt);
 
-		float rotation; // Amount of rotation applied to the final angle.
-		float angle;
-		float spinStart;
-		float spinEnd;
+	int getQuadIndex(uint32 index) const;
 
-		Colorf color;
+	void generateVertices(Vertex *vertices) const;
 
-		int quadIndex;
+	// Per-particle data written by the CPU when a particle is emitted in GPU
+	// simulation mode. Each is stored as an RGBA32F image with one pixel per
+	// particle slot. Must match the shaders in wrap_GraphicsShader.lua.
+	enum GPUParticleData
+	{
+		GPU_DATA_SPAWN, // Start position and velocity.
+		GPU_DATA_MOTION, // Origin and linear acceleration.
+		GPU_DATA_FORCES, // Radial and tangential acceleration, damping, lifetime.
+		GPU_DATA_SPIN, // Spin start and end, start rotation, spawn ID.
+		GPU_DATA_SIZE_VARIATION, // Size offset and interval size.
+		GPU_DATA_MAX_ENUM
 	};
 
-	void resetOffset();
+	struct GPUSimulation
+	{
+		int width = 0;
+		int height = 0;
 
-	void createBuffers(size_t size);
-	void deleteBuffers();
+		// Simulated state, ping-ponged every update: position and velocity,
+		// and life, rotation and spawn ID.
+		StrongRef<Canvas> state[2][2];
+		int current = 0;
 
-	void addParticle(float t);
-	Particle *removeParticle(Particle *p);
+		StrongRef<Image> data[GPU_DATA_MAX_ENUM];
+		std::vector<float> dataMemory[GPU_DATA_MAX_ENUM];
 
-	// Called by addParticle.
-	void initParticle(Particle *p, float t);
-	void insertTop(Particle *p);
-	void insertBottom(Particle *p);
-	void insertRandom(Particle *p);
+		// Slots whose data hasn't been uploaded yet.
+		std::vector<uint32> dirtySlots;
+
+		// Sum of all update deltas since the simulation was created. Slots
+		// are freed once it reaches their time of death.
+		double time = 0.0;
+
+		// Time of death and slot of each live particle, soonest first.
+		typedef std::pair<double, uint32> Death;
+		std::priority_queue<Death, std::vector<Death>, std::greater<Death>> deaths;
+		std::vector<uint32> freeSlots;
 
-	// Pointer to the beginning of the allocated memory.
-	Particle *pMem;
+		// Number of slots which have been used since the last reset.
+		uint32 slotCount = 0;
 
-	// Pointer to a free particle.
-	Particle *pFree;
+		// Lets the simulation shader know when a slot has been reused.
+		uint32 spawnID = 0;
+
+		// Single quad covering the used part of the state canvases.
+		Buffer *quadBuffer = nullptr;
+
+		// Whether buffer has the vertices for each slot.
+		bool slotVerticesValid = false;
+	};
 
-	// Pointer to the start of the linked list.
-	Particle *pHead;
+	void createGPUSimulation(size_t size);
+	void deleteGPUSimulation();
+	uint32 allocateGPUSlot();
+	void updateGPUSlots(float dt);
+	void uploadGPUData();
+	void simulateGPU(Graphics *gfx, float dt);
+	void drawGPU(Graphics *gfx, const Matrix4 &m);
 
-	// Pointer to the end of the linked list.
-	Particle *pTail;
+	// Memory for all particle attribute arrays. The active particles are
+	// always packed into indices [0, activeParticles) of each array, in draw
+	// order (or reverse draw order when inserting at the bottom.)
+	float *pMem;
 
 	// The texture to be drawn.
 	StrongRef<Texture> texture;
@@ -676,11 +791,26 @@ class ParticleSystem : public Drawable
 	const vertex::Attributes vertexAttributes;
 	Buffer *buffer;
 
+	// Whether updateMultiple has already generated the vertices for the next
+	// draw. Anything which changes them resets this.
+	bool verticesPrepared;
+
+	SimulationMode simulationMode;
+
+	// Only allocated in GPU simulation mode.
+	GPUSimulation *gpu;
+
+	// Each system has its own generator so updates can happen on any thread.
+	love::math::RandomGenerator rng;
+
 	static StringMap<AreaSpreadDistribution, DISTRIBUTION_MAX_ENUM>::Entry distributionsEntries[];
 	static StringMap<AreaSpreadDistribution, DISTRIBUTION_MAX_ENUM> distributions;
 
 	static StringMap<InsertMode, INSERT_MODE_MAX_ENUM>::Entry insertModesEntries[];
 	static StringMap<InsertMode, INSERT_MODE_MAX_ENUM> insertModes;
+
+	static StringMap<SimulationMode, SIMULATION_MAX_ENUM>::Entry simulationModesEntries[];
+	static StringMap<SimulationMode, SIMULATION_MAX_ENUM> simulationModes;
 };
 
 } // graphics
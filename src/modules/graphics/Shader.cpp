@@ -191,6 +191,7 @@ StringMap<Shader::BuiltinUniform, Shader::BUILTIN_MAX_ENUM>::Entry Shader::built
 	{ "love_VideoYChannel",  BUILTIN_TEXTURE_VIDEO_Y               },
 	{ "love_VideoCbChannel", BUILTIN_TEXTURE_VIDEO_CB              },
 	{ "love_VideoCrChannel", BUILTIN_TEXTURE_VIDEO_CR              },
+	{ "love_BatchTextures",  BUILTIN_TEXTURE_BATCH                 },
 	{ "ViewSpaceFromLocal",  BUILTIN_MATRIX_VIEW_FROM_LOCAL        },
 	{ "ClipSpaceFromView",   BUILTIN_MATRIX_CLIP_FROM_VIEW         },
 	{ "ClipSpaceFromLocal",  BUILTIN_MATRIX_CLIP_FROM_LOCAL        },
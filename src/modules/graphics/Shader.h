@@ -68,6 +68,7 @@ class Shader : public Object, public Resource
 		BUILTIN_TEXTURE_VIDEO_Y,
 		BUILTIN_TEXTURE_VIDEO_CB,
 		BUILTIN_TEXTURE_VIDEO_CR,
+		BUILTIN_TEXTURE_BATCH,
 		BUILTIN_MATRIX_VIEW_FROM_LOCAL,
 		BUILTIN_MATRIX_CLIP_FROM_VIEW,
 		BUILTIN_MATRIX_CLIP_FROM_LOCAL,
@@ -95,6 +96,11 @@ class Shader : public Object, public Resource
 		STANDARD_DEFAULT,
 		STANDARD_VIDEO,
 		STANDARD_ARRAY,
+		STANDARD_MULTITEXTURE,
+		STANDARD_PARTICLE_SIMULATION,
+		STANDARD_PARTICLE_DRAW,
+		STANDARD_SPRITE_INSTANCED,
+		STANDARD_DISTANCE_FIELD,
 		STANDARD_MAX_ENUM
 	};
 
@@ -182,6 +188,12 @@ class Shader : public Object, public Resource
 	 **/
 	virtual void setVideoTextures(Texture *ytexture, Texture *cbtexture, Texture *crtexture) = 0;
 
+	/**
+	 * Sets the textures used by the multi-texture standard shader, in addition
+	 * to the main texture.
+	 **/
+	virtual void setBatchTextures(Texture **textures, int count) = 0;
+
 	TextureType getMainTextureType() const;
 	void checkMainTextureType(TextureType textype, bool isDepthSampler) const;
 	void checkMainTexture(Texture *texture) const;
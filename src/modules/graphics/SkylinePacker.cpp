@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "SkylinePacker.h"
+
+// C++
+#include <algorithm>
+#include <limits>
+
+namespace love
+{
+namespace graphics
+{
+
+SkylinePacker::SkylinePacker(int width, int height)
+{
+	reset(width, height);
+}
+
+void SkylinePacker::reset(int width, int height)
+{
+	this->width = width;
+	this->height = height;
+
+	usedArea = 0;
+
+	skyline.clear();
+	skyline.push_back({0, 0, width});
+}
+
+bool SkylinePacker::fits(size_t index, int w, int h, int &y) const
+{
+	int x = skyline[index].x;
+	if (x + w > width)
+		return false;
+
+	// The rectangle rests on the highest node it spans.
+	int widthleft = w;
+	y = skyline[index].y;
+
+	while (widthleft > 0)
+	{
+		y = std::max(y, skyline[index].y);
+		if (y + h > height)
+			return false;
+
+		widthleft -= skyline[index].width;
+		index++;
+	}
+
+	return true;
+}
+
+void SkylinePacker::addLevel(size_t index, int x, int y, int w, int h)
+{
+	Node node = {x, y + h, w};
+	skyline.insert(skyline.begin() + index, node);
+
+	// Shrink or remove the nodes which are now covered by the new one.
+	for (size_t i = index + 1; i < skyline.size(); i++)
+	{
+		Node &prev = skyline[i - 1];
+		Node &cur = skyline[i];
+
+		if (cur.x >= prev.x + prev.width)
+			break;
+
+		int shrink = prev.x + prev.width - cur.x;
+
+		cur.x += shrink;
+		cur.width -= shrink;
+
+		if (cur.width > 0)
+			break;
+
+		skyline.erase(skyline.begin() + i);
+		i--;
+	}
+
+	// Merge neighbouring nodes at the same height.
+	for (size_t i = 0; i + 1 < skyline.size(); i++)
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+			i--;
+		}
+	}
+}
+
+bool SkylinePacker::pack(int w, int h, int &x, int &y)
+{
+	if (w <= 0 || h <= 0)
+		return false;
+
+	int besttop = std::numeric_limits<int>::max();
+	int bestwidth = std::numeric_limits<int>::max();
+	size_t bestindex = skyline.size();
+
+	// Bottom-left: prefer the position where the rectangle's top edge ends up
+	// lowest, then the narrowest node to keep wide gaps available.
+	for (size_t i = 0; i < skyline.size(); i++)
+	{
+		int nodey = 0;
+		if (!fits(i, w, h, nodey))
+			continue;
+
+		int top = nodey + h;
+
+		if (top < besttop || (top == besttop && skyline[i].width < bestwidth))
+		{
+			besttop = top;
+			bestwidth = skyline[i].width;
+			bestindex = i;
+			x = skyline[i].x;
+			y = nodey;
+		}
+	}
+
+	if (bestindex == skyline.size())
+		return false;
+
+	addLevel(bestindex, x, y, w, h);
+	usedArea += (int64) w * h;
+
+	return true;
+}
+
+int SkylinePacker::getWidth() const
+{
+	return width;
+}
+
+int SkylinePacker::getHeight() const
+{
+	return height;
+}
+
+int64 SkylinePacker::getUsedArea() const
+{
+	return usedArea;
+}
+
+} // graphics
+} // love
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "common/int.h"
+
+// C
+#include <stddef.h>
+
+// C++
+#include <vector>
+
+namespace love
+{
+namespace graphics
+{
+
+/**
+ * Packs rectangles into a fixed-size area using the skyline bottom-left
+ * heuristic. The packer only tracks the top edge of the packed area, so
+ * individual rectangles can't be removed again: to reclaim space, reset it
+ * and pack the remaining rectangles again.
+ **/
+class SkylinePacker
+{
+public:
+
+	SkylinePacker(int width, int height);
+
+	void reset(int width, int height);
+
+	/**
+	 * Finds a place for a rectangle of the given size and marks it as used.
+	 * Returns false if there isn't enough space left.
+	 **/
+	bool pack(int w, int h, int &x, int &y);
+
+	int getWidth() const;
+	int getHeight() const;
+
+	/**
+	 * Gets the total area of all packed rectangles.
+	 **/
+	int64 getUsedArea() const;
+
+private:
+
+	struct Node
+	{
+		int x;
+		int y;
+		int width;
+	};
+
+	bool fits(size_t index, int w, int h, int &y) const;
+	void addLevel(size_t index, int x, int y, int w, int h);
+
+	std::vector<Node> skyline;
+
+	int width;
+	int height;
+
+	int64 usedArea;
+
+}; // SkylinePacker
+
+} // graphics
+} // love
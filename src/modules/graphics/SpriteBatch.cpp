@@ -40,13 +40,15 @@ namespace graphics
 
 love::Type SpriteBatch::type("SpriteBatch", &Drawable::type);
 
-SpriteBatch::SpriteBatch(Graphics *gfx, Texture *texture, int size, vertex::Usage usage)
+SpriteBatch::SpriteBatch(Graphics *gfx, Texture *texture, int size, vertex::Usage usage, bool instanced)
 	: texture(texture)
 	, size(size)
 	, next(0)
 	, color(255, 255, 255, 255)
 	, color_active(false)
+	, instanced(instanced)
 	, array_buf(nullptr)
+	, quad_buf(nullptr)
 	, range_start(-1)
 	, range_count(-1)
 {
@@ -62,14 +64,40 @@ SpriteBatch::SpriteBatch(Graphics *gfx, Texture *texture, int size, vertex::Usag
 		vertex_format = vertex::CommonFormat::XYf_STf_RGBAub;
 
 	vertex_stride = vertex::getFormatStride(vertex_format);
+	sprite_size = vertex_stride * 4;
 
-	size_t vertex_size = vertex_stride * 4 * size;
-	array_buf = gfx->newBuffer(vertex_size, nullptr, BUFFER_VERTEX, usage, Buffer::MAP_EXPLICIT_RANGE_MODIFY);
+	if (instanced)
+	{
+		if (!gfx->getCapabilities().features[Graphics::FEATURE_INSTANCING] || !Shader::standardShaders[Shader::STANDARD_SPRITE_INSTANCED])
+			throw love::Exception("Instanced SpriteBatches are not supported on this system.");
+
+		if (texture->getTextureType() != TEXTURE_2D)
+			throw love::Exception("Instanced SpriteBatches can only use 2D textures.");
+
+		sprite_size = sizeof(Instance);
+
+		// Corners of the unit quad, in triangle strip order.
+		const float corners[] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+		quad_buf = gfx->newBuffer(sizeof(corners), corners, BUFFER_VERTEX, vertex::USAGE_STATIC, 0);
+	}
+
+	size_t vertex_size = sprite_size * size;
+
+	try
+	{
+		array_buf = gfx->newBuffer(vertex_size, nullptr, BUFFER_VERTEX, usage, Buffer::MAP_EXPLICIT_RANGE_MODIFY);
+	}
+	catch (love::Exception &)
+	{
+		delete quad_buf;
+		throw;
+	}
 }
 
 SpriteBatch::~SpriteBatch()
 {
 	delete array_buf;
+	delete quad_buf;
 }
 
 int SpriteBatch::add(const Matrix4 &m, int index /*= -1*/)
@@ -90,6 +118,12 @@ int SpriteBatch::add(Quad *quad, const Matrix4 &m, int index /*= -1*/)
 	if (index == -1 && next >= size)
 		setBufferSize(size * 2);
 
+	if (instanced)
+	{
+		setInstance(index == -1 ? next : index, quad, m);
+		return index == -1 ? next++ : index;
+	}
+
 	const Vector2 *quadpositions = quad->getVertexPositions();
 	const Vector2 *quadtexcoords = quad->getVertexTexCoords();
 
@@ -162,6 +196,38 @@ int SpriteBatch::addLayer(int layer, Quad *quad, const Matrix4 &m, int index)
 	return index;
 }
 
+void SpriteBatch::setInstance(int index, Quad *quad, const Matrix4 &m)
+{
+	const Vector2 *quadpositions = quad->getVertexPositions();
+	const Vector2 *quadtexcoords = quad->getVertexTexCoords();
+
+	// Quad vertices 0 and 3 are opposite corners.
+	Vector2 qmin = quadpositions[0];
+	Vector2 qsize = quadpositions[3] - quadpositions[0];
+
+	const float *e = m.getElements();
+
+	size_t offset = index * sprite_size;
+	Instance *inst = (Instance *) ((uint8 *) array_buf->map() + offset);
+
+	inst->transformX[0] = e[0] * qsize.x;
+	inst->transformX[1] = e[4] * qsize.y;
+	inst->transformX[2] = e[0] * qmin.x + e[4] * qmin.y + e[12];
+
+	inst->transformY[0] = e[1] * qsize.x;
+	inst->transformY[1] = e[5] * qsize.y;
+	inst->transformY[2] = e[1] * qmin.x + e[5] * qmin.y + e[13];
+
+	inst->texRect[0] = quadtexcoords[0].x;
+	inst->texRect[1] = quadtexcoords[0].y;
+	inst->texRect[2] = quadtexcoords[3].x;
+	inst->texRect[3] = quadtexcoords[3].y;
+
+	inst->color = color;
+
+	array_buf->setMappedRangeModified(offset, sprite_size);
+}
+
 void SpriteBatch::clear()
 {
 	// Reset the position of the next index.
@@ -224,7 +290,7 @@ void SpriteBatch::setBufferSize(int newsize)
 	if (newsize == size)
 		return;
 
-	size_t vertex_size = vertex_stride * 4 * newsize;
+	size_t vertex_size = sprite_size * newsize;
 	love::graphics::Buffer *new_array_buf = nullptr;
 
 	int new_next = std::min(next, newsize);
@@ -235,7 +301,7 @@ void SpriteBatch::setBufferSize(int newsize)
 		new_array_buf = gfx->newBuffer(vertex_size, nullptr, array_buf->getType(), array_buf->getUsage(), array_buf->getMapFlags());
 
 		// Copy as much of the old data into the new GLBuffer as can fit.
-		size_t copy_size = vertex_stride * 4 * new_next;
+		size_t copy_size = sprite_size * new_next;
 		array_buf->copyTo(0, copy_size, new_array_buf, 0);
 	}
 	catch (love::Exception &)
@@ -263,6 +329,9 @@ void SpriteBatch::attachAttribute(const std::string &name, Mesh *mesh)
 	AttachedAttribute oldattrib = {};
 	AttachedAttribute newattrib = {};
 
+	if (instanced)
+		throw love::Exception("Vertex attributes cannot be attached to an instanced SpriteBatch.");
+
 	if (mesh->getVertexCount() < (size_t) next * 4)
 		throw love::Exception("Mesh has too few vertices to be attached to this SpriteBatch (at least %d vertices are required)", next*4);
 
@@ -304,6 +373,11 @@ bool SpriteBatch::getDrawRange(int &start, int &count) const
 	return true;
 }
 
+bool SpriteBatch::isInstanced() const
+{
+	return instanced;
+}
+
 void SpriteBatch::draw(Graphics *gfx, const Matrix4 &m)
 {
 	using namespace vertex;
@@ -313,6 +387,21 @@ void SpriteBatch::draw(Graphics *gfx, const Matrix4 &m)
 
 	gfx->flushStreamDraws();
 
+	int start = std::min(std::max(0, range_start), next - 1);
+
+	int count = next;
+	if (range_count > 0)
+		count = std::min(count, range_count);
+
+	count = std::min(count, next - start);
+
+	if (instanced)
+	{
+		if (count > 0)
+			drawInstances(gfx, m, start, count);
+		return;
+	}
+
 	if (texture.get())
 	{
 		if (Shader::isDefaultActive())
@@ -385,16 +474,68 @@ void SpriteBatch::draw(Graphics *gfx, const Matrix4 &m)
 
 	Graphics::TempTransform transform(gfx, m);
 
-	int start = std::min(std::max(0, range_start), next - 1);
+	if (count > 0)
+		gfx->drawQuads(start, count, attributes, buffers, texture);
+}
 
-	int count = next;
-	if (range_count > 0)
-		count = std::min(count, range_count);
+void SpriteBatch::drawInstances(Graphics *gfx, const Matrix4 &m, int start, int count)
+{
+	using namespace vertex;
 
-	count = std::min(count, next - start);
+	// The instanced shader builds each sprite's vertices itself, so it's used
+	// in place of the active shader. Custom shaders can't do that.
+	if (!Shader::isDefaultActive())
+		throw love::Exception("Instanced SpriteBatches cannot be drawn with a custom shader active.");
 
-	if (count > 0)
-		gfx->drawQuads(start, count, attributes, buffers, texture);
+	Shader *shader = Shader::standardShaders[Shader::STANDARD_SPRITE_INSTANCED];
+	if (shader == nullptr)
+		throw love::Exception("Instanced SpriteBatches are not supported on this system.");
+
+	int xindex = shader->getVertexAttributeIndex("love_SpriteTransformX");
+	int yindex = shader->getVertexAttributeIndex("love_SpriteTransformY");
+
+	if (xindex < 0 || yindex < 0)
+		throw love::Exception("The instanced SpriteBatch shader is missing its sprite transform attributes.");
+
+	// Make sure the buffer isn't mapped when we draw (sends data to GPU if needed.)
+	array_buf->unmap();
+
+	Attributes attributes;
+	BufferBindings buffers;
+
+	attributes.set(ATTRIB_POS, DATA_FLOAT, 2, 0, 0);
+	attributes.setBufferLayout(0, sizeof(float) * 2);
+	buffers.set(0, quad_buf, 0);
+
+	attributes.set(xindex, DATA_FLOAT, 3, (uint16) offsetof(Instance, transformX), 1);
+	attributes.set(yindex, DATA_FLOAT, 3, (uint16) offsetof(Instance, transformY), 1);
+	attributes.set(ATTRIB_TEXCOORD, DATA_FLOAT, 4, (uint16) offsetof(Instance, texRect), 1);
+
+	if (color_active)
+		attributes.set(ATTRIB_COLOR, DATA_UNORM8, 4, (uint16) offsetof(Instance, color), 1);
+
+	attributes.setBufferLayout(1, (uint16) sprite_size, STEP_PER_INSTANCE);
+	buffers.set(1, array_buf, start * sprite_size);
+
+	Shader *prevshader = Shader::current;
+
+	shader->attach();
+	shader->checkMainTexture(texture);
+
+	{
+		Graphics::TempTransform transform(gfx, m);
+
+		Graphics::DrawCommand cmd(&attributes, &buffers);
+		cmd.primitiveType = PRIMITIVE_TRIANGLE_STRIP;
+		cmd.vertexStart = 0;
+		cmd.vertexCount = 4;
+		cmd.instanceCount = count;
+		cmd.texture = texture;
+		gfx->draw(cmd);
+	}
+
+	if (prevshader != nullptr && prevshader != shader)
+		prevshader->attach();
 }
 
 } // graphics
@@ -51,7 +51,7 @@ class SpriteBatch : public Drawable
 
 	static love::Type type;
 
-	SpriteBatch(Graphics *gfx, Texture *texture, int size, vertex::Usage usage);
+	SpriteBatch(Graphics *gfx, Texture *texture, int size, vertex::Usage usage, bool instanced = false);
 	virtual ~SpriteBatch();
 
 	int add(const Matrix4 &m, int index = -1);
@@ -106,6 +106,12 @@ class SpriteBatch : public Drawable
 	void setDrawRange();
 	bool getDrawRange(int &start, int &count) const;
 
+	/**
+	 * Whether each sprite is stored as a single per-instance record which is
+	 * expanded into a quad on the GPU, instead of as 4 transformed vertices.
+	 **/
+	bool isInstanced() const;
+
 	// Implements Drawable.
 	void draw(Graphics *gfx, const Matrix4 &m) override;
 
@@ -117,6 +123,19 @@ class SpriteBatch : public Drawable
 		int index;
 	};
 
+	// Per-sprite data used by instanced SpriteBatches. The quad's size is
+	// folded into the transform, which maps the unit quad to the sprite.
+	struct Instance
+	{
+		float transformX[3];
+		float transformY[3];
+		float texRect[4];
+		Color32 color;
+	};
+
+	void setInstance(int index, Quad *quad, const Matrix4 &m);
+	void drawInstances(Graphics *gfx, const Matrix4 &m, int start, int count);
+
 	/**
 	 * Sets the total number of sprites this SpriteBatch can hold.
 	 * Leaves existing sprite data intact when possible.
@@ -138,9 +157,17 @@ class SpriteBatch : public Drawable
 
 	vertex::CommonFormat vertex_format;
 	size_t vertex_stride;
+
+	// The size in bytes of a single sprite's data.
+	size_t sprite_size;
+
+	bool instanced;
 	
 	love::graphics::Buffer *array_buf;
 
+	// The unit quad drawn for every sprite in instanced mode.
+	love::graphics::Buffer *quad_buf;
+
 	std::unordered_map<std::string, AttachedAttribute> attached_attributes;
 	
 	int range_start;
@@ -30,8 +30,16 @@ StreamBuffer::StreamBuffer(BufferType mode, size_t size)
 	: bufferSize(size)
 	, frameGPUReadOffset(0)
 	, mode(mode)
+	, wrapCount(0)
+	, stallTime(0.0)
 {
 }
 
+void StreamBuffer::resetStats()
+{
+	wrapCount = 0;
+	stallTime = 0.0;
+}
+
 } // graphics
 } // love
@@ -54,7 +54,12 @@ class StreamBuffer : public Resource
 
 	size_t getSize() const { return bufferSize; }
 	BufferType getMode() const { return mode; }
-	size_t getUsableSize() const { return bufferSize - frameGPUReadOffset; }
+
+	/**
+	 * The largest amount of data a single map can return without the buffer
+	 * needing to be recreated.
+	 **/
+	virtual size_t getUsableSize() const { return bufferSize - frameGPUReadOffset; }
 
 	virtual MapInfo map(size_t minsize) = 0;
 	virtual size_t unmap(size_t usedsize) = 0;
@@ -62,6 +67,16 @@ class StreamBuffer : public Resource
 
 	virtual void nextFrame() {}
 
+	// Number of times the buffer's write position has wrapped back around to
+	// its start, since the last resetStats.
+	int getWrapCount() const { return wrapCount; }
+
+	// Seconds spent waiting for the GPU to finish using a part of the buffer,
+	// since the last resetStats.
+	double getStallTime() const { return stallTime; }
+
+	void resetStats();
+
 protected:
 
 	StreamBuffer(BufferType mode, size_t size);
@@ -70,6 +85,9 @@ class StreamBuffer : public Resource
 	size_t frameGPUReadOffset;
 	BufferType mode;
 
+	int wrapCount;
+	double stallTime;
+
 }; // StreamBuffer
 
 } // graphics
@@ -34,6 +34,7 @@ Text::Text(Font *font, const std::vector<Font::ColoredString> &text)
 	: font(font)
 	, vertexAttributes(Font::vertexFormat, 0)
 	, vertex_buffer(nullptr)
+	, paragraph_line_advance(0.0f)
 	, vert_offset(0)
 	, texture_cache_id((uint32) -1)
 {
@@ -45,22 +46,21 @@ Text::~Text()
 	delete vertex_buffer;
 }
 
-void Text::uploadVertices(const std::vector<Font::GlyphVertex> &vertices, size_t vertoffset)
+void Text::ensureVertexCapacity(size_t vertexcount)
 {
-	size_t offset = vertoffset * sizeof(Font::GlyphVertex);
-	size_t datasize = vertices.size() * sizeof(Font::GlyphVertex);
+	size_t datasize = vertexcount * sizeof(Font::GlyphVertex);
 
 	// If we haven't created a VBO or the vertices are too big, make a new one.
-	if (datasize > 0 && (!vertex_buffer || (offset + datasize) > vertex_buffer->getSize()))
+	if (datasize > 0 && (!vertex_buffer || datasize > vertex_buffer->getSize()))
 	{
 		// Make it bigger than necessary to reduce potential future allocations.
-		size_t newsize = size_t((offset + datasize) * 1.5);
+		size_t newsize = size_t(datasize * 1.5);
 
 		if (vertex_buffer != nullptr)
 			newsize = std::max(size_t(vertex_buffer->getSize() * 1.5), newsize);
 
 		auto gfx = Module::getInstance<Graphics>(Module::M_GRAPHICS);
-		Buffer *new_buffer = gfx->newBuffer(newsize, nullptr, BUFFER_VERTEX, vertex::USAGE_DYNAMIC, 0);
+		Buffer *new_buffer = gfx->newBuffer(newsize, nullptr, BUFFER_VERTEX, vertex::USAGE_DYNAMIC, Buffer::MAP_EXPLICIT_RANGE_MODIFY);
 
 		if (vertex_buffer != nullptr)
 			vertex_buffer->copyTo(0, vertex_buffer->getSize(), new_buffer, 0);
@@ -70,12 +70,23 @@ void Text::uploadVertices(const std::vector<Font::GlyphVertex> &vertices, size_t
 
 		vertexBuffers.set(0, vertex_buffer, 0);
 	}
+}
+
+void Text::uploadVertices(const std::vector<Font::GlyphVertex> &vertices, size_t vertoffset)
+{
+	size_t offset = vertoffset * sizeof(Font::GlyphVertex);
+	size_t datasize = vertices.size() * sizeof(Font::GlyphVertex);
+
+	ensureVertexCapacity(vertoffset + vertices.size());
 
 	if (vertex_buffer != nullptr && datasize > 0)
 	{
 		uint8 *bufferdata = (uint8 *) vertex_buffer->map();
 		memcpy(bufferdata + offset, &vertices[0], datasize);
+
 		// We unmap when we draw, to avoid unnecessary full map()/unmap() calls.
+		// Only the modified range is uploaded then.
+		vertex_buffer->setMappedRangeModified(offset, datasize);
 	}
 }
 
@@ -90,7 +101,12 @@ void Text::regenerateVertices()
 		clear();
 
 		for (const TextData &t : textdata)
-			addTextData(t);
+		{
+			if (t.append_vertices)
+				addTextData(t);
+			else
+				setText(t.codepoints, t.wrap, t.align);
+		}
 
 		texture_cache_id = font->getTextureCacheID();
 	}
@@ -120,6 +136,7 @@ void Text::addTextData(const TextData &t)
 		vert_offset = 0;
 		draw_commands.clear();
 		text_data.clear();
+		paragraphs.clear();
 	}
 
 	if (vertices.empty())
@@ -130,39 +147,298 @@ void Text::addTextData(const TextData &t)
 
 	uploadVertices(vertices, voffset);
 
-	if (!new_commands.empty())
-	{
-		// The start vertex should be adjusted to account for the vertex offset.
-		for (Font::DrawCommand &cmd : new_commands)
-			cmd.startvertex += (int) voffset;
+	// The start vertex should be adjusted to account for the vertex offset.
+	addDrawCommands(new_commands, voffset);
+
+	vert_offset = voffset + vertices.size();
+
+	text_data.push_back(t);
+	text_data.back().text_info = text_info;
+
+	// Font::generateVertices can invalidate the font's texture cache.
+	if (font->getTextureCacheID() != texture_cache_id)
+		regenerateVertices();
+}
 
-		auto firstcmd = new_commands.begin();
+void Text::addDrawCommands(const std::vector<Font::DrawCommand> &commands, size_t vertexoffset)
+{
+	for (const Font::DrawCommand &c : commands)
+	{
+		Font::DrawCommand cmd = c;
+		cmd.startvertex += (int) vertexoffset;
 
-		// If the first draw command in the new list has the same texture as the
-		// last one in the existing list we're building and its vertices are
-		// in-order, we can combine them (saving a draw call.)
+		// If the draw command has the same texture as the last one in the
+		// existing list we're building and its vertices are in-order, we can
+		// combine them (saving a draw call.)
 		if (!draw_commands.empty())
 		{
-			auto prevcmd = draw_commands.back();
-			if (prevcmd.texture == firstcmd->texture && (prevcmd.startvertex + prevcmd.vertexcount) == firstcmd->startvertex)
+			Font::DrawCommand &prevcmd = draw_commands.back();
+			if (prevcmd.texture == cmd.texture && (prevcmd.startvertex + prevcmd.vertexcount) == cmd.startvertex)
 			{
-				draw_commands.back().vertexcount += firstcmd->vertexcount;
-				++firstcmd;
+				prevcmd.vertexcount += cmd.vertexcount;
+				continue;
 			}
 		}
 
-		// Append the new draw commands to the list we're building.
-		draw_commands.insert(draw_commands.end(), firstcmd, new_commands.end());
+		draw_commands.push_back(cmd);
 	}
+}
 
-	vert_offset = voffset + vertices.size();
+void Text::splitParagraphs(const Font::ColoredCodepoints &codepoints, std::vector<Paragraph> &paragraphs)
+{
+	const std::vector<uint32> &cps = codepoints.cps;
+	const std::vector<Font::IndexedColor> &colors = codepoints.colors;
 
-	text_data.push_back(t);
-	text_data.back().text_info = text_info;
+	size_t colori = 0;
+	bool hascolor = false;
+	Colorf curcolor(1.0f, 1.0f, 1.0f, 1.0f);
 
-	// Font::generateVertices can invalidate the font's texture cache.
+	size_t start = 0;
+
+	while (start < cps.size())
+	{
+		size_t end = std::find(cps.begin() + start, cps.end(), (uint32) '\n') - cps.begin();
+		end = std::min(end + 1, cps.size()); // Include the newline.
+
+		Paragraph p = {};
+
+		// The paragraph starts with whichever color was set last.
+		while (colori < colors.size() && colors[colori].index <= (int) start)
+		{
+			curcolor = colors[colori].color;
+			hascolor = true;
+			colori++;
+		}
+
+		if (hascolor)
+			p.codepoints.colors.push_back({curcolor, 0});
+
+		for (size_t i = colori; i < colors.size() && colors[i].index < (int) end; i++)
+			p.codepoints.colors.push_back({colors[i].color, colors[i].index - (int) start});
+
+		p.codepoints.cps.assign(cps.begin() + start, cps.begin() + end);
+
+		paragraphs.push_back(p);
+		start = end;
+	}
+}
+
+bool Text::isSameParagraph(const Paragraph &a, const Paragraph &b)
+{
+	if (a.codepoints.cps != b.codepoints.cps || a.codepoints.colors.size() != b.codepoints.colors.size())
+		return false;
+
+	for (size_t i = 0; i < a.codepoints.colors.size(); i++)
+	{
+		const Font::IndexedColor &ca = a.codepoints.colors[i];
+		const Font::IndexedColor &cb = b.codepoints.colors[i];
+
+		if (ca.index != cb.index || ca.color != cb.color)
+			return false;
+	}
+
+	return true;
+}
+
+void Text::layoutParagraph(Paragraph &p, float wrap, Font::AlignMode align, std::vector<Font::GlyphVertex> &vertices)
+{
+	Colorf constantcolor = Colorf(1.0f, 1.0f, 1.0f, 1.0f);
+	size_t start = vertices.size();
+
+	// We only have formatted text if the align mode is valid.
+	if (align == Font::ALIGN_MAX_ENUM)
+	{
+		float lineadvance = floorf(font->getHeight() * font->getLineHeight() + 0.5f);
+		Vector2 offset(0.0f, p.firstLine * lineadvance);
+
+		p.commands = font->generateVertices(p.codepoints, constantcolor, vertices, 0.0f, offset, &p.info);
+		p.lineCount = 1;
+	}
+	else
+	{
+		p.commands = font->generateVerticesFormatted(p.codepoints, constantcolor, wrap, align, vertices, &p.info, p.firstLine);
+		p.lineCount = p.info.lines;
+	}
+
+	for (Font::DrawCommand &cmd : p.commands)
+		cmd.startvertex -= (int) start;
+
+	p.vertexCount = vertices.size() - start;
+}
+
+void Text::setText(const Font::ColoredCodepoints &codepoints, float wrap, Font::AlignMode align)
+{
+	bool hasset = !text_data.empty() && !text_data[0].append_vertices;
+
+	// Text added with add/addf after the set text.
+	std::vector<TextData> addeddata(text_data.begin() + (hasset ? 1 : 0), text_data.end());
+
+	std::vector<Paragraph> newparagraphs;
+	splitParagraphs(codepoints, newparagraphs);
+
+	float lineadvance = font->getHeight() * font->getLineHeight();
+
+	// Existing paragraphs can be kept if they were laid out the same way, and
+	// the glyphs' texture coordinates haven't changed since.
+	bool reuse = hasset && text_data[0].wrap == wrap && text_data[0].align == align
+		&& texture_cache_id == font->getTextureCacheID() && paragraph_line_advance == lineadvance;
+
+	if (!reuse)
+	{
+		paragraphs.clear();
+		texture_cache_id = font->getTextureCacheID();
+		paragraph_line_advance = lineadvance;
+	}
+
+	size_t oldvertexcount = 0;
+	if (!paragraphs.empty())
+		oldvertexcount = paragraphs.back().vertexStart + paragraphs.back().vertexCount;
+
+	size_t prefix = 0;
+	size_t suffix = 0;
+	size_t common = std::min(paragraphs.size(), newparagraphs.size());
+
+	while (prefix < common && isSameParagraph(paragraphs[prefix], newparagraphs[prefix]))
+		prefix++;
+
+	while (suffix < common - prefix && isSameParagraph(paragraphs[paragraphs.size() - 1 - suffix], newparagraphs[newparagraphs.size() - 1 - suffix]))
+		suffix++;
+
+	int line = 0;
+	size_t vertexstart = 0;
+
+	if (prefix > 0)
+	{
+		line = paragraphs[prefix - 1].firstLine + paragraphs[prefix - 1].lineCount;
+		vertexstart = paragraphs[prefix - 1].vertexStart + paragraphs[prefix - 1].vertexCount;
+	}
+
+	// Lay out the paragraphs which changed.
+	std::vector<Font::GlyphVertex> vertices;
+	size_t changedend = newparagraphs.size() - suffix;
+
+	for (size_t i = prefix; i < changedend; i++)
+	{
+		Paragraph &p = newparagraphs[i];
+		p.firstLine = line;
+		p.vertexStart = vertexstart + vertices.size();
+		layoutParagraph(p, wrap, align, vertices);
+		line += p.lineCount;
+	}
+
+	size_t oldsuffixstart = oldvertexcount;
+	int linedelta = 0;
+
+	if (suffix > 0)
+	{
+		const Paragraph &first = paragraphs[paragraphs.size() - suffix];
+		oldsuffixstart = first.vertexStart;
+		linedelta = line - first.firstLine;
+	}
+
+	// Lines of formatted text are placed at fractional multiples of the line
+	// height which are then rounded, so moving them isn't always exact.
+	if (align == Font::ALIGN_MAX_ENUM)
+		lineadvance = floorf(lineadvance + 0.5f);
+
+	if (linedelta != 0 && lineadvance != floorf(lineadvance))
+	{
+		for (size_t i = changedend; i < newparagraphs.size(); i++)
+		{
+			Paragraph &p = newparagraphs[i];
+			p.firstLine = line;
+			p.vertexStart = vertexstart + vertices.size();
+			layoutParagraph(p, wrap, align, vertices);
+			line += p.lineCount;
+		}
+
+		suffix = 0;
+		linedelta = 0;
+		oldsuffixstart = oldvertexcount;
+	}
+
+	// Glyphs added to the Font while laying out can invalidate the vertices we
+	// were going to keep.
 	if (font->getTextureCacheID() != texture_cache_id)
+	{
+		text_data.clear();
+		text_data.push_back({codepoints, wrap, align, {}, false, false, Matrix4()});
+		text_data.insert(text_data.end(), addeddata.begin(), addeddata.end());
+		paragraphs.clear();
 		regenerateVertices();
+		return;
+	}
+
+	size_t suffixvertexcount = oldvertexcount - oldsuffixstart;
+	size_t newsuffixstart = vertexstart + vertices.size();
+
+	ensureVertexCapacity(newsuffixstart + suffixvertexcount);
+
+	// Move the unchanged paragraphs after the changed ones into place. This
+	// has to happen before the changed vertices overwrite them.
+	if (vertex_buffer != nullptr && suffixvertexcount > 0 && (newsuffixstart != oldsuffixstart || linedelta != 0))
+	{
+		Font::GlyphVertex *bufferdata = (Font::GlyphVertex *) vertex_buffer->map();
+		Font::GlyphVertex *suffixdata = bufferdata + newsuffixstart;
+
+		memmove(suffixdata, bufferdata + oldsuffixstart, suffixvertexcount * sizeof(Font::GlyphVertex));
+
+		float dy = linedelta * lineadvance;
+		if (dy != 0.0f)
+		{
+			for (size_t i = 0; i < suffixvertexcount; i++)
+				suffixdata[i].y += dy;
+		}
+
+		vertex_buffer->setMappedRangeModified(newsuffixstart * sizeof(Font::GlyphVertex), suffixvertexcount * sizeof(Font::GlyphVertex));
+	}
+
+	uploadVertices(vertices, vertexstart);
+
+	for (size_t i = changedend; i < newparagraphs.size(); i++)
+	{
+		Paragraph &p = newparagraphs[i];
+		const Paragraph &old = paragraphs[paragraphs.size() - (newparagraphs.size() - i)];
+
+		p.info = old.info;
+		p.firstLine = old.firstLine + linedelta;
+		p.lineCount = old.lineCount;
+		p.vertexStart = old.vertexStart - oldsuffixstart + newsuffixstart;
+		p.vertexCount = old.vertexCount;
+		p.commands = old.commands;
+	}
+
+	for (size_t i = 0; i < prefix; i++)
+		newparagraphs[i] = std::move(paragraphs[i]);
+
+	paragraphs = std::move(newparagraphs);
+
+	TextData t = {codepoints, wrap, align, {0, 0, 0}, false, false, Matrix4()};
+
+	for (const Paragraph &p : paragraphs)
+	{
+		t.text_info.width = std::max(t.text_info.width, p.info.width);
+		t.text_info.lines += p.lineCount;
+	}
+
+	if (align != Font::ALIGN_MAX_ENUM)
+		t.text_info.height = (int) (t.text_info.lines * lineadvance);
+	else if (!paragraphs.empty())
+		t.text_info.height = (int) (paragraphs.back().firstLine * lineadvance) + paragraphs.back().info.height;
+
+	text_data.clear();
+	text_data.push_back(t);
+
+	draw_commands.clear();
+	for (const Paragraph &p : paragraphs)
+		addDrawCommands(p.commands, p.vertexStart);
+
+	vert_offset = newsuffixstart + suffixvertexcount;
+
+	// Text added after the set text has to be generated again at its new
+	// position in the vertex buffer.
+	for (const TextData &added : addeddata)
+		addTextData(added);
 }
 
 void Text::set(const std::vector<Font::ColoredString> &text)
@@ -178,7 +454,104 @@ void Text::set(const std::vector<Font::ColoredString> &text, float wrap, Font::A
 	Font::ColoredCodepoints codepoints;
 	Font::getCodepointsFromString(text, codepoints);
 
-	addTextData({codepoints, wrap, align, {}, false, false, Matrix4()});
+	// Text added with add/addf is replaced as well.
+	if (!text_data.empty() && !text_data[0].append_vertices)
+		text_data.resize(1);
+	else
+		text_data.clear();
+
+	setText(codepoints, wrap, align);
+}
+
+// Replaces a range of codepoints, keeping the colors of the text around it.
+static void spliceCodepoints(Font::ColoredCodepoints &dst, int start, int count, const Font::ColoredCodepoints &src)
+{
+	const Colorf white(1.0f, 1.0f, 1.0f, 1.0f);
+
+	int end = start + count;
+	int srcsize = (int) src.cps.size();
+	int delta = srcsize - count;
+
+	// The color in effect at the end of the replaced range.
+	bool hasendcolor = false;
+	Colorf endcolor = white;
+
+	std::vector<Font::IndexedColor> colors;
+
+	for (const Font::IndexedColor &c : dst.colors)
+	{
+		if (c.index <= end)
+		{
+			hasendcolor = true;
+			endcolor = c.color;
+		}
+
+		if (c.index < start)
+			colors.push_back(c);
+	}
+
+	for (const Font::IndexedColor &c : src.colors)
+		colors.push_back({c.color, c.index + start});
+
+	// Text without colors is white, like it would be if it was set directly.
+	if (src.colors.empty() && srcsize > 0 && !dst.colors.empty())
+		colors.push_back({white, start});
+
+	bool hasexisting = false;
+	for (const Font::IndexedColor &c : dst.colors)
+		hasexisting = hasexisting || c.index == end;
+
+	if (end < (int) dst.cps.size() && !hasexisting && (hasendcolor || !src.colors.empty()))
+	{
+		// Don't leave two colors at the same position.
+		if (!colors.empty() && colors.back().index == start + srcsize)
+			colors.pop_back();
+
+		colors.push_back({endcolor, start + srcsize});
+	}
+
+	for (const Font::IndexedColor &c : dst.colors)
+	{
+		if (c.index >= end && (c.index > end || end < (int) dst.cps.size()))
+			colors.push_back({c.color, c.index + delta});
+	}
+
+	dst.cps.erase(dst.cps.begin() + start, dst.cps.begin() + end);
+	dst.cps.insert(dst.cps.begin() + start, src.cps.begin(), src.cps.end());
+	dst.colors = colors;
+}
+
+void Text::append(const std::vector<Font::ColoredString> &text)
+{
+	int size = 0;
+	if (!text_data.empty() && !text_data[0].append_vertices)
+		size = (int) text_data[0].codepoints.cps.size();
+
+	replace(size, 0, text);
+}
+
+void Text::replace(int start, int count, const std::vector<Font::ColoredString> &text)
+{
+	Font::ColoredCodepoints codepoints;
+	float wrap = -1.0f;
+	Font::AlignMode align = Font::ALIGN_MAX_ENUM;
+
+	if (!text_data.empty() && !text_data[0].append_vertices)
+	{
+		codepoints = text_data[0].codepoints;
+		wrap = text_data[0].wrap;
+		align = text_data[0].align;
+	}
+
+	if (start < 0 || count < 0 || start + count > (int) codepoints.cps.size())
+		throw love::Exception("Invalid text range: %d characters starting at %d (text has %d characters.)", count, start + 1, (int) codepoints.cps.size());
+
+	Font::ColoredCodepoints newcodepoints;
+	Font::getCodepointsFromString(text, newcodepoints);
+
+	spliceCodepoints(codepoints, start, count, newcodepoints);
+
+	setText(codepoints, wrap, align);
 }
 
 int Text::add(const std::vector<Font::ColoredString> &text, const Matrix4 &m)
@@ -199,6 +572,7 @@ int Text::addf(const std::vector<Font::ColoredString> &text, float wrap, Font::A
 void Text::clear()
 {
 	text_data.clear();
+	paragraphs.clear();
 	draw_commands.clear();
 	texture_cache_id = font->getTextureCacheID();
 	vert_offset = 0;
@@ -249,11 +623,15 @@ void Text::draw(Graphics *gfx, const Matrix4 &m)
 	gfx->flushStreamDraws();
 
 	if (Shader::isDefaultActive())
-		Shader::attachDefault(Shader::STANDARD_DEFAULT);
+		Shader::attachDefault(font->getStandardShaderType());
 
 	if (Shader::current)
 		Shader::current->checkMainTextureType(TEXTURE_2D, false);
 
+	// Glyphs which finished loading in the background invalidate the Font's
+	// texture cache when they're added.
+	font->uploadLoadedGlyphs();
+
 	// Re-generate the text if the Font's texture cache was invalidated.
 	if (font->getTextureCacheID() != texture_cache_id)
 		regenerateVertices();
@@ -48,6 +48,20 @@ class Text : public Drawable
 	int add(const std::vector<Font::ColoredString> &text, const Matrix4 &m);
 	int addf(const std::vector<Font::ColoredString> &text, float wrap, Font::AlignMode align, const Matrix4 &m);
 
+	/**
+	 * Appends to the text given to set, with the same wrap limit and alignment.
+	 * Only the last paragraph (text ending in a newline) of the existing text
+	 * has to be laid out again.
+	 **/
+	void append(const std::vector<Font::ColoredString> &text);
+
+	/**
+	 * Replaces count codepoints of the text given to set, starting at the
+	 * (zero-based) start index. Only the paragraphs which change are laid out
+	 * again.
+	 **/
+	void replace(int start, int count, const std::vector<Font::ColoredString> &text);
+
 	void clear();
 
 	void setFont(Font *f);
@@ -79,10 +93,34 @@ class Text : public Drawable
 		Matrix4 matrix;
 	};
 
+	// A run of the text given to set, ending with a newline or the end of the
+	// text. Paragraphs are laid out independently, since wrapping, kerning and
+	// alignment don't carry over newlines.
+	struct Paragraph
+	{
+		Font::ColoredCodepoints codepoints;
+		Font::TextInfo info;
+		int firstLine;
+		int lineCount;
+		size_t vertexStart;
+		size_t vertexCount;
+
+		// Relative to vertexStart.
+		std::vector<Font::DrawCommand> commands;
+	};
+
+	void ensureVertexCapacity(size_t vertexcount);
 	void uploadVertices(const std::vector<Font::GlyphVertex> &vertices, size_t vertoffset);
 	void regenerateVertices();
 	void addTextData(const TextData &s);
 
+	void setText(const Font::ColoredCodepoints &codepoints, float wrap, Font::AlignMode align);
+	void layoutParagraph(Paragraph &p, float wrap, Font::AlignMode align, std::vector<Font::GlyphVertex> &vertices);
+	void addDrawCommands(const std::vector<Font::DrawCommand> &commands, size_t vertexoffset);
+
+	static void splitParagraphs(const Font::ColoredCodepoints &codepoints, std::vector<Paragraph> &paragraphs);
+	static bool isSameParagraph(const Paragraph &a, const Paragraph &b);
+
 	StrongRef<Font> font;
 
 	vertex::Attributes vertexAttributes;
@@ -94,6 +132,12 @@ class Text : public Drawable
 
 	std::vector<TextData> text_data;
 
+	// Layout of the text given to set, which is always text_data[0].
+	std::vector<Paragraph> paragraphs;
+
+	// The font's height times its line height when paragraphs were laid out.
+	float paragraph_line_advance;
+
 	size_t vert_offset;
 	
 	// Used so we know when the font's texture cache is invalidated.
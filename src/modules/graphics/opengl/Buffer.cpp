@@ -161,6 +161,18 @@ void Buffer::setMappedRangeModified(size_t offset, size_t modifiedsize)
 	if (!is_mapped || !(map_flags & MAP_EXPLICIT_RANGE_MODIFY))
 		return;
 
+	if (modifiedsize == 0)
+		return;
+
+	// Nothing has been modified since map(), so the range starts here rather
+	// than at the start of the buffer.
+	if (modified_size == 0)
+	{
+		modified_offset = offset;
+		modified_size = modifiedsize;
+		return;
+	}
+
 	// We're being conservative right now by internally marking the whole range
 	// from the start of section a to the end of section b as modified if both
 	// a and b are marked as modified.
@@ -0,0 +1,195 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "GPUTimer.h"
+
+namespace love
+{
+namespace graphics
+{
+namespace opengl
+{
+
+GPUTimer::GPUTimer()
+	: frameIndex(0)
+	, passQuery(-1)
+{
+}
+
+bool GPUTimer::isSupported()
+{
+	return GLAD_VERSION_3_3 || GLAD_ARB_timer_query || GLAD_EXT_disjoint_timer_query;
+}
+
+GLuint GPUTimer::timestamp()
+{
+	GLuint query = 0;
+
+	if (!freeQueries.empty())
+	{
+		query = freeQueries.back();
+		freeQueries.pop_back();
+	}
+	else
+		glGenQueries(1, &query);
+
+	glQueryCounter(query, GL_TIMESTAMP);
+	frames[frameIndex].lastQuery = query;
+
+	return query;
+}
+
+void GPUTimer::beginPass(const char *name)
+{
+	endPass();
+
+	Frame &frame = frames[frameIndex];
+
+	Query query = {name, 0, timestamp(), 0};
+	frame.queries.push_back(query);
+
+	passQuery = (int) frame.queries.size() - 1;
+}
+
+void GPUTimer::endPass()
+{
+	if (passQuery < 0)
+		return;
+
+	frames[frameIndex].queries[passQuery].end = timestamp();
+	passQuery = -1;
+}
+
+void GPUTimer::pushRegion(const std::string &name)
+{
+	Frame &frame = frames[frameIndex];
+
+	Query query = {name, (int) regionStack.size() + 1, timestamp(), 0};
+	frame.queries.push_back(query);
+
+	regionStack.push_back((int) frame.queries.size() - 1);
+}
+
+void GPUTimer::popRegion()
+{
+	if (regionStack.empty())
+		throw love::Exception("No timer region to pop.");
+
+	frames[frameIndex].queries[regionStack.back()].end = timestamp();
+	regionStack.pop_back();
+}
+
+int GPUTimer::getRegionDepth() const
+{
+	return (int) regionStack.size();
+}
+
+void GPUTimer::nextFrame()
+{
+	while (!regionStack.empty())
+		popRegion();
+
+	endPass();
+
+	frameIndex = (frameIndex + 1) % FRAME_LATENCY;
+
+	// The oldest frame's queries are reused for the new frame.
+	Frame &frame = frames[frameIndex];
+
+	if (!frame.queries.empty())
+	{
+		readFrame(frame);
+		releaseFrame(frame);
+	}
+}
+
+void GPUTimer::readFrame(Frame &frame)
+{
+	// Queries complete in order, so the frame's results are available once
+	// the last one is.
+	GLuint available = 0;
+	glGetQueryObjectuiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available)
+		return;
+
+	// Timestamps are meaningless if something like a power state change
+	// happened while they were being recorded.
+	if (GLAD_EXT_disjoint_timer_query && !(GLAD_VERSION_3_3 || GLAD_ARB_timer_query))
+	{
+		GLint disjoint = 0;
+		glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+		if (disjoint)
+			return;
+	}
+
+	results.clear();
+	results.reserve(frame.queries.size());
+
+	for (const Query &query : frame.queries)
+	{
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+
+		glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &end);
+
+		Graphics::GPUTiming timing;
+		timing.name = query.name;
+		timing.time = end > begin ? (double) (end - begin) / 1000000000.0 : 0.0;
+		timing.depth = query.depth;
+
+		results.push_back(timing);
+	}
+}
+
+void GPUTimer::releaseFrame(Frame &frame)
+{
+	for (const Query &query : frame.queries)
+	{
+		freeQueries.push_back(query.begin);
+
+		if (query.end != 0)
+			freeQueries.push_back(query.end);
+	}
+
+	frame.queries.clear();
+	frame.lastQuery = 0;
+}
+
+void GPUTimer::reset()
+{
+	for (Frame &frame : frames)
+		releaseFrame(frame);
+
+	if (!freeQueries.empty())
+		glDeleteQueries((GLsizei) freeQueries.size(), freeQueries.data());
+
+	freeQueries.clear();
+	results.clear();
+	regionStack.clear();
+	passQuery = -1;
+	frameIndex = 0;
+}
+
+} // opengl
+} // graphics
+} // love
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#pragma once
+
+// LOVE
+#include "OpenGL.h"
+#include "graphics/Graphics.h"
+
+// C++
+#include <string>
+#include <vector>
+
+namespace love
+{
+namespace graphics
+{
+namespace opengl
+{
+
+/**
+ * Measures how long canvas passes and user-defined regions take on the GPU,
+ * using timestamp queries. Results are read back a few frames later, once the
+ * GPU is done with them, so getting them never stalls.
+ **/
+class GPUTimer
+{
+public:
+
+	GPUTimer();
+
+	static bool isSupported();
+
+	/**
+	 * Starts timing a new canvas pass, ending the previous one.
+	 **/
+	void beginPass(const char *name);
+
+	void pushRegion(const std::string &name);
+	void popRegion();
+	int getRegionDepth() const;
+
+	/**
+	 * Ends all open passes and regions and starts a new frame.
+	 **/
+	void nextFrame();
+
+	/**
+	 * Deletes all queries and results. Must be called while the OpenGL
+	 * context is still active.
+	 **/
+	void reset();
+
+	/**
+	 * Gets the timings of the most recent frame which has been read back.
+	 **/
+	const std::vector<Graphics::GPUTiming> &getResults() const { return results; }
+
+private:
+
+	struct Query
+	{
+		std::string name;
+		int depth;
+		GLuint begin;
+		GLuint end;
+	};
+
+	struct Frame
+	{
+		std::vector<Query> queries;
+		GLuint lastQuery = 0;
+	};
+
+	// How many frames we wait before reading a frame's results. If they still
+	// aren't available by then, the frame is skipped.
+	static const int FRAME_LATENCY = 4;
+
+	GLuint timestamp();
+	void endPass();
+	void readFrame(Frame &frame);
+	void releaseFrame(Frame &frame);
+
+	Frame frames[FRAME_LATENCY];
+	int frameIndex;
+
+	// Index of the open pass in the current frame's queries, or -1.
+	int passQuery;
+	std::vector<int> regionStack;
+
+	std::vector<GLuint> freeQueries;
+	std::vector<Graphics::GPUTiming> results;
+
+}; // GPUTimer
+
+} // opengl
+} // graphics
+} // love
@@ -57,6 +57,7 @@ namespace opengl
 Graphics::Graphics()
 	: windowHasStencil(false)
 	, mainVAO(0)
+	, gpuTimer(nullptr)
 {
 	gl = OpenGL();
 	Canvas::resetFormatSupport();
@@ -84,6 +85,7 @@ Graphics::Graphics()
 
 Graphics::~Graphics()
 {
+	delete gpuTimer;
 }
 
 const char *Graphics::getName() const
@@ -211,11 +213,13 @@ bool Graphics::setMode(int width, int height, int pixelwidth, int pixelheight, b
 
 	if (streamBufferState.vb[0] == nullptr)
 	{
-		// Initial sizes that should be good enough for most cases. It will
-		// resize to fit if needed, later.
-		streamBufferState.vb[0] = CreateStreamBuffer(BUFFER_VERTEX, 1024 * 1024 * 1);
-		streamBufferState.vb[1] = CreateStreamBuffer(BUFFER_VERTEX, 256  * 1024 * 1);
+		// Initial sizes that should be good enough for most cases (1 MB of
+		// vertex data by default). It will resize to fit if needed, later.
+		size_t size = std::max(getStreamBufferSize(), (size_t) 64 * 1024);
+		streamBufferState.vb[0] = CreateStreamBuffer(BUFFER_VERTEX, size);
+		streamBufferState.vb[1] = CreateStreamBuffer(BUFFER_VERTEX, size / 4);
 		streamBufferState.indexBuffer = CreateStreamBuffer(BUFFER_INDEX, sizeof(uint16) * LOVE_UINT16_MAX);
+		streamBufferState.textureIndexBuffer = CreateStreamBuffer(BUFFER_VERTEX, size / 16);
 	}
 
 	// Reload all volatile objects.
@@ -236,6 +240,18 @@ bool Graphics::setMode(int width, int height, int pixelwidth, int pixelheight, b
 		if (i == Shader::STANDARD_ARRAY && !capabilities.textureTypes[TEXTURE_2D_ARRAY])
 			continue;
 
+		if (i == Shader::STANDARD_MULTITEXTURE && gl.getMaxTextureUnits() < MAX_BATCH_TEXTURES)
+			continue;
+
+		if (i == Shader::STANDARD_PARTICLE_SIMULATION && (gl.getMaxRenderTargets() < 2 || !isCanvasFormatSupported(PIXELFORMAT_RGBA32F, true)))
+			continue;
+
+		if (i == Shader::STANDARD_PARTICLE_DRAW && gl.getMaxVertexTextureUnits() < 4)
+			continue;
+
+		if (i == Shader::STANDARD_SPRITE_INSTANCED && !capabilities.features[FEATURE_INSTANCING])
+			continue;
+
 		// Apparently some intel GMA drivers on windows fail to compile shaders
 		// which use array textures despite claiming support for the extension.
 		try
@@ -248,9 +264,15 @@ bool Graphics::setMode(int width, int height, int pixelwidth, int pixelheight, b
 		}
 		catch (love::Exception &)
 		{
+			// Batches just won't use multiple textures if this one fails, and
+			// ParticleSystems and SpriteBatches won't support their GPU paths
+			// without theirs. Distance field Fonts fall back to the default
+			// shader.
 			if (i == Shader::STANDARD_ARRAY)
 				capabilities.textureTypes[TEXTURE_2D_ARRAY] = false;
-			else
+			else if (i != Shader::STANDARD_MULTITEXTURE && i != Shader::STANDARD_PARTICLE_SIMULATION
+				&& i != Shader::STANDARD_PARTICLE_DRAW && i != Shader::STANDARD_SPRITE_INSTANCED
+				&& i != Shader::STANDARD_DISTANCE_FIELD)
 				throw;
 		}
 	}
@@ -260,6 +282,9 @@ bool Graphics::setMode(int width, int height, int pixelwidth, int pixelheight, b
 	if (!Shader::current)
 		Shader::standardShaders[Shader::STANDARD_DEFAULT]->attach();
 
+	if (gpuTimer != nullptr)
+		gpuTimer->beginPass("screen");
+
 	return true;
 }
 
@@ -270,6 +295,9 @@ void Graphics::unSetMode()
 
 	flushStreamDraws();
 
+	if (gpuTimer != nullptr)
+		gpuTimer->reset();
+
 	// Unload all volatile objects. These must be reloaded after the display
 	// mode change.
 	Volatile::unloadAll();
@@ -484,6 +512,9 @@ void Graphics::setCanvasInternal(const RenderTargets &rts, int w, int h, int pix
 	endPass();
 
 	bool iswindow = rts.getFirstTarget().canvas == nullptr;
+
+	if (gpuTimer != nullptr)
+		gpuTimer->beginPass(iswindow ? "screen" : "canvas");
 	vertex::Winding vertexwinding = state.winding;
 
 	if (iswindow)
@@ -1011,18 +1042,32 @@ void Graphics::present(void *screenshotCallbackData)
 #endif
 
 	for (StreamBuffer *buffer : streamBufferState.vb)
+	{
 		buffer->nextFrame();
+		buffer->resetStats();
+	}
 	streamBufferState.indexBuffer->nextFrame();
+	streamBufferState.indexBuffer->resetStats();
+	streamBufferState.textureIndexBuffer->nextFrame();
+	streamBufferState.textureIndexBuffer->resetStats();
+
+	if (gpuTimer != nullptr)
+		gpuTimer->nextFrame();
 
 	auto window = getInstance<love::window::Window>(M_WINDOW);
 	if (window != nullptr)
 		window->swapBuffers();
 
+	if (gpuTimer != nullptr)
+		gpuTimer->beginPass("screen");
+
 	// Reset the per-frame stat counts.
 	drawCalls = 0;
 	gl.stats.shaderSwitches = 0;
 	canvasSwitchCount = 0;
 	drawCallsBatched = 0;
+	batchesMerged = 0;
+	streamBytes = 0;
 
 	// This assumes temporary canvases will only be used within a render pass.
 	for (int i = (int) temporaryCanvases.size() - 1; i >= 0; i--)
@@ -1316,7 +1361,7 @@ void Graphics::setBlendMode(BlendMode mode, BlendAlpha alphamode)
 
 void Graphics::setPointSize(float size)
 {
-	if (streamBufferState.primitiveMode == PRIMITIVE_POINTS)
+	if (streamBufferState.primitiveMode == PRIMITIVE_POINTS || !deferredStreamState.draws.empty())
 		flushStreamDraws();
 
 	gl.setPointSize(size * getCurrentDPIScale());
@@ -1375,6 +1420,14 @@ void Graphics::getAPIStats(int &shaderswitches) const
 	shaderswitches = gl.stats.shaderSwitches;
 }
 
+void Graphics::getGPUTimings(std::vector<GPUTiming> &timings) const
+{
+	if (gpuTimer != nullptr)
+		timings = gpuTimer->getResults();
+	else
+		timings.clear();
+}
+
 void Graphics::initCapabilities()
 {
 	capabilities.features[FEATURE_MULTI_CANVAS_FORMATS] = Canvas::isMultiFormatMultiCanvasSupported();
@@ -1385,7 +1438,8 @@ void Graphics::initCapabilities()
 	capabilities.features[FEATURE_SHADER_DERIVATIVES] = GLAD_VERSION_2_0 || GLAD_ES_VERSION_3_0 || GLAD_OES_standard_derivatives;
 	capabilities.features[FEATURE_GLSL3] = GLAD_ES_VERSION_3_0 || gl.isCoreProfile();
 	capabilities.features[FEATURE_INSTANCING] = gl.isInstancingSupported();
-	static_assert(FEATURE_MAX_ENUM == 8, "Graphics::initCapabilities must be updated when adding a new graphics feature!");
+	capabilities.features[FEATURE_TIMER_QUERY] = GPUTimer::isSupported();
+	static_assert(FEATURE_MAX_ENUM == 9, "Graphics::initCapabilities must be updated when adding a new graphics feature!");
 
 	capabilities.limits[LIMIT_POINT_SIZE] = gl.getMaxPointSize();
 	capabilities.limits[LIMIT_TEXTURE_SIZE] = gl.getMax2DTextureSize();
@@ -1428,6 +1482,57 @@ Shader::Language Graphics::getShaderLanguageTarget() const
 		return Shader::LANGUAGE_GLSL1;
 }
 
+void Graphics::setGPUTimingEnabled(bool enable)
+{
+	if (enable == (gpuTimer != nullptr))
+		return;
+
+	if (enable)
+	{
+		if (!capabilities.features[FEATURE_TIMER_QUERY])
+			throw love::Exception("GPU timing is not supported on this system.");
+
+		flushStreamDraws();
+
+		gpuTimer = new GPUTimer();
+
+		if (isCreated())
+			gpuTimer->beginPass(isCanvasActive() ? "canvas" : "screen");
+	}
+	else
+	{
+		if (isCreated())
+			gpuTimer->reset();
+
+		delete gpuTimer;
+		gpuTimer = nullptr;
+	}
+}
+
+bool Graphics::isGPUTimingEnabled() const
+{
+	return gpuTimer != nullptr;
+}
+
+void Graphics::pushTimerRegion(const std::string &name)
+{
+	// Regions can be left in code when GPU timing is disabled.
+	if (gpuTimer == nullptr)
+		return;
+
+	flushStreamDraws();
+	gpuTimer->pushRegion(name);
+}
+
+void Graphics::popTimerRegion()
+{
+	if (gpuTimer == nullptr)
+		return;
+
+	flushStreamDraws();
+	gpuTimer->popRegion();
+}
+
 } // opengl
 } // graphics
 } // love
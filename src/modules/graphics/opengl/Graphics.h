@@ -39,6 +39,7 @@
 #include "Image.h"
 #include "Canvas.h"
 #include "Shader.h"
+#include "GPUTimer.h"
 
 #include "libraries/xxHash/xxhash.h"
 
@@ -112,6 +113,11 @@ class Graphics final : public love::graphics::Graphics
 
 	Shader::Language getShaderLanguageTarget() const override;
 
+	void setGPUTimingEnabled(bool enable) override;
+	bool isGPUTimingEnabled() const override;
+	void pushTimerRegion(const std::string &name) override;
+	void popTimerRegion() override;
+
 	// Internal use.
 	void cleanupCanvas(Canvas *canvas);
 
@@ -142,6 +148,7 @@ class Graphics final : public love::graphics::Graphics
 	void setCanvasInternal(const RenderTargets &rts, int w, int h, int pixelw, int pixelh, bool hasSRGBcanvas) override;
 	void initCapabilities() override;
 	void getAPIStats(int &shaderswitches) const override;
+	void getGPUTimings(std::vector<GPUTiming> &timings) const override;
 
 	void endPass();
 	void bindCachedFBO(const RenderTargets &targets);
@@ -153,6 +160,9 @@ class Graphics final : public love::graphics::Graphics
 	bool windowHasStencil;
 	GLuint mainVAO;
 
+	// Only allocated while GPU timing is enabled.
+	GPUTimer *gpuTimer;
+
 }; // Graphics
 
 } // opengl
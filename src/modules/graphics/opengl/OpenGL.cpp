@@ -105,6 +105,7 @@ OpenGL::OpenGL()
 	, maxRenderTargets(1)
 	, maxRenderbufferSamples(0)
 	, maxTextureUnits(1)
+	, maxVertexTextureUnits(0)
 	, maxPointSize(1)
 	, coreProfile(false)
 	, vendor(VENDOR_UNKNOWN)
@@ -391,6 +392,15 @@ void OpenGL::initOpenGLFunctions()
 		}
 	}
 
+	if (!(GLAD_VERSION_3_3 || GLAD_ARB_timer_query) && GLAD_EXT_disjoint_timer_query)
+	{
+		fp_glGenQueries = fp_glGenQueriesEXT;
+		fp_glDeleteQueries = fp_glDeleteQueriesEXT;
+		fp_glQueryCounter = fp_glQueryCounterEXT;
+		fp_glGetQueryObjectuiv = fp_glGetQueryObjectuivEXT;
+		fp_glGetQueryObjectui64v = fp_glGetQueryObjectui64vEXT;
+	}
+
 	if (GLAD_ES_VERSION_2_0 && GLAD_OES_texture_3D && !GLAD_ES_VERSION_3_0)
 	{
 		// Function signatures don't match, we'll have to conditionally call it
@@ -484,6 +494,7 @@ void OpenGL::initMaxValues()
 		maxRenderbufferSamples = 0;
 
 	glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+	glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &maxVertexTextureUnits);
 
 	GLfloat limits[2];
 	if (GLAD_VERSION_3_0)
@@ -1291,6 +1302,11 @@ int OpenGL::getMaxTextureUnits() const
 	return maxTextureUnits;
 }
 
+int OpenGL::getMaxVertexTextureUnits() const
+{
+	return maxVertexTextureUnits;
+}
+
 float OpenGL::getMaxPointSize() const
 {
 	return maxPointSize;
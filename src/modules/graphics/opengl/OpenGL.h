@@ -385,6 +385,12 @@ class OpenGL
 	 **/
 	int getMaxTextureUnits() const;
 
+	/**
+	 * Returns the maximum number of texture units accessible from vertex
+	 * shaders.
+	 **/
+	int getMaxVertexTextureUnits() const;
+
 	/**
 	 * Returns the maximum point size.
 	 **/
@@ -451,6 +457,7 @@ class OpenGL
 	int maxRenderTargets;
 	int maxRenderbufferSamples;
 	int maxTextureUnits;
+	int maxVertexTextureUnits;
 	float maxPointSize;
 
 	bool coreProfile;
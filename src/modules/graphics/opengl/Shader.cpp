@@ -701,6 +701,14 @@ void Shader::setVideoTextures(Texture *ytexture, Texture *cbtexture, Texture *cr
 	}
 }
 
+void Shader::setBatchTextures(Texture **textures, int count)
+{
+	const UniformInfo *info = builtinUniformInfo[BUILTIN_TEXTURE_BATCH];
+
+	if (info != nullptr)
+		sendTextures(info, textures, count, true);
+}
+
 void Shader::updateScreenParams()
 {
 	Rect view = gl.getViewport();
@@ -65,6 +65,7 @@ class Shader final : public love::graphics::Shader, public Volatile
 	bool hasUniform(const std::string &name) const override;
 	ptrdiff_t getHandle() const override;
 	void setVideoTextures(Texture *ytexture, Texture *cbtexture, Texture *crtexture) override;
+	void setBatchTextures(Texture **textures, int count) override;
 
 	void updateScreenParams();
 	void updatePointSize(float size);
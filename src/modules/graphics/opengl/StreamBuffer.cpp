@@ -25,6 +25,7 @@
 #include "graphics/Volatile.h"
 #include "common/Exception.h"
 #include "common/memory.h"
+#include "timer/Timer.h"
 
 #include <vector>
 #include <algorithm>
@@ -36,9 +37,14 @@ namespace graphics
 namespace opengl
 {
 
-// Typically this should be 3 frames, but we only do per-frame syncing right now
-// so we add an extra frame to reduce the (small) chance of stalls.
-static const int BUFFER_FRAMES = 4;
+// The fence-synced implementations use a ring of this many frames' worth of
+// data. A frame can use more than its share, in which case the ring wraps
+// sooner and may have to wait for the GPU.
+static const int BUFFER_FRAMES = 3;
+
+// Maximum number of fenced ranges a ring keeps track of. When they're all in
+// use the oldest one is waited on, which is several frames old by then.
+static const int MAX_RING_FENCES = 16;
 
 class StreamBufferClientMemory final : public love::graphics::StreamBuffer
 {
@@ -186,33 +192,126 @@ class StreamBufferSync : public love::graphics::StreamBuffer
 
 	StreamBufferSync(BufferType type, size_t size)
 		: love::graphics::StreamBuffer(type, size)
-		, frameIndex(0)
-		, syncs()
+		, ringSize(size * BUFFER_FRAMES)
+		, rangeStart(0)
+		, firstRange(0)
+		, rangeCount(0)
 	{}
 
 	virtual ~StreamBufferSync() {}
 
-	void nextFrame() override
+	size_t getUsableSize() const override
 	{
-		// Insert a GPU fence for this frame's section of the data, we'll wait
-		// for it when we try to map that data for writing in subsequent frames.
-		syncs[frameIndex].fence();
+		// A single map can use the whole ring, after waiting for the GPU.
+		return ringSize;
+	}
 
-		frameIndex = (frameIndex + 1) % BUFFER_FRAMES;
-		frameGPUReadOffset = 0;
+	void nextFrame() override
+	{
+		// Insert a GPU fence for this frame's data, we'll wait for it when
+		// the ring wraps back around to that data.
+		fenceRange();
 	}
 
 	void markUsed(size_t usedsize) override
 	{
-		// We insert a fence for all data from this frame at the end of the
-		// frame (in nextFrame), rather than doing anything more fine-grained.
+		// frameGPUReadOffset is the ring's write position.
 		frameGPUReadOffset += usedsize;
 	}
 
 protected:
 
-	int frameIndex;
-	FenceSync syncs[BUFFER_FRAMES];
+	// Makes sure at least minsize bytes at the write position aren't being
+	// used by the GPU, and returns how many contiguous bytes are available.
+	size_t reserve(size_t minsize)
+	{
+		// Wrap around to the start if there isn't enough room before the end.
+		if (ringSize - frameGPUReadOffset < minsize)
+		{
+			fenceRange();
+			frameGPUReadOffset = 0;
+			rangeStart = 0;
+			wrapCount++;
+		}
+
+		while (rangeCount > 0 && getFreeSize() < minsize)
+			waitOldestRange();
+
+		return getFreeSize();
+	}
+
+	void resetRing()
+	{
+		for (FencedRange &range : ranges)
+			range.sync.cleanup();
+
+		frameGPUReadOffset = 0;
+		rangeStart = 0;
+		firstRange = 0;
+		rangeCount = 0;
+	}
+
+	size_t ringSize;
+
+private:
+
+	struct FencedRange
+	{
+		FenceSync sync;
+		size_t start = 0;
+	};
+
+	size_t getFreeSize() const
+	{
+		size_t head = frameGPUReadOffset;
+
+		if (rangeCount == 0)
+			return ringSize - head;
+
+		// Ranges are fenced in order, so the oldest one is where the data
+		// the GPU might still be using starts.
+		size_t tail = ranges[firstRange].start;
+
+		if (tail > head)
+			return tail - head;
+		else if (tail == head)
+			return 0; // The write position has gone all the way around.
+		else
+			return ringSize - head;
+	}
+
+	void fenceRange()
+	{
+		if (frameGPUReadOffset == rangeStart)
+			return;
+
+		if (rangeCount == MAX_RING_FENCES)
+			waitOldestRange();
+
+		FencedRange &range = ranges[(firstRange + rangeCount) % MAX_RING_FENCES];
+		range.sync.fence();
+		range.start = rangeStart;
+
+		rangeCount++;
+		rangeStart = frameGPUReadOffset;
+	}
+
+	void waitOldestRange()
+	{
+		double starttime = love::timer::Timer::getTime();
+		ranges[firstRange].sync.cpuWait();
+		stallTime += love::timer::Timer::getTime() - starttime;
+
+		firstRange = (firstRange + 1) % MAX_RING_FENCES;
+		rangeCount--;
+	}
+
+	// Start of the data which has been written since the last fence.
+	size_t rangeStart;
+
+	FencedRange ranges[MAX_RING_FENCES];
+	int firstRange;
+	int rangeCount;
 
 }; // StreamBufferSync
 
@@ -233,20 +332,15 @@ class StreamBufferMapSync final : public StreamBufferSync, public Volatile
 		unloadVolatile();
 	}
 
-	MapInfo map(size_t /*minsize*/) override
+	MapInfo map(size_t minsize) override
 	{
-		gl.bindBuffer(mode, vbo);
-
-		// Make sure this frame's section of the buffer is done being used.
-		syncs[frameIndex].cpuWait();
-
 		MapInfo info;
-		info.size = bufferSize - frameGPUReadOffset;
+		info.size = reserve(minsize);
 
-		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		gl.bindBuffer(mode, vbo);
 
-		size_t mapoffset = (frameIndex * bufferSize) + frameGPUReadOffset;
-		info.data = (uint8 *) glMapBufferRange(glMode, mapoffset, info.size, flags);
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		info.data = (uint8 *) glMapBufferRange(glMode, frameGPUReadOffset, info.size, flags);
 
 		return info;
 	}
@@ -257,7 +351,7 @@ class StreamBufferMapSync final : public StreamBufferSync, public Volatile
 		glFlushMappedBufferRange(glMode, 0, usedsize);
 		glUnmapBuffer(glMode);
 
-		return (frameIndex * bufferSize) + frameGPUReadOffset;
+		return frameGPUReadOffset;
 	}
 
 	ptrdiff_t getHandle() const override { return vbo; }
@@ -269,10 +363,9 @@ class StreamBufferMapSync final : public StreamBufferSync, public Volatile
 
 		glGenBuffers(1, &vbo);
 		gl.bindBuffer(mode, vbo);
-		glBufferData(glMode, bufferSize * BUFFER_FRAMES, nullptr, GL_STREAM_DRAW);
+		glBufferData(glMode, ringSize, nullptr, GL_STREAM_DRAW);
 
-		frameGPUReadOffset = 0;
-		frameIndex = 0;
+		resetRing();
 
 		return true;
 	}
@@ -285,8 +378,7 @@ class StreamBufferMapSync final : public StreamBufferSync, public Volatile
 			vbo = 0;
 		}
 
-		for (FenceSync &sync : syncs)
-			sync.cleanup();
+		resetRing();
 	}
 
 private:
@@ -317,28 +409,23 @@ class StreamBufferPersistentMapSync final : public StreamBufferSync, public Vola
 		unloadVolatile();
 	}
 
-	MapInfo map(size_t /*minsize*/) override
+	MapInfo map(size_t minsize) override
 	{
-		// Make sure this frame's section of the buffer is done being used.
-		syncs[frameIndex].cpuWait();
-
 		MapInfo info;
-		info.size = bufferSize - frameGPUReadOffset;
-		info.data = data + (frameIndex * bufferSize) + frameGPUReadOffset;
+		info.size = reserve(minsize);
+		info.data = data + frameGPUReadOffset;
 		return info;
 	}
 
 	size_t unmap(size_t usedsize) override
 	{
-		size_t offset = (frameIndex * bufferSize) + frameGPUReadOffset;
-
 		if (!coherent)
 		{
 			gl.bindBuffer(mode, vbo);
-			glFlushMappedBufferRange(glMode, offset, usedsize);
+			glFlushMappedBufferRange(glMode, frameGPUReadOffset, usedsize);
 		}
 
-		return offset;
+		return frameGPUReadOffset;
 	}
 
 	ptrdiff_t getHandle() const override { return vbo; }
@@ -357,11 +444,10 @@ class StreamBufferPersistentMapSync final : public StreamBufferSync, public Vola
 		storageflags |= (coherent ? GL_MAP_COHERENT_BIT : 0);
 		mapflags |= (coherent ? GL_MAP_COHERENT_BIT : GL_MAP_FLUSH_EXPLICIT_BIT);
 
-		glBufferStorage(glMode, bufferSize * BUFFER_FRAMES, nullptr, storageflags);
-		data = (uint8 *) glMapBufferRange(glMode, 0, bufferSize * BUFFER_FRAMES, mapflags);
+		glBufferStorage(glMode, ringSize, nullptr, storageflags);
+		data = (uint8 *) glMapBufferRange(glMode, 0, ringSize, mapflags);
 
-		frameGPUReadOffset = 0;
-		frameIndex = 0;
+		resetRing();
 
 		return true;
 	}
@@ -376,8 +462,7 @@ class StreamBufferPersistentMapSync final : public StreamBufferSync, public Vola
 			vbo = 0;
 		}
 
-		for (FenceSync &sync : syncs)
-			sync.cleanup();
+		resetRing();
 	}
 
 private:
@@ -401,7 +486,7 @@ class StreamBufferPinnedMemory final : public StreamBufferSync, public Volatile
 		, alignedSize(0)
 	{
 		size_t alignment = getPageSize();
-		alignedSize = alignUp(size * BUFFER_FRAMES, alignment);
+		alignedSize = alignUp(ringSize, alignment);
 
 		if (!alignedMalloc((void **) &data, alignedSize, alignment))
 			throw love::Exception("Out of memory.");
@@ -420,21 +505,17 @@ class StreamBufferPinnedMemory final : public StreamBufferSync, public Volatile
 		alignedFree(data);
 	}
 
-	MapInfo map(size_t /*minsize*/) override
+	MapInfo map(size_t minsize) override
 	{
-		// Make sure this frame's section of the buffer is done being used.
-		syncs[frameIndex].cpuWait();
-
 		MapInfo info;
-		info.size = bufferSize - frameGPUReadOffset;
-		info.data = data + (frameIndex * bufferSize) + frameGPUReadOffset;
+		info.size = reserve(minsize);
+		info.data = data + frameGPUReadOffset;
 		return info;
 	}
 
 	size_t unmap(size_t /*usedsize*/) override
 	{
-		size_t offset = (frameIndex * bufferSize) + frameGPUReadOffset;
-		return offset;
+		return frameGPUReadOffset;
 	}
 
 	ptrdiff_t getHandle() const override { return vbo; }
@@ -459,8 +540,7 @@ class StreamBufferPinnedMemory final : public StreamBufferSync, public Volatile
 			return false;
 		}
 
-		frameGPUReadOffset = 0;
-		frameIndex = 0;
+		resetRing();
 
 		return true;
 	}
@@ -478,8 +558,7 @@ class StreamBufferPinnedMemory final : public StreamBufferSync, public Volatile
 			vbo = 0;
 		}
 
-		for (FenceSync &sync : syncs)
-			sync.cleanup();
+		resetRing();
 	}
 
 private:
@@ -279,10 +279,11 @@ void Attributes::setCommonFormat(CommonFormat format, uint8 bufferindex)
 
 static StringMap<BuiltinVertexAttribute, ATTRIB_MAX_ENUM>::Entry attribNameEntries[] =
 {
-	{ "VertexPosition", ATTRIB_POS           },
-	{ "VertexTexCoord", ATTRIB_TEXCOORD      },
-	{ "VertexColor",    ATTRIB_COLOR         },
-	{ "ConstantColor",  ATTRIB_CONSTANTCOLOR },
+	{ "VertexPosition",     ATTRIB_POS           },
+	{ "VertexTexCoord",     ATTRIB_TEXCOORD      },
+	{ "VertexColor",        ATTRIB_COLOR         },
+	{ "ConstantColor",      ATTRIB_CONSTANTCOLOR },
+	{ "VertexTextureIndex", ATTRIB_TEXTUREINDEX  },
 };
 
 static StringMap<BuiltinVertexAttribute, ATTRIB_MAX_ENUM> attribNames(attribNameEntries, sizeof(attribNameEntries));
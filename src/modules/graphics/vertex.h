@@ -44,6 +44,7 @@ enum BuiltinVertexAttribute
 	ATTRIB_TEXCOORD,
 	ATTRIB_COLOR,
 	ATTRIB_CONSTANTCOLOR,
+	ATTRIB_TEXTUREINDEX,
 	ATTRIB_MAX_ENUM
 };
 
@@ -52,7 +53,8 @@ enum BuiltinVertexAttributeFlag
 	ATTRIBFLAG_POS = 1 << ATTRIB_POS,
 	ATTRIBFLAG_TEXCOORD = 1 << ATTRIB_TEXCOORD,
 	ATTRIBFLAG_COLOR = 1 << ATTRIB_COLOR,
-	ATTRIBFLAG_CONSTANTCOLOR = 1 << ATTRIB_CONSTANTCOLOR
+	ATTRIBFLAG_CONSTANTCOLOR = 1 << ATTRIB_CONSTANTCOLOR,
+	ATTRIBFLAG_TEXTUREINDEX = 1 << ATTRIB_TEXTUREINDEX
 };
 
 enum BufferType
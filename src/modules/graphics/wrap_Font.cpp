@@ -22,9 +22,16 @@
 #include "common/config.h"
 #include "wrap_Font.h"
 
+#include "libraries/utf8/utf8.h"
+
 // C++
 #include <algorithm>
 
+// Shove the wrap_Font.lua code directly into a raw string literal.
+static const char font_lua[] =
+#include "wrap_Font.lua"
+;
+
 namespace love
 {
 namespace graphics
@@ -121,6 +128,55 @@ int w_Font_getWrap(lua_State *L)
 	return 2;
 }
 
+int w_Font_getWidths(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	luaL_checktype(L, 2, LUA_TTABLE);
+	float wraplimit = (float) luaL_optnumber(L, 3, -1.0);
+
+	int count = (int) luax_objlen(L, 2);
+
+	// All strings are measured from one buffer.
+	std::string text;
+	std::vector<int> offsets(count + 1, 0);
+
+	for (int i = 0; i < count; i++)
+	{
+		lua_rawgeti(L, 2, i + 1);
+
+		size_t len = 0;
+		const char *str = lua_tolstring(L, -1, &len);
+		if (str == nullptr)
+			return luaL_error(L, "Expected a string at index %d of the strings table.", i + 1);
+
+		text.append(str, len);
+		offsets[i + 1] = (int) text.size();
+
+		lua_pop(L, 1);
+	}
+
+	std::vector<int> widths(count);
+	std::vector<int> linecounts(count);
+
+	luax_catchexcept(L, [&]() { t->getWidths(text.data(), offsets.data(), count, wraplimit, widths.data(), linecounts.data()); });
+
+	lua_createtable(L, count, 0);
+	for (int i = 0; i < count; i++)
+	{
+		lua_pushinteger(L, widths[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_createtable(L, count, 0);
+	for (int i = 0; i < count; i++)
+	{
+		lua_pushinteger(L, linecounts[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 2;
+}
+
 int w_Font_setLineHeight(lua_State *L)
 {
 	Font *t = luax_checkfont(L, 1);
@@ -226,6 +282,180 @@ int w_Font_setFallbacks(lua_State *L)
 	return 0;
 }
 
+int w_Font_setGlyphLoadMode(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	Font::GlyphLoadMode mode;
+	const char *str = luaL_checkstring(L, 2);
+	if (!Font::getConstant(str, mode))
+		return luax_enumerror(L, "glyph load mode", Font::getConstants(mode), str);
+
+	t->setGlyphLoadMode(mode);
+	return 0;
+}
+
+int w_Font_getGlyphLoadMode(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	const char *str;
+	if (!Font::getConstant(t->getGlyphLoadMode(), str))
+		return luaL_error(L, "Unknown glyph load mode.");
+
+	lua_pushstring(L, str);
+	return 1;
+}
+
+int w_Font_setGlyphPlaceholder(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+
+	if (lua_isnoneornil(L, 2))
+	{
+		t->setGlyphPlaceholder();
+		return 0;
+	}
+
+	uint32 glyph = 0;
+
+	if (lua_type(L, 2) == LUA_TSTRING)
+	{
+		Font::Codepoints codepoints;
+		luax_catchexcept(L, [&](){ Font::getCodepointsFromString(luax_checkstring(L, 2), codepoints); });
+
+		if (codepoints.empty())
+			return luaL_argerror(L, 2, "expected a non-empty string");
+
+		glyph = codepoints[0];
+	}
+	else
+		glyph = (uint32) luaL_checknumber(L, 2);
+
+	t->setGlyphPlaceholder(glyph);
+	return 0;
+}
+
+int w_Font_getGlyphPlaceholder(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	uint32 glyph = 0;
+
+	if (!t->getGlyphPlaceholder(glyph))
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+
+	char str[5] = {};
+	luax_catchexcept(L, [&](){ utf8::append(glyph, str); });
+
+	lua_pushstring(L, str);
+	return 1;
+}
+
+int w_Font_preloadGlyphs(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	Font::Codepoints codepoints;
+
+	for (int i = 2; i <= lua_gettop(L); i++)
+	{
+		if (lua_type(L, i) == LUA_TSTRING)
+			luax_catchexcept(L, [&](){ Font::getCodepointsFromString(luax_checkstring(L, i), codepoints); });
+		else
+			codepoints.push_back((uint32) luaL_checknumber(L, i));
+	}
+
+	luax_catchexcept(L, [&](){ t->preloadGlyphs(codepoints); });
+	return 0;
+}
+
+int w_Font_getPendingGlyphCount(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	lua_pushinteger(L, t->getPendingGlyphCount());
+	return 1;
+}
+
+int w_Font_setAtlasMemoryBudget(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	int64 bytes = lua_isnoneornil(L, 2) ? 0 : (int64) luaL_checknumber(L, 2);
+	t->setAtlasMemoryBudget(bytes);
+	return 0;
+}
+
+int w_Font_getAtlasMemoryBudget(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	lua_pushnumber(L, (lua_Number) t->getAtlasMemoryBudget());
+	return 1;
+}
+
+int w_Font_getAtlasStats(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+
+	Font::AtlasStats stats = {};
+	t->getAtlasStats(stats);
+
+	lua_createtable(L, 0, 6);
+
+	lua_pushinteger(L, stats.pages);
+	lua_setfield(L, -2, "pages");
+
+	lua_pushinteger(L, stats.glyphs);
+	lua_setfield(L, -2, "glyphs");
+
+	lua_pushnumber(L, (lua_Number) stats.memory);
+	lua_setfield(L, -2, "memory");
+
+	lua_pushnumber(L, stats.occupancy);
+	lua_setfield(L, -2, "occupancy");
+
+	lua_pushnumber(L, (lua_Number) stats.evictions);
+	lua_setfield(L, -2, "evictions");
+
+	lua_pushinteger(L, stats.compactions);
+	lua_setfield(L, -2, "compactions");
+
+	return 1;
+}
+
+int w_Font_setAtlasShared(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	bool shared = luax_checkboolean(L, 2);
+	luax_catchexcept(L, [&](){ t->setAtlasShared(shared); });
+	return 0;
+}
+
+int w_Font_isAtlasShared(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	luax_pushboolean(L, t->isAtlasShared());
+	return 1;
+}
+
+int w_Font_saveGlyphCache(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	std::string filename = luax_checkstring(L, 2);
+	luax_catchexcept(L, [&](){ t->saveGlyphCache(filename); });
+	return 0;
+}
+
+int w_Font_loadGlyphCache(lua_State *L)
+{
+	Font *t = luax_checkfont(L, 1);
+	std::string filename = luax_checkstring(L, 2);
+
+	bool success = false;
+	luax_catchexcept(L, [&](){ success = t->loadGlyphCache(filename); });
+
+	luax_pushboolean(L, success);
+	return 1;
+}
+
 int w_Font_getDPIScale(lua_State *L)
 {
 	Font *t = luax_checkfont(L, 1);
@@ -238,6 +468,7 @@ static const luaL_Reg w_Font_functions[] =
 	{ "getHeight", w_Font_getHeight },
 	{ "getWidth", w_Font_getWidth },
 	{ "getWrap", w_Font_getWrap },
+	{ "getWidths", w_Font_getWidths },
 	{ "setLineHeight", w_Font_setLineHeight },
 	{ "getLineHeight", w_Font_getLineHeight },
 	{ "setFilter", w_Font_setFilter },
@@ -247,13 +478,56 @@ static const luaL_Reg w_Font_functions[] =
 	{ "getBaseline", w_Font_getBaseline },
 	{ "hasGlyphs", w_Font_hasGlyphs },
 	{ "setFallbacks", w_Font_setFallbacks },
+	{ "setGlyphLoadMode", w_Font_setGlyphLoadMode },
+	{ "getGlyphLoadMode", w_Font_getGlyphLoadMode },
+	{ "setGlyphPlaceholder", w_Font_setGlyphPlaceholder },
+	{ "getGlyphPlaceholder", w_Font_getGlyphPlaceholder },
+	{ "preloadGlyphs", w_Font_preloadGlyphs },
+	{ "getPendingGlyphCount", w_Font_getPendingGlyphCount },
+	{ "setAtlasMemoryBudget", w_Font_setAtlasMemoryBudget },
+	{ "getAtlasMemoryBudget", w_Font_getAtlasMemoryBudget },
+	{ "getAtlasStats", w_Font_getAtlasStats },
+	{ "setAtlasShared", w_Font_setAtlasShared },
+	{ "isAtlasShared", w_Font_isAtlasShared },
+	{ "saveGlyphCache", w_Font_saveGlyphCache },
+	{ "loadGlyphCache", w_Font_loadGlyphCache },
 	{ "getDPIScale", w_Font_getDPIScale },
 	{ 0, 0 }
 };
 
+// C functions in a struct, necessary for the FFI versions of Font methods.
+struct FFI_Font
+{
+	bool (*getWidths)(Proxy *p, const char *text, const int *offsets, int count, float wraplimit, int *widths, int *linecounts);
+};
+
+static FFI_Font ffifuncs =
+{
+	[](Proxy *p, const char *text, const int *offsets, int count, float wraplimit, int *widths, int *linecounts) -> bool // getWidths
+	{
+		// Exceptions can't be thrown through the FFI. The caller uses the
+		// Lua-C API version to report the error instead.
+		Font *f = (Font *) p->object;
+
+		try
+		{
+			f->getWidths(text, offsets, count, wraplimit, widths, linecounts);
+			return true;
+		}
+		catch (love::Exception &)
+		{
+			return false;
+		}
+	},
+};
+
 extern "C" int luaopen_font(lua_State *L)
 {
-	return luax_register_type(L, &Font::type, w_Font_functions, nullptr);
+	int ret = luax_register_type(L, &Font::type, w_Font_functions, nullptr);
+
+	luax_runwrapper(L, font_lua, sizeof(font_lua), "Font.lua", Font::type, &ffifuncs);
+
+	return ret;
 }
 
 } // graphics
@@ -0,0 +1,109 @@
+R"luastring"--(
+-- DO NOT REMOVE THE ABOVE LINE. It is used to load this file as a C++ string.
+-- There is a matching delimiter at the bottom of the file.
+
+--[[
+Copyright (c) 2006-2020 LOVE Development Team
+
+This software is provided 'as-is', without any express or implied
+warranty.  In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+claim that you wrote the original software. If you use this software
+in a product, an acknowledgment in the product documentation would be
+appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+--]]
+
+local Font_mt, ffifuncspointer_str = ...
+local Font = Font_mt.__index
+
+-- Everything below this point is efficient FFI replacements for existing
+-- Font functionality.
+
+if type(jit) ~= "table" or not jit.status() then
+	-- LuaJIT's FFI is *much* slower than LOVE's regular methods when the JIT
+	-- compiler is disabled.
+	return
+end
+
+local status, ffi = pcall(require, "ffi")
+if not status then return end
+
+pcall(ffi.cdef, [[
+typedef struct Proxy Proxy;
+
+typedef struct FFI_Font
+{
+	bool (*getWidths)(Proxy *p, const char *text, const int *offsets, int count, float wraplimit, int *widths, int *linecounts);
+} FFI_Font;
+]])
+
+local ffifuncs = ffi.cast("FFI_Font **", ffifuncspointer_str)[0]
+
+local type, error = type, error
+local concat = table.concat
+local max = math.max
+
+local intarray = ffi.typeof("int[?]")
+
+-- Scratch space shared by all calls, grown when needed.
+local capacity = 0
+local offsets, widths, linecounts
+
+local _getWidths = Font.getWidths
+
+function Font:getWidths(strings, wraplimit)
+	if type(strings) ~= "table" then error("bad argument #1 to Font:getWidths (expected table)", 2) end
+	if wraplimit ~= nil and type(wraplimit) ~= "number" then error("bad argument #2 to Font:getWidths (expected number)", 2) end
+
+	local count = #strings
+
+	if count + 1 > capacity then
+		capacity = max(count + 1, capacity * 2)
+		offsets = intarray(capacity)
+		widths = intarray(capacity)
+		linecounts = intarray(capacity)
+	end
+
+	local offset = 0
+	offsets[0] = 0
+
+	for i = 1, count do
+		local str = strings[i]
+
+		-- Let the Lua-C API version deal with numbers and invalid values.
+		if type(str) ~= "string" then
+			return _getWidths(self, strings, wraplimit)
+		end
+
+		offset = offset + #str
+		offsets[i] = offset
+	end
+
+	local text = concat(strings, "", 1, count)
+
+	if not ffifuncs.getWidths(self, text, offsets, count, wraplimit or -1, widths, linecounts) then
+		-- The Lua-C API version raises the error.
+		return _getWidths(self, strings, wraplimit)
+	end
+
+	local w, l = {}, {}
+
+	for i = 1, count do
+		w[i] = widths[i - 1]
+		l[i] = linecounts[i - 1]
+	end
+
+	return w, l
+end
+
+-- DO NOT REMOVE THE NEXT LINE. It is used to load this file as a C++ string.
+--)luastring"--"
@@ -1148,16 +1148,18 @@ int w_newSpriteBatch(lua_State *L)
 	Texture *texture = luax_checktexture(L, 1);
 	int size = (int) luaL_optinteger(L, 2, 1000);
 	vertex::Usage usage = vertex::USAGE_DYNAMIC;
-	if (lua_gettop(L) > 2)
+	if (!lua_isnoneornil(L, 3))
 	{
 		const char *usagestr = luaL_checkstring(L, 3);
 		if (!vertex::getConstant(usagestr, usage))
 			return luax_enumerror(L, "usage hint", vertex::getConstants(usage), usagestr);
 	}
 
+	bool instanced = luax_optboolean(L, 4, false);
+
 	SpriteBatch *t = nullptr;
 	luax_catchexcept(L,
-		[&](){ t = instance()->newSpriteBatch(texture, size, usage); }
+		[&](){ t = instance()->newSpriteBatch(texture, size, usage, instanced); }
 	);
 
 	luax_pushtype(L, t);
@@ -1945,6 +1947,49 @@ int w_setLineJoin(lua_State *L)
 	return 0;
 }
 
+int w_setBatchMode(lua_State *L)
+{
+	Graphics::BatchMode mode;
+	const char *str = luaL_checkstring(L, 1);
+	if (!Graphics::getConstant(str, mode))
+		return luax_enumerror(L, "batch mode", Graphics::getConstants(mode), str);
+
+	instance()->setBatchMode(mode);
+	return 0;
+}
+
+int w_getBatchMode(lua_State *L)
+{
+	Graphics::BatchMode mode = instance()->getBatchMode();
+	const char *str;
+	if (!Graphics::getConstant(mode, str))
+		return luaL_error(L, "Unknown batch mode");
+	lua_pushstring(L, str);
+	return 1;
+}
+
+int w_beginRecording(lua_State *L)
+{
+	luax_catchexcept(L, [&](){ instance()->beginRecording(); });
+	return 0;
+}
+
+int w_endRecording(lua_State *L)
+{
+	DrawList *list = nullptr;
+	luax_catchexcept(L, [&](){ list = instance()->endRecording(); });
+
+	luax_pushtype(L, list);
+	list->release();
+	return 1;
+}
+
+int w_isRecording(lua_State *L)
+{
+	luax_pushboolean(L, instance()->isRecording());
+	return 1;
+}
+
 int w_getLineWidth(lua_State *L)
 {
 	lua_pushnumber(L, instance()->getLineWidth());
@@ -2116,13 +2161,25 @@ int w_setDefaultShaderCode(lua_State *L)
 			lua_getfield(L, -2, "pixel");
 			lua_getfield(L, -3, "videopixel");
 			lua_getfield(L, -4, "arraypixel");
-
-			std::string vertex = luax_checkstring(L, -4);
-			std::string pixel = luax_checkstring(L, -3);
-			std::string videopixel = luax_checkstring(L, -2);
-			std::string arraypixel = luax_checkstring(L, -1);
-
-			lua_pop(L, 5);
+			lua_getfield(L, -5, "multitexturevertex");
+			lua_getfield(L, -6, "multitexturepixel");
+			lua_getfield(L, -7, "particlesimulationpixel");
+			lua_getfield(L, -8, "particledrawvertex");
+			lua_getfield(L, -9, "spriteinstancedvertex");
+			lua_getfield(L, -10, "distancefieldpixel");
+
+			std::string vertex = luax_checkstring(L, -10);
+			std::string pixel = luax_checkstring(L, -9);
+			std::string videopixel = luax_checkstring(L, -8);
+			std::string arraypixel = luax_checkstring(L, -7);
+			std::string multitexturevertex = luax_checkstring(L, -6);
+			std::string multitexturepixel = luax_checkstring(L, -5);
+			std::string particlesimulationpixel = luax_checkstring(L, -4);
+			std::string particledrawvertex = luax_checkstring(L, -3);
+			std::string spriteinstancedvertex = luax_checkstring(L, -2);
+			std::string distancefieldpixel = luax_checkstring(L, -1);
+
+			lua_pop(L, 11);
 
 			Graphics::defaultShaderCode[Shader::STANDARD_DEFAULT][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
 			Graphics::defaultShaderCode[Shader::STANDARD_DEFAULT][lang][i].source[ShaderStage::STAGE_PIXEL] = pixel;
@@ -2132,6 +2189,21 @@ int w_setDefaultShaderCode(lua_State *L)
 
 			Graphics::defaultShaderCode[Shader::STANDARD_ARRAY][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
 			Graphics::defaultShaderCode[Shader::STANDARD_ARRAY][lang][i].source[ShaderStage::STAGE_PIXEL] = arraypixel;
+
+			Graphics::defaultShaderCode[Shader::STANDARD_MULTITEXTURE][lang][i].source[ShaderStage::STAGE_VERTEX] = multitexturevertex;
+			Graphics::defaultShaderCode[Shader::STANDARD_MULTITEXTURE][lang][i].source[ShaderStage::STAGE_PIXEL] = multitexturepixel;
+
+			Graphics::defaultShaderCode[Shader::STANDARD_PARTICLE_SIMULATION][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
+			Graphics::defaultShaderCode[Shader::STANDARD_PARTICLE_SIMULATION][lang][i].source[ShaderStage::STAGE_PIXEL] = particlesimulationpixel;
+
+			Graphics::defaultShaderCode[Shader::STANDARD_PARTICLE_DRAW][lang][i].source[ShaderStage::STAGE_VERTEX] = particledrawvertex;
+			Graphics::defaultShaderCode[Shader::STANDARD_PARTICLE_DRAW][lang][i].source[ShaderStage::STAGE_PIXEL] = pixel;
+
+			Graphics::defaultShaderCode[Shader::STANDARD_SPRITE_INSTANCED][lang][i].source[ShaderStage::STAGE_VERTEX] = spriteinstancedvertex;
+			Graphics::defaultShaderCode[Shader::STANDARD_SPRITE_INSTANCED][lang][i].source[ShaderStage::STAGE_PIXEL] = pixel;
+
+			Graphics::defaultShaderCode[Shader::STANDARD_DISTANCE_FIELD][lang][i].source[ShaderStage::STAGE_VERTEX] = vertex;
+			Graphics::defaultShaderCode[Shader::STANDARD_DISTANCE_FIELD][lang][i].source[ShaderStage::STAGE_PIXEL] = distancefieldpixel;
 		}
 	}
 
@@ -2300,7 +2372,7 @@ int w_getStats(lua_State *L)
 	if (lua_istable(L, 1))
 		lua_pushvalue(L, 1);
 	else
-		lua_createtable(L, 0, 7);
+		lua_createtable(L, 0, 13);
 
 	lua_pushinteger(L, stats.drawCalls);
 	lua_setfield(L, -2, "drawcalls");
@@ -2308,6 +2380,66 @@ int w_getStats(lua_State *L)
 	lua_pushinteger(L, stats.drawCallsBatched);
 	lua_setfield(L, -2, "drawcallsbatched");
 
+	lua_pushinteger(L, stats.batchesMerged);
+	lua_setfield(L, -2, "batchesmerged");
+
+	lua_pushinteger(L, stats.streamBytes);
+	lua_setfield(L, -2, "streambytes");
+
+	lua_pushinteger(L, stats.streamBufferWraps);
+	lua_setfield(L, -2, "streambufferwraps");
+
+	lua_pushnumber(L, stats.streamStallTime);
+	lua_setfield(L, -2, "streamstalltime");
+
+	if (instance()->isGPUTimingEnabled())
+	{
+		// Reuse the tables from a previous call when possible, since this
+		// is typically called every frame.
+		lua_getfield(L, -1, "gputimings");
+		if (!lua_istable(L, -1))
+		{
+			lua_pop(L, 1);
+			lua_createtable(L, (int) stats.gpuTimings.size(), 0);
+		}
+
+		int count = (int) stats.gpuTimings.size();
+		for (int i = 0; i < count; i++)
+		{
+			const Graphics::GPUTiming &timing = stats.gpuTimings[i];
+
+			lua_rawgeti(L, -1, i + 1);
+			if (!lua_istable(L, -1))
+			{
+				lua_pop(L, 1);
+				lua_createtable(L, 0, 3);
+			}
+
+			luax_pushstring(L, timing.name);
+			lua_setfield(L, -2, "name");
+
+			lua_pushnumber(L, timing.time);
+			lua_setfield(L, -2, "time");
+
+			lua_pushinteger(L, timing.depth);
+			lua_setfield(L, -2, "depth");
+
+			lua_rawseti(L, -2, i + 1);
+		}
+
+		// Remove timings left over from a previous call.
+		int oldcount = (int) luax_objlen(L, -1);
+		for (int i = count + 1; i <= oldcount; i++)
+		{
+			lua_pushnil(L);
+			lua_rawseti(L, -2, i);
+		}
+	}
+	else
+		lua_pushnil(L);
+
+	lua_setfield(L, -2, "gputimings");
+
 	lua_pushinteger(L, stats.canvasSwitches);
 	lua_setfield(L, -2, "canvasswitches");
 
@@ -2329,6 +2461,32 @@ int w_getStats(lua_State *L)
 	return 1;
 }
 
+int w_setGPUTimingEnabled(lua_State *L)
+{
+	bool enable = luax_checkboolean(L, 1);
+	luax_catchexcept(L, [&](){ instance()->setGPUTimingEnabled(enable); });
+	return 0;
+}
+
+int w_isGPUTimingEnabled(lua_State *L)
+{
+	luax_pushboolean(L, instance()->isGPUTimingEnabled());
+	return 1;
+}
+
+int w_pushTimerRegion(lua_State *L)
+{
+	std::string name = luax_checkstring(L, 1);
+	luax_catchexcept(L, [&](){ instance()->pushTimerRegion(name); });
+	return 0;
+}
+
+int w_popTimerRegion(lua_State *L)
+{
+	luax_catchexcept(L, [&](){ instance()->popTimerRegion(); });
+	return 0;
+}
+
 int w_draw(lua_State *L)
 {
 	Drawable *drawable = nullptr;
@@ -2801,6 +2959,25 @@ int w_flushBatch(lua_State *)
 	return 0;
 }
 
+int w_updateParticleSystems(lua_State *L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+	float dt = (float) luaL_checknumber(L, 2);
+
+	std::vector<ParticleSystem *> systems;
+	systems.reserve(luax_objlen(L, 1));
+
+	for (int i = 1; i <= (int) luax_objlen(L, 1); i++)
+	{
+		lua_rawgeti(L, 1, i);
+		systems.push_back(luax_checkparticlesystem(L, -1));
+		lua_pop(L, 1);
+	}
+
+	luax_catchexcept(L, [&](){ ParticleSystem::updateMultiple(systems, dt); });
+	return 0;
+}
+
 int w_getStackDepth(lua_State *L)
 {
 	lua_pushnumber(L, instance()->getStackDepth());
@@ -2966,6 +3143,11 @@ static const luaL_Reg functions[] =
 	{ "getFrontFaceWinding", w_getFrontFaceWinding },
 	{ "setWireframe", w_setWireframe },
 	{ "isWireframe", w_isWireframe },
+	{ "setBatchMode", w_setBatchMode },
+	{ "getBatchMode", w_getBatchMode },
+	{ "beginRecording", w_beginRecording },
+	{ "endRecording", w_endRecording },
+	{ "isRecording", w_isRecording },
 
 	{ "setShader", w_setShader },
 	{ "getShader", w_getShader },
@@ -2978,6 +3160,10 @@ static const luaL_Reg functions[] =
 	{ "getSystemLimits", w_getSystemLimits },
 	{ "getTextureTypes", w_getTextureTypes },
 	{ "getStats", w_getStats },
+	{ "setGPUTimingEnabled", w_setGPUTimingEnabled },
+	{ "isGPUTimingEnabled", w_isGPUTimingEnabled },
+	{ "pushTimerRegion", w_pushTimerRegion },
+	{ "popTimerRegion", w_popTimerRegion },
 
 	{ "captureScreenshot", w_captureScreenshot },
 
@@ -3016,6 +3202,7 @@ static const luaL_Reg functions[] =
 	{ "polygon", w_polygon },
 
 	{ "flushBatch", w_flushBatch },
+	{ "updateParticleSystems", w_updateParticleSystems },
 
 	{ "getStackDepth", w_getStackDepth },
 	{ "push", w_push },
@@ -3053,6 +3240,7 @@ static const lua_CFunction types[] =
 	luaopen_mesh,
 	luaopen_text,
 	luaopen_video,
+	luaopen_drawlist,
 	0
 };
 
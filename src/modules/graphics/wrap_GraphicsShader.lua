@@ -222,10 +222,18 @@ attribute vec4 ConstantColor;
 varying vec4 VaryingTexCoord;
 varying vec4 VaryingColor;
 
+#ifdef LOVE_MULTI_TEXTURE
+	attribute float VertexTextureIndex;
+	varying float VaryingTextureIndex;
+#endif
+
 vec4 position(mat4 clipSpaceFromLocal, vec4 localPosition);
 
 void main() {
 	VaryingTexCoord = VertexTexCoord;
+#ifdef LOVE_MULTI_TEXTURE
+	VaryingTextureIndex = VertexTextureIndex;
+#endif
 	VaryingColor = gammaCorrectColor(VertexColor) * ConstantColor;
 	setPointSize();
 	love_Position = position(ClipSpaceFromLocal, VertexPosition);
@@ -298,6 +306,10 @@ void main() {
 varying LOVE_HIGHP_OR_MEDIUMP vec4 VaryingTexCoord;
 varying mediump vec4 VaryingColor;
 
+#ifdef LOVE_MULTI_TEXTURE
+	varying mediump float VaryingTextureIndex;
+#endif
+
 void effect();
 
 void main() {
@@ -310,7 +322,7 @@ local function getLanguageTarget(code)
 	return (code:match("^%s*#pragma language (%w+)")) or "glsl1"
 end
 
-local function createShaderStageCode(stage, code, lang, gles, glsl1on3, gammacorrect, custom, multicanvas)
+local function createShaderStageCode(stage, code, lang, gles, glsl1on3, gammacorrect, custom, multicanvas, multitexture)
 	stage = stage:upper()
 	local lines = {
 		GLSL.VERSION[lang][gles],
@@ -318,6 +330,7 @@ local function createShaderStageCode(stage, code, lang, gles, glsl1on3, gammacor
 		glsl1on3 and "#define LOVE_GLSL1_ON_GLSL3 1" or "",
 		gammacorrect and "#define LOVE_GAMMA_CORRECT 1" or "",
 		multicanvas and "#define LOVE_MULTI_CANVAS 1" or "",
+		multitexture and "#define LOVE_MULTI_TEXTURE 1" or "",
 		GLSL.SYNTAX,
 		GLSL[stage].HEADER,
 		GLSL.UNIFORMS,
@@ -462,6 +475,166 @@ void effect() {
 }]],
 }
 
+-- Must match MAX_BATCH_TEXTURES in Graphics.h.
+local MAX_BATCH_TEXTURES = 8
+
+-- Samplers can't be dynamically indexed in GLSL 1, so the per-vertex texture
+-- index picks between them with a chain of branches.
+do
+	local lines = {
+		"uniform Image MainTex;",
+		("uniform Image love_BatchTextures[%d];"):format(MAX_BATCH_TEXTURES - 1),
+		"vec4 BatchTexel(vec2 texcoord) {",
+		"\tif (VaryingTextureIndex < 0.5) return Texel(MainTex, texcoord);",
+	}
+	for i = 1, MAX_BATCH_TEXTURES - 2 do
+		lines[#lines+1] = ("\telse if (VaryingTextureIndex < %d.5) return Texel(love_BatchTextures[%d], texcoord);"):format(i, i - 1)
+	end
+	lines[#lines+1] = ("\telse return Texel(love_BatchTextures[%d], texcoord);"):format(MAX_BATCH_TEXTURES - 2)
+	lines[#lines+1] = "}"
+	lines[#lines+1] = [[
+void effect() {
+	love_PixelColor = BatchTexel(VaryingTexCoord.st) * VaryingColor;
+}]]
+	defaultcode.multitexturepixel = table_concat(lines, "\n")
+end
+
+-- GPU-simulated ParticleSystems keep their particles' state in two RGBA32F
+-- canvases (position and velocity, and life, rotation and spawn ID), which
+-- are ping-ponged every update. The images are written by the CPU when
+-- particles are emitted. Must match ParticleSystem.cpp.
+defaultcode.particlesimulationpixel = [[
+#ifdef GL_ES
+	precision highp float;
+#endif
+uniform Image MainTex;
+uniform Image love_ParticleLife;
+uniform Image love_ParticleSpawn;
+uniform Image love_ParticleMotion;
+uniform Image love_ParticleForces;
+uniform Image love_ParticleSpin;
+uniform float love_ParticleDelta;
+void effect() {
+	vec2 uv = VaryingTexCoord.st;
+	vec4 state = Texel(MainTex, uv);
+	vec4 life = Texel(love_ParticleLife, uv);
+	vec4 forces = Texel(love_ParticleForces, uv);
+	vec4 spin = Texel(love_ParticleSpin, uv);
+
+	// The particle in this slot was emitted since the last update.
+	if (life.z != spin.w) {
+		love_Canvases[0] = Texel(love_ParticleSpawn, uv);
+		love_Canvases[1] = vec4(forces.w, spin.z, spin.w, 0.0);
+		return;
+	}
+
+	float dt = love_ParticleDelta;
+	life.x -= dt;
+
+	if (life.x > 0.0) {
+		vec4 motion = Texel(love_ParticleMotion, uv);
+		vec2 radial = state.xy - motion.xy;
+		float len = length(radial);
+		if (len > 0.0)
+			radial *= 1.0 / len;
+
+		vec2 accel = (radial * forces.x + vec2(-radial.y, radial.x) * forces.y) + motion.zw;
+		state.zw = (state.zw + accel * dt) * (1.0 / (1.0 + forces.z * dt));
+		state.xy += state.zw * dt;
+
+		float t = 1.0 - life.x / forces.w;
+		life.y += (spin.x * (1.0 - t) + spin.y * t) * dt;
+	}
+
+	love_Canvases[0] = state;
+	love_Canvases[1] = life;
+}]]
+
+-- Builds each particle's quad from its simulated state. The particle's slot
+-- index is stored in the vertex color.
+defaultcode.particledrawvertex = [[
+uniform Image love_ParticleState;
+uniform Image love_ParticleLife;
+uniform Image love_ParticleForces;
+uniform Image love_ParticleSizeVariation;
+uniform vec2 love_ParticleStateSize;
+uniform vec2 love_ParticleOffset;
+uniform float love_ParticleSizes[8];
+uniform float love_ParticleSizeCount;
+uniform vec4 love_ParticleColors[8];
+uniform float love_ParticleColorCount;
+uniform float love_ParticleRelativeRotation;
+vec4 position(mat4 clipSpaceFromLocal, vec4 localPosition) {
+	vec3 bytes = floor(VertexColor.rgb * 255.0 + 0.5);
+	float index = dot(bytes, vec3(1.0, 256.0, 65536.0));
+	float row = floor(index / love_ParticleStateSize.x);
+	vec2 uv = (vec2(index - row * love_ParticleStateSize.x, row) + 0.5) / love_ParticleStateSize;
+
+	vec4 state = Texel(love_ParticleState, uv);
+	vec4 life = Texel(love_ParticleLife, uv);
+
+	// Dead particles and unused slots collapse to a single point.
+	if (life.x <= 0.0) {
+		VaryingColor = vec4(0.0);
+		return vec4(2.0, 2.0, 2.0, 1.0);
+	}
+
+	vec4 forces = Texel(love_ParticleForces, uv);
+	vec4 variation = Texel(love_ParticleSizeVariation, uv);
+	float t = 1.0 - life.x / forces.w;
+
+	float s = (variation.x + t * variation.y) * (love_ParticleSizeCount - 1.0);
+	float i = clamp(floor(s), 0.0, love_ParticleSizeCount - 1.0);
+	float k = min(i + 1.0, love_ParticleSizeCount - 1.0);
+	float size = mix(love_ParticleSizes[int(i)], love_ParticleSizes[int(k)], s - i);
+
+	s = t * (love_ParticleColorCount - 1.0);
+	i = clamp(floor(s), 0.0, love_ParticleColorCount - 1.0);
+	k = min(i + 1.0, love_ParticleColorCount - 1.0);
+	vec4 color = mix(love_ParticleColors[int(i)], love_ParticleColors[int(k)], s - i);
+
+	VaryingColor = gammaCorrectColor(color) * ConstantColor;
+
+	float angle = life.y;
+	if (love_ParticleRelativeRotation > 0.0)
+		angle += atan(state.w, state.z);
+
+	float c = cos(angle);
+	float sn = sin(angle);
+	vec2 corner = (localPosition.xy - love_ParticleOffset) * size;
+	vec2 pos = state.xy + vec2(c * corner.x - sn * corner.y, sn * corner.x + c * corner.y);
+
+	return clipSpaceFromLocal * vec4(pos, 0.0, 1.0);
+}]]
+
+-- Instanced SpriteBatches draw a unit quad for every sprite. Each instance
+-- holds the sprite's affine transform (with the quad's size folded in), its
+-- texture coordinate rectangle and its color. Must match SpriteBatch.cpp.
+defaultcode.spriteinstancedvertex = [[
+attribute vec3 love_SpriteTransformX;
+attribute vec3 love_SpriteTransformY;
+vec4 position(mat4 clipSpaceFromLocal, vec4 localPosition) {
+	vec3 corner = vec3(localPosition.xy, 1.0);
+	VaryingTexCoord = vec4(mix(VertexTexCoord.xy, VertexTexCoord.zw, localPosition.xy), 0.0, 0.0);
+	vec2 pos = vec2(dot(love_SpriteTransformX, corner), dot(love_SpriteTransformY, corner));
+	return clipSpaceFromLocal * vec4(pos, 0.0, 1.0);
+}]]
+
+-- Glyphs from distance field Fonts hold the signed distance to the outline in
+-- alpha, 0.5 being on the outline. The edge is antialiased across about one
+-- screen pixel, whatever the scale the text is drawn at.
+defaultcode.distancefieldpixel = [[
+vec4 effect(vec4 vcolor, Image tex, vec2 texcoord, vec2 pixcoord) {
+	float dist = Texel(tex, texcoord).a;
+#if defined(GL_ES) && __VERSION__ < 300 && !defined(GL_OES_standard_derivatives)
+	float smoothing = 0.1;
+#else
+	float smoothing = max(0.5 * fwidth(dist), 0.0001);
+#endif
+	float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, dist);
+	return vec4(vcolor.rgb, vcolor.a * alpha);
+}]]
+
 local defaults = {}
 local defaults_gammacorrect = {}
 
@@ -480,6 +653,12 @@ for lang, info in pairs(langs) do
 			pixel = createShaderStageCode("PIXEL", defaultcode.pixel, info.target, info.gles, false, gammacorrect, false),
 			videopixel = createShaderStageCode("PIXEL", defaultcode.videopixel, info.target, info.gles, false, gammacorrect, true),
 			arraypixel = createShaderStageCode("PIXEL", defaultcode.arraypixel, info.target, info.gles, false, gammacorrect, true),
+			multitexturevertex = createShaderStageCode("VERTEX", defaultcode.vertex, info.target, info.gles, false, gammacorrect, false, false, true),
+			multitexturepixel = createShaderStageCode("PIXEL", defaultcode.multitexturepixel, info.target, info.gles, false, gammacorrect, true, false, true),
+			particlesimulationpixel = createShaderStageCode("PIXEL", defaultcode.particlesimulationpixel, info.target, info.gles, false, gammacorrect, true, true),
+			particledrawvertex = createShaderStageCode("VERTEX", defaultcode.particledrawvertex, info.target, info.gles, false, gammacorrect),
+			spriteinstancedvertex = createShaderStageCode("VERTEX", defaultcode.spriteinstancedvertex, info.target, info.gles, false, gammacorrect),
+			distancefieldpixel = createShaderStageCode("PIXEL", defaultcode.distancefieldpixel, info.target, info.gles, false, gammacorrect, false),
 		}
 	end
 end
@@ -273,6 +273,13 @@ int w_SpriteBatch_getDrawRange(lua_State *L)
 	return 2;
 }
 
+int w_SpriteBatch_isInstanced(lua_State *L)
+{
+	SpriteBatch *t = luax_checkspritebatch(L, 1);
+	luax_pushboolean(L, t->isInstanced());
+	return 1;
+}
+
 static const luaL_Reg w_SpriteBatch_functions[] =
 {
 	{ "add", w_SpriteBatch_add },
@@ -290,6 +297,7 @@ static const luaL_Reg w_SpriteBatch_functions[] =
 	{ "attachAttribute", w_SpriteBatch_attachAttribute },
 	{ "setDrawRange", w_SpriteBatch_setDrawRange },
 	{ "getDrawRange", w_SpriteBatch_getDrawRange },
+	{ "isInstanced", w_SpriteBatch_isInstanced },
 	{ 0, 0 }
 };
 
@@ -62,6 +62,31 @@ int w_Text_setf(lua_State *L)
 	return 0;
 }
 
+int w_Text_append(lua_State *L)
+{
+	Text *t = luax_checktext(L, 1);
+
+	std::vector<Font::ColoredString> text;
+	luax_checkcoloredstring(L, 2, text);
+
+	luax_catchexcept(L, [&](){ t->append(text); });
+	return 0;
+}
+
+int w_Text_replace(lua_State *L)
+{
+	Text *t = luax_checktext(L, 1);
+
+	int first = (int) luaL_checkinteger(L, 2) - 1;
+	int last = (int) luaL_checkinteger(L, 3) - 1;
+
+	std::vector<Font::ColoredString> text;
+	luax_checkcoloredstring(L, 4, text);
+
+	luax_catchexcept(L, [&](){ t->replace(first, last - first + 1, text); });
+	return 0;
+}
+
 int w_Text_add(lua_State *L)
 {
 	Text *t = luax_checktext(L, 1);
@@ -192,6 +217,8 @@ static const luaL_Reg w_Text_functions[] =
 	{ "setf", w_Text_setf },
 	{ "add", w_Text_add },
 	{ "addf", w_Text_addf },
+	{ "append", w_Text_append },
+	{ "replace", w_Text_replace },
 	{ "clear", w_Text_clear },
 	{ "setFont", w_Text_setFont },
 	{ "getFont", w_Text_getFont },
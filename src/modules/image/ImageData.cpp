@@ -21,9 +21,28 @@
 #include "ImageData.h"
 #include "Image.h"
 #include "filesystem/Filesystem.h"
+#include "thread/WorkerPool.h"
+#include "common/config.h"
 
 #include <algorithm> // min/max
 
+#if defined(LOVE_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#if defined(LOVE_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// The SIMD and scalar pixel format conversions must round identically, so
+// a*b+c may not be fused into one instruction. GCC ignores this pragma, so the
+// build passes -ffp-contract=off for this file instead.
+#if defined(__clang__)
+#	pragma STDC FP_CONTRACT OFF
+#elif defined(_MSC_VER)
+#	pragma fp_contract (off)
+#endif
+
 using love::thread::Lock;
 
 namespace love
@@ -31,6 +50,36 @@ namespace love
 namespace image
 {
 
+// Bulk operations on fewer pixels than this aren't worth waking up the
+// worker threads for.
+static const int64 MIN_PARALLEL_PIXELS = 256 * 256;
+
+// Calls func with bands of rows in [0, rows), on the shared worker pool when
+// there are enough pixels.
+static void parallelRows(int rows, int64 rowpixels, const std::function<void(int, int)> &func)
+{
+	auto pool = love::thread::WorkerPool::getShared();
+
+	int bands = 1;
+	if (rows * rowpixels >= MIN_PARALLEL_PIXELS)
+		bands = std::min(rows, (pool->getWorkerCount() + 1) * 4);
+
+	if (bands <= 1)
+	{
+		func(0, rows);
+		return;
+	}
+
+	int bandrows = (rows + bands - 1) / bands;
+	bands = (rows + bandrows - 1) / bandrows;
+
+	pool->parallelFor(bands, [&](int i)
+	{
+		int start = i * bandrows;
+		func(start, std::min(rows, start + bandrows));
+	});
+}
+
 love::Type ImageData::type("ImageData", &Data::type);
 
 ImageData::ImageData(Data *data)
@@ -180,18 +229,57 @@ love::filesystem::FileData *ImageData::encode(FormatHandler::EncodedFormat encod
 	if (module == nullptr)
 		throw love::Exception("love.image must be loaded in order to encode an ImageData.");
 
-	for (FormatHandler *handler : module->getFormatHandlers())
+	auto findencoder = [&](PixelFormat rawformat) -> FormatHandler *
 	{
-		if (handler->canEncode(format, encodedFormat))
+		for (FormatHandler *handler : module->getFormatHandlers())
 		{
-			encoder = handler;
-			break;
+			if (handler->canEncode(rawformat, encodedFormat))
+				return handler;
+		}
+		return nullptr;
+	};
+
+	encoder = findencoder(format);
+
+	// Formats the encoder doesn't take directly are converted to the most
+	// precise one it does.
+	PixelFormat encodeformat = format;
+	std::vector<uint8> converted;
+
+	if (encoder == nullptr && canPaste(format, PIXELFORMAT_RGBA8))
+	{
+		for (PixelFormat f : {PIXELFORMAT_RGBA16, PIXELFORMAT_RGBA8})
+		{
+			encoder = findencoder(f);
+			if (encoder != nullptr)
+			{
+				encodeformat = f;
+				break;
+			}
 		}
 	}
 
 	if (encoder != nullptr)
 	{
 		thread::Lock lock(mutex);
+
+		if (encodeformat != format)
+		{
+			size_t srcrowsize = getPixelSize() * width;
+			size_t dstrowsize = getPixelFormatSize(encodeformat) * width;
+
+			converted.resize(dstrowsize * height);
+
+			parallelRows(height, width, [&](int start, int end)
+			{
+				convertPixels(format, data + start * srcrowsize, encodeformat, converted.data() + start * dstrowsize, (end - start) * width);
+			});
+
+			rawimage.data = converted.data();
+			rawimage.size = converted.size();
+			rawimage.format = encodeformat;
+		}
+
 		encodedimage = encoder->encode(rawimage, encodedFormat);
 	}
 
@@ -570,84 +658,243 @@ Colorf ImageData::getPixel(int x, int y) const
 	return c;
 }
 
-union Row
-{
-	uint8 *u8;
-	uint16 *u16;
-	float16 *f16;
-	float *f32;
-};
+// Converters between 32-bit floats and each component type in the formats
+// accepted by canPaste. They give the same results as the per-pixel
+// get/set functions, a whole row of components at a time.
 
-static void pasteRGBA8toRGBA16(Row src, Row dst, int w)
-{
-	for (int i = 0; i < w * 4; i++)
-		dst.u16[i] = (uint16) src.u8[i] << 8u;
-}
+typedef void (*ComponentsToFloat)(const void *src, float *dst, int count);
+typedef void (*ComponentsFromFloat)(const float *src, void *dst, int count);
 
-static void pasteRGBA8toRGBA16F(Row src, Row dst, int w)
+static void unorm8ToFloat(const void *src, float *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.f16[i] = float32to16(src.u8[i] / 255.0f);
+	const uint8 *s = (const uint8 *) src;
+	int i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(255.0f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (s + i)), zero);
+		_mm_storeu_ps(dst + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), scale));
+	}
+#elif defined(LOVE_SIMD_NEON) && defined(__aarch64__)
+	const float32x4_t scale = vdupq_n_f32(255.0f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		uint16x8_t v = vmovl_u8(vld1_u8(s + i));
+		vst1q_f32(dst + i + 0, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), scale));
+		vst1q_f32(dst + i + 4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = s[i] / 255.0f;
 }
 
-static void pasteRGBA8toRGBA32F(Row src, Row dst, int w)
+static void unorm16ToFloat(const void *src, float *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.f32[i] = src.u8[i] / 255.0f;
+	const uint16 *s = (const uint16 *) src;
+	int i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(65535.0f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *) (s + i));
+		_mm_storeu_ps(dst + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), scale));
+	}
+#elif defined(LOVE_SIMD_NEON) && defined(__aarch64__)
+	const float32x4_t scale = vdupq_n_f32(65535.0f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		uint16x8_t v = vld1q_u16(s + i);
+		vst1q_f32(dst + i + 0, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), scale));
+		vst1q_f32(dst + i + 4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = s[i] / 65535.0f;
 }
 
-static void pasteRGBA16toRGBA8(Row src, Row dst, int w)
+static void float16ToFloat(const void *src, float *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.u8[i] = src.u16[i] >> 8u;
+	float16to32((const float16 *) src, dst, count);
 }
 
-static void pasteRGBA16toRGBA16F(Row src, Row dst, int w)
+static void float32ToFloat(const void *src, float *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.f16[i] = float32to16(src.u16[i] / 65535.0f);
+	memcpy(dst, src, count * sizeof(float));
 }
 
-static void pasteRGBA16toRGBA32F(Row src, Row dst, int w)
+static void floatToUnorm8(const float *src, void *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.f32[i] = src.u16[i] / 65535.0f;
+	uint8 *d = (uint8 *) dst;
+	int i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 0), zero), one);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), zero), one);
+		__m128i ia = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, scale), half));
+		__m128i ib = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+		__m128i v = _mm_packs_epi32(ia, ib);
+		_mm_storel_epi64((__m128i *) (d + i), _mm_packus_epi16(v, v));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t half = vdupq_n_f32(0.5f);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 0), zero), one);
+		float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), zero), one);
+		uint32x4_t ia = vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(a, 255.0f), half));
+		uint32x4_t ib = vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(b, 255.0f), half));
+		vst1_u8(d + i, vmovn_u16(vcombine_u16(vmovn_u32(ia), vmovn_u32(ib))));
+	}
+#endif
+
+	for (; i < count; i++)
+		d[i] = (uint8) (clamp01(src[i]) * 255.0f + 0.5f);
 }
 
-static void pasteRGBA16FtoRGBA8(Row src, Row dst, int w)
+static void floatToUnorm16(const float *src, void *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.u8[i] = (uint8) (clamp01(float16to32(src.f16[i])) * 255.0f + 0.5f);
+	uint16 *d = (uint16 *) dst;
+	int i = 0;
+
+#if defined(LOVE_SIMD_SSE2)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(65535.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), zero), one);
+		__m128i v = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, scale), half));
+
+		// Sign-extend so the saturating pack leaves the low 16 bits alone.
+		v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+		_mm_storel_epi64((__m128i *) (d + i), _mm_packs_epi32(v, v));
+	}
+#elif defined(LOVE_SIMD_NEON)
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t half = vdupq_n_f32(0.5f);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(src + i), zero), one);
+		vst1_u16(d + i, vmovn_u32(vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(a, 65535.0f), half))));
+	}
+#endif
+
+	for (; i < count; i++)
+		d[i] = (uint16) (clamp01(src[i]) * 65535.0f + 0.5f);
 }
 
-static void pasteRGBA16FtoRGBA16(Row src, Row dst, int w)
+static void floatToFloat16(const float *src, void *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.u16[i] = (uint16) (clamp01(float16to32(src.f16[i])) * 65535.0f + 0.5f);
+	float32to16(src, (float16 *) dst, count);
 }
 
-static void pasteRGBA16FtoRGBA32F(Row src, Row dst, int w)
+static void floatToFloat32(const float *src, void *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.f32[i] = float16to32(src.f16[i]);
+	memcpy(dst, src, count * sizeof(float));
 }
 
-static void pasteRGBA32FtoRGBA8(Row src, Row dst, int w)
+static ComponentsToFloat getComponentsToFloat(PixelFormat format)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.u8[i] = (uint8) (clamp01(src.f32[i]) * 255.0f + 0.5f);
+	switch (format)
+	{
+		case PIXELFORMAT_RGBA8: return unorm8ToFloat;
+		case PIXELFORMAT_RGBA16: return unorm16ToFloat;
+		case PIXELFORMAT_RGBA16F: return float16ToFloat;
+		case PIXELFORMAT_RGBA32F: return float32ToFloat;
+		default: return nullptr;
+	}
 }
 
-static void pasteRGBA32FtoRGBA16(Row src, Row dst, int w)
+static ComponentsFromFloat getComponentsFromFloat(PixelFormat format)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.u16[i] = (uint16) (clamp01(src.f32[i]) * 65535.0f + 0.5f);
+	switch (format)
+	{
+		case PIXELFORMAT_RGBA8: return floatToUnorm8;
+		case PIXELFORMAT_RGBA16: return floatToUnorm16;
+		case PIXELFORMAT_RGBA16F: return floatToFloat16;
+		case PIXELFORMAT_RGBA32F: return floatToFloat32;
+		default: return nullptr;
+	}
 }
 
-static void pasteRGBA32FtoRGBA16F(Row src, Row dst, int w)
+void ImageData::convertPixels(PixelFormat srcformat, const void *src, PixelFormat dstformat, void *dst, int count)
 {
-	for (int i = 0; i < w * 4; i++)
-		dst.f16[i] = float32to16(src.f32[i]);
+	int components = count * 4;
+
+	if (srcformat == dstformat)
+	{
+		memcpy(dst, src, count * getPixelFormatSize(srcformat));
+		return;
+	}
+
+	if (srcformat == PIXELFORMAT_RGBA8 && dstformat == PIXELFORMAT_RGBA16)
+	{
+		const uint8 *s = (const uint8 *) src;
+		uint16 *d = (uint16 *) dst;
+		for (int i = 0; i < components; i++)
+			d[i] = (uint16) s[i] << 8u;
+		return;
+	}
+
+	if (srcformat == PIXELFORMAT_RGBA16 && dstformat == PIXELFORMAT_RGBA8)
+	{
+		const uint16 *s = (const uint16 *) src;
+		uint8 *d = (uint8 *) dst;
+		for (int i = 0; i < components; i++)
+			d[i] = s[i] >> 8u;
+		return;
+	}
+
+	auto tofloat = getComponentsToFloat(srcformat);
+	auto fromfloat = getComponentsFromFloat(dstformat);
+
+	if (dstformat == PIXELFORMAT_RGBA32F)
+		tofloat(src, (float *) dst, components);
+	else if (srcformat == PIXELFORMAT_RGBA32F)
+		fromfloat((const float *) src, dst, components);
+	else
+	{
+		// Go through a small intermediate buffer which stays in the cache.
+		const int chunksize = 256;
+		float temp[chunksize];
+
+		size_t srcsize = getPixelFormatSize(srcformat) / 4;
+		size_t dstsize = getPixelFormatSize(dstformat) / 4;
+
+		for (int i = 0; i < components; i += chunksize)
+		{
+			int n = std::min(chunksize, components - i);
+			tofloat((const uint8 *) src + i * srcsize, temp, n);
+			fromfloat(temp, (uint8 *) dst + i * dstsize, n);
+		}
+	}
 }
 
 void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh)
@@ -718,63 +965,107 @@ void ImageData::paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, in
 	// If the dimensions match up, copy the entire memory stream in one go
 	if (srcformat == dstformat && (sw == dstW && dstW == srcW && sh == dstH && dstH == srcH))
 	{
-		memcpy(d, s, srcpixelsize * sw * sh);
+		size_t rowsize = srcpixelsize * sw;
+
+		parallelRows(sh, sw, [&](int start, int end)
+		{
+			memcpy(d + start * rowsize, s + start * rowsize, (end - start) * rowsize);
+		});
 	}
 	else if (sw > 0)
 	{
 		// Otherwise, copy each row individually.
-		for (int i = 0; i < sh; i++)
+		bool convert = canPaste(srcformat, dstformat);
+
+		auto pasterows = [&](int start, int end)
 		{
-			Row rowsrc = {s + (sx + (i + sy) * srcW) * srcpixelsize};
-			Row rowdst = {d + (dx + (i + dy) * dstW) * dstpixelsize};
-
-			if (srcformat == dstformat)
-				memcpy(rowdst.u8, rowsrc.u8, srcpixelsize * sw);
-
-			else if (srcformat == PIXELFORMAT_RGBA8 && dstformat == PIXELFORMAT_RGBA16)
-				pasteRGBA8toRGBA16(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA8 && dstformat == PIXELFORMAT_RGBA16F)
-				pasteRGBA8toRGBA16F(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA8 && dstformat == PIXELFORMAT_RGBA32F)
-				pasteRGBA8toRGBA32F(rowsrc, rowdst, sw);
-
-			else if (srcformat == PIXELFORMAT_RGBA16 && dstformat == PIXELFORMAT_RGBA8)
-				pasteRGBA16toRGBA8(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA16 && dstformat == PIXELFORMAT_RGBA16F)
-				pasteRGBA16toRGBA16F(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA16 && dstformat == PIXELFORMAT_RGBA32F)
-				pasteRGBA16toRGBA32F(rowsrc, rowdst, sw);
-
-			else if (srcformat == PIXELFORMAT_RGBA16F && dstformat == PIXELFORMAT_RGBA8)
-				pasteRGBA16FtoRGBA8(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA16F && dstformat == PIXELFORMAT_RGBA16)
-				pasteRGBA16FtoRGBA16(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA16F && dstformat == PIXELFORMAT_RGBA32F)
-				pasteRGBA16FtoRGBA32F(rowsrc, rowdst, sw);
-
-			else if (srcformat == PIXELFORMAT_RGBA32F && dstformat == PIXELFORMAT_RGBA8)
-				pasteRGBA32FtoRGBA8(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA32F && dstformat == PIXELFORMAT_RGBA16)
-				pasteRGBA32FtoRGBA16(rowsrc, rowdst, sw);
-			else if (srcformat == PIXELFORMAT_RGBA32F && dstformat == PIXELFORMAT_RGBA16F)
-				pasteRGBA32FtoRGBA16F(rowsrc, rowdst, sw);
-
-			else
+			for (int i = start; i < end; i++)
 			{
-				// Slow path: convert src -> Colorf -> dst.
-				Colorf c;
-				for (int x = 0; x < sw; x++)
+				const uint8 *rowsrc = s + (sx + (i + sy) * srcW) * srcpixelsize;
+				uint8 *rowdst = d + (dx + (i + dy) * dstW) * dstpixelsize;
+
+				if (convert)
+					convertPixels(srcformat, rowsrc, dstformat, rowdst, sw);
+				else
 				{
-					auto srcp = (const Pixel *) (rowsrc.u8 + x * srcpixelsize);
-					auto dstp = (Pixel *) (rowdst.u8 + x * dstpixelsize);
-					getfunction(srcp, c);
-					setfunction(c, dstp);
+					// Slow path: convert src -> Colorf -> dst.
+					Colorf c;
+					for (int x = 0; x < sw; x++)
+					{
+						auto srcp = (const Pixel *) (rowsrc + x * srcpixelsize);
+						auto dstp = (Pixel *) (rowdst + x * dstpixelsize);
+						getfunction(srcp, c);
+						setfunction(c, dstp);
+					}
 				}
 			}
-		}
+		};
+
+		// Overlapping pastes within one ImageData depend on the row order.
+		if (src == this)
+			pasterows(0, sh);
+		else
+			parallelRows(sh, sw, pasterows);
 	}
 }
 
+void ImageData::mapPixel(PixelKernel kernel, void *userdata, int x, int y, int w, int h)
+{
+	if (!(inside(x, y) && inside(x + w - 1, y + h - 1)))
+		throw love::Exception("Invalid rectangle dimensions.");
+
+	if (pixelGetFunction == nullptr || pixelSetFunction == nullptr)
+		throw love::Exception("mapPixel is not supported for this ImageData's format.");
+
+	Lock lock(mutex);
+
+	uint8 *d = (uint8 *) data;
+	size_t pixelsize = getPixelSize();
+
+	auto getfunction = pixelGetFunction;
+	auto setfunction = pixelSetFunction;
+
+	auto tofloat = getComponentsToFloat(format);
+	auto fromfloat = getComponentsFromFloat(format);
+
+	parallelRows(h, w, [&](int start, int end)
+	{
+		std::vector<float> rgba(w * 4);
+
+		for (int row = start; row < end; row++)
+		{
+			uint8 *rowdata = d + ((y + row) * width + x) * pixelsize;
+
+			if (tofloat != nullptr && fromfloat != nullptr)
+			{
+				tofloat(rowdata, rgba.data(), w * 4);
+				kernel(rgba.data(), w, x, y + row, userdata);
+				fromfloat(rgba.data(), rowdata, w * 4);
+				continue;
+			}
+
+			Colorf c;
+
+			for (int i = 0; i < w; i++)
+			{
+				getfunction((const Pixel *) (rowdata + i * pixelsize), c);
+				rgba[i * 4 + 0] = c.r;
+				rgba[i * 4 + 1] = c.g;
+				rgba[i * 4 + 2] = c.b;
+				rgba[i * 4 + 3] = c.a;
+			}
+
+			kernel(rgba.data(), w, x, y + row, userdata);
+
+			for (int i = 0; i < w; i++)
+			{
+				c.set(rgba[i * 4 + 0], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+				setfunction(c, (Pixel *) (rowdata + i * pixelsize));
+			}
+		}
+	});
+}
+
 love::thread::Mutex *ImageData::getMutex() const
 {
 	return mutex;
@@ -79,6 +79,19 @@ class ImageData : public ImageDataBase
 	 **/
 	void paste(ImageData *src, int dx, int dy, int sx, int sy, int sw, int sh);
 
+	/**
+	 * Native function for mapPixel. Gets a run of count pixels starting at
+	 * (x, y) as RGBA floats, which it modifies in-place. It's called from
+	 * multiple threads at once, for different rows.
+	 **/
+	typedef void (*PixelKernel)(float *rgba, int count, int x, int y, void *userdata);
+
+	/**
+	 * Runs a native kernel over every pixel in a rectangle, spread across
+	 * the shared worker threads.
+	 **/
+	void mapPixel(PixelKernel kernel, void *userdata, int x, int y, int w, int h);
+
 	/**
 	 * Checks whether a position is inside this ImageData. Useful for checking bounds.
 	 * @param x The position along the x-axis.
@@ -126,6 +139,12 @@ class ImageData : public ImageDataBase
 	static bool validPixelFormat(PixelFormat format);
 	static bool canPaste(PixelFormat src, PixelFormat dst);
 
+	/**
+	 * Converts count pixels from one format to another, a row at a time.
+	 * The formats must be accepted by canPaste.
+	 **/
+	static void convertPixels(PixelFormat srcformat, const void *src, PixelFormat dstformat, void *dst, int count);
+
 	static PixelSetFunction getPixelSetFunction(PixelFormat format);
 	static PixelGetFunction getPixelGetFunction(PixelFormat format);
 
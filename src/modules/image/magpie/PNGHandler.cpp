@@ -23,6 +23,7 @@
 // LOVE
 #include "common/Exception.h"
 #include "common/math.h"
+#include "thread/WorkerPool.h"
 
 // LodePNG
 #include "lodepng/lodepng.h"
@@ -32,6 +33,8 @@
 
 // C++
 #include <algorithm>
+#include <atomic>
+#include <vector>
 
 // C
 #include <cstdlib>
@@ -97,10 +100,118 @@ static unsigned zlibDecompress(unsigned char **out, size_t *outsize, const unsig
 	return 0; // Success.
 }
 
+// Size of the pieces of data compressed in parallel.
+static const size_t COMPRESS_CHUNK_SIZE = 256 * 1024;
+
+// Size of the deflate window, and of the dictionary each piece starts with.
+static const size_t DEFLATE_WINDOW_SIZE = 32 * 1024;
+
+// Compresses pieces of the data on the worker threads, as raw deflate streams
+// which are joined into a single zlib stream. Each piece starts with the data
+// before it as a dictionary, so back-references across pieces still work and
+// the output is about as small as with a single stream.
+static unsigned zlibCompressParallel(unsigned char **out, size_t *outsize, const unsigned char *in, size_t insize)
+{
+	size_t chunkcount = (insize + COMPRESS_CHUNK_SIZE - 1) / COMPRESS_CHUNK_SIZE;
+
+	std::vector<std::vector<unsigned char>> chunks(chunkcount);
+	std::vector<uLong> checksums(chunkcount);
+	std::atomic<bool> failed(false);
+
+	love::thread::WorkerPool::getShared()->parallelFor((int) chunkcount, [&](int i)
+	{
+		size_t start = i * COMPRESS_CHUNK_SIZE;
+		size_t size = std::min(COMPRESS_CHUNK_SIZE, insize - start);
+		bool last = i == (int) chunkcount - 1;
+
+		z_stream stream = {};
+		if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			failed = true;
+			return;
+		}
+
+		if (start > 0)
+		{
+			size_t dictsize = std::min(start, DEFLATE_WINDOW_SIZE);
+			deflateSetDictionary(&stream, in + start - dictsize, (uInt) dictsize);
+		}
+
+		// Extra room for the sync flush marker.
+		std::vector<unsigned char> &chunk = chunks[i];
+		chunk.resize(deflateBound(&stream, size) + 16);
+
+		stream.next_in = (Bytef *) (in + start);
+		stream.avail_in = (uInt) size;
+		stream.next_out = chunk.data();
+		stream.avail_out = (uInt) chunk.size();
+
+		// Every piece but the last ends on a byte boundary, without marking
+		// the end of the stream.
+		int status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+
+		if (status != (last ? Z_STREAM_END : Z_OK) || stream.avail_in != 0)
+			failed = true;
+
+		chunk.resize(chunk.size() - stream.avail_out);
+		deflateEnd(&stream);
+
+		checksums[i] = adler32(adler32(0L, Z_NULL, 0), in + start, (uInt) size);
+	});
+
+	if (failed)
+		return 10000; // "Unknown error code" for LodePNG.
+
+	uLong checksum = checksums[0];
+	for (size_t i = 1; i < chunkcount; i++)
+	{
+		size_t size = std::min(COMPRESS_CHUNK_SIZE, insize - i * COMPRESS_CHUNK_SIZE);
+		checksum = adler32_combine(checksum, checksums[i], (z_off_t) size);
+	}
+
+	// zlib header and Adler-32 checksum around the deflate data.
+	size_t outdatasize = 2 + 4;
+	for (const auto &chunk : chunks)
+		outdatasize += chunk.size();
+
+	// LodePNG uses malloc, realloc, and free.
+	unsigned char *outdata = (unsigned char *) malloc(outdatasize);
+
+	if (!outdata)
+		return 83; // "Memory allocation failed" error code for LodePNG.
+
+	// Deflate with a 32 KB window, at the default compression level.
+	outdata[0] = 0x78;
+	outdata[1] = 0x9C;
+
+	size_t offset = 2;
+	for (const auto &chunk : chunks)
+	{
+		memcpy(outdata + offset, chunk.data(), chunk.size());
+		offset += chunk.size();
+	}
+
+	outdata[offset + 0] = (unsigned char) (checksum >> 24);
+	outdata[offset + 1] = (unsigned char) (checksum >> 16);
+	outdata[offset + 2] = (unsigned char) (checksum >> 8);
+	outdata[offset + 3] = (unsigned char) (checksum >> 0);
+
+	if (out != nullptr)
+		*out = outdata;
+
+	if (outsize != nullptr)
+		*outsize = outdatasize;
+
+	return 0; // Success.
+}
+
 // Custom PNG compression function for LodePNG, using zlib.
 static unsigned zlibCompress(unsigned char **out, size_t *outsize, const unsigned char *in,
                              size_t insize, const LodePNGCompressSettings* /*settings*/)
 {
+	if (insize >= COMPRESS_CHUNK_SIZE * 2 && love::thread::WorkerPool::getShared()->getWorkerCount() > 0)
+		return zlibCompressParallel(out, outsize, in, insize);
+
 	// Get the maximum compressed size of the data.
 	uLongf outdatasize = compressBound(insize);
 
@@ -22,6 +22,7 @@
 #include "STBHandler.h"
 #include "common/Exception.h"
 #include "common/Color.h"
+#include "thread/WorkerPool.h"
 
 static void loveSTBIAssert(bool test, const char *teststr)
 {
@@ -43,6 +44,9 @@ static void loveSTBIAssert(bool test, const char *teststr)
 // C
 #include <cstdlib>
 
+// C++
+#include <algorithm>
+
 namespace love
 {
 namespace image
@@ -143,21 +147,32 @@ FormatHandler::EncodedImage STBHandler::encode(const DecodedImage &img, EncodedF
 	encimg.data[16] = bpp * 8; // bits per pixel
 	encimg.data[17] = 0x20; // descriptor bits (flip bits: 0x10 horizontal, 0x20 vertical)
 
-	// header done. write the pixel data to TGA:
-	memcpy(encimg.data + headerlen, img.data, img.width * img.height * bpp);
-
-	// convert the pixels from RGBA to BGRA.
+	// header done. write the pixel data to TGA, converting the pixels from
+	// RGBA to BGRA. Large images are split into bands of rows for the
+	// worker threads.
+	const Color32 *srcpixels = (const Color32 *) img.data;
 	Color32 *encodedpixels = (Color32 *) (encimg.data + headerlen);
-	for (int y = 0; y < img.height; y++)
+
+	auto pool = love::thread::WorkerPool::getShared();
+
+	int bands = 1;
+	if ((int64) img.width * img.height >= 256 * 256)
+		bands = std::min(img.height, (pool->getWorkerCount() + 1) * 4);
+
+	int bandrows = (img.height + bands - 1) / bands;
+	bands = (img.height + bandrows - 1) / bandrows;
+
+	pool->parallelFor(bands, [&](int band)
 	{
-		for (int x = 0; x < img.width; x++)
+		int start = band * bandrows;
+		int end = std::min(img.height, start + bandrows);
+
+		for (int i = start * img.width; i < end * img.width; i++)
 		{
-			unsigned char r = encodedpixels[y * img.width + x].r;
-			unsigned char b = encodedpixels[y * img.width + x].b;
-			encodedpixels[y * img.width + x].r = b;
-			encodedpixels[y * img.width + x].b = r;
+			Color32 c = srcpixels[i];
+			encodedpixels[i] = Color32(c.b, c.g, c.r, c.a);
 		}
-	}
+	});
 
 	return encimg;
 }
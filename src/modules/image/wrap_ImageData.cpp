@@ -284,6 +284,8 @@ struct FFI_ImageData
 
 	float (*float10to32)(float10 f);
 	float10 (*float32to10)(float f);
+
+	bool (*mapPixelKernel)(Proxy *p, ImageData::PixelKernel kernel, void *userdata, int x, int y, int w, int h);
 };
 
 static FFI_ImageData ffifuncs =
@@ -308,6 +310,22 @@ static FFI_ImageData ffifuncs =
 	float32to11,
 	float10to32,
 	float32to10,
+
+	[](Proxy *p, ImageData::PixelKernel kernel, void *userdata, int x, int y, int w, int h) -> bool // mapPixelKernel
+	{
+		// Exceptions can't be thrown through the FFI, so errors are returned.
+		ImageData *i = (ImageData *) p->object;
+
+		try
+		{
+			i->mapPixel(kernel, userdata, x, y, w, h);
+			return true;
+		}
+		catch (love::Exception &)
+		{
+			return false;
+		}
+	},
 };
 
 static const luaL_Reg w_ImageData_functions[] =
@@ -60,6 +60,11 @@ function ImageData:mapPixel(func, ix, iy, iw, ih)
 	self:_performAtomic(self._mapPixelUnsafe, self, func, ix, iy, iw, ih)
 end
 
+-- Native kernels can only be passed in through the FFI (see below).
+function ImageData:mapPixelKernel()
+	error("ImageData:mapPixelKernel requires LuaJIT's FFI.", 2)
+end
+
 
 -- Everything below this point is efficient FFI replacements for existing
 -- ImageData functionality.
@@ -95,6 +100,8 @@ typedef struct FFI_ImageData
 
 	float (*float10to32)(float10 f);
 	float10 (*float32to10)(float f);
+
+	bool (*mapPixelKernel)(Proxy *p, void (*kernel)(float *rgba, int count, int x, int y, void *userdata), void *userdata, int x, int y, int w, int h);
 } FFI_ImageData;
 
 struct ImageData_Pixel_R8 { uint8_t r; };
@@ -413,6 +420,32 @@ function ImageData:_mapPixelUnsafe(func, ix, iy, iw, ih)
 	end
 end
 
+-- Like mapPixel, but with a native function (e.g. from a library loaded with
+-- ffi.load) which is run on multiple threads. Lua functions can't be used,
+-- since FFI callbacks may only be called from the main thread.
+function ImageData:mapPixelKernel(kernel, ix, iy, iw, ih, userdata)
+	local idw, idh = self:getDimensions()
+
+	ix = ix or 0
+	iy = iy or 0
+	iw = iw or idw
+	ih = ih or idh
+
+	if type(kernel) ~= "cdata" then error("bad argument #1 to ImageData:mapPixelKernel (expected native function pointer)", 2) end
+	if type(ix) ~= "number" then error("bad argument #2 to ImageData:mapPixelKernel (expected number)", 2) end
+	if type(iy) ~= "number" then error("bad argument #3 to ImageData:mapPixelKernel (expected number)", 2) end
+	if type(iw) ~= "number" then error("bad argument #4 to ImageData:mapPixelKernel (expected number)", 2) end
+	if type(ih) ~= "number" then error("bad argument #5 to ImageData:mapPixelKernel (expected number)", 2) end
+
+	ix, iy, iw, ih = floor(ix), floor(iy), floor(iw), floor(ih)
+
+	if not (inside(ix, iy, idw, idh) and inside(ix+iw-1, iy+ih-1, idw, idh)) then error("Invalid rectangle dimensions", 2) end
+
+	if not ffifuncs.mapPixelKernel(self, kernel, userdata, ix, iy, iw, ih) then
+		error("ImageData:mapPixelKernel is not supported for this ImageData's format.", 2)
+	end
+end
+
 function ImageData:getPixel(x, y)
 	if type(x) ~= "number" then error("bad argument #1 to ImageData:getPixel (expected number)", 2) end
 	if type(y) ~= "number" then error("bad argument #2 to ImageData:getPixel (expected number)", 2) end
@@ -322,6 +322,16 @@ static int w__setGammaCorrect(lua_State *L)
 	return 0;
 }
 
+static int w__setGraphicsStreamBufferSize(lua_State *L)
+{
+#ifdef LOVE_ENABLE_GRAPHICS
+	lua_Number size = luaL_checknumber(L, 1);
+	if (size > 0)
+		love::graphics::setStreamBufferSize((size_t) size);
+#endif
+	return 0;
+}
+
 static int w__setAudioMixWithSystem(lua_State *L)
 {
 	bool success = false;
@@ -400,6 +410,9 @@ int luaopen_love(lua_State *L)
 	lua_pushcfunction(L, w__setGammaCorrect);
 	lua_setfield(L, -2, "_setGammaCorrect");
 
+	lua_pushcfunction(L, w__setGraphicsStreamBufferSize);
+	lua_setfield(L, -2, "_setGraphicsStreamBufferSize");
+
 	// Exposed here because we need to be able to call it before the audio
 	// module is initialized.
 	lua_pushcfunction(L, w__setAudioMixWithSystem);
@@ -19,6 +19,13 @@
  **/
 
 #include "Sound.h"
+#include "SoundDataDecoder.h"
+
+// C
+#include <cstring>
+
+// C++
+#include <algorithm>
 
 namespace love
 {
@@ -27,6 +34,16 @@ namespace sound
 
 love::Type Sound::type("Sound", &Module::type);
 
+static inline uint16 readLE16(const uint8 *p)
+{
+	return (uint16) (p[0] | (p[1] << 8));
+}
+
+static inline uint32 readLE32(const uint8 *p)
+{
+	return (uint32) p[0] | ((uint32) p[1] << 8) | ((uint32) p[2] << 16) | ((uint32) p[3] << 24);
+}
+
 Sound::~Sound()
 {
 }
@@ -46,5 +63,83 @@ SoundData *Sound::newSoundData(void *data, int samples, int sampleRate, int bitD
 	return new SoundData(data, samples, sampleRate, bitDepth, channels);
 }
 
+SoundData *Sound::newWaveSoundData(Data *wave)
+{
+	const uint8 *bytes = (const uint8 *) wave->getData();
+	size_t size = wave->getSize();
+
+	if (size < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0)
+		return nullptr;
+
+	bool hasformat = false;
+	int channels = 0;
+	int sampleRate = 0;
+	int bitDepth = 0;
+
+	size_t pos = 12;
+
+	while (pos <= size - 8)
+	{
+		const uint8 *chunk = bytes + pos;
+		size_t chunksize = readLE32(chunk + 4);
+		size_t available = size - pos - 8;
+
+		if (memcmp(chunk, "fmt ", 4) == 0)
+		{
+			if (chunksize < 16 || chunksize > available)
+				return nullptr;
+
+			uint16 tag = readLE16(chunk + 8);
+
+			// WAVE_FORMAT_EXTENSIBLE stores the real format in its sub-format GUID.
+			if (tag == 0xFFFE && chunksize >= 40)
+				tag = readLE16(chunk + 32);
+
+			// WAVE_FORMAT_PCM.
+			if (tag != 1)
+				return nullptr;
+
+			channels = readLE16(chunk + 10);
+			sampleRate = (int) readLE32(chunk + 12);
+			bitDepth = readLE16(chunk + 22);
+
+			if (readLE16(chunk + 20) != channels * (bitDepth / 8))
+				return nullptr;
+
+			hasformat = true;
+		}
+		else if (memcmp(chunk, "data", 4) == 0)
+		{
+			if (!hasformat)
+				return nullptr;
+
+			// 16 bit samples are stored little-endian.
+#ifdef LOVE_BIG_ENDIAN
+			if (bitDepth != 8)
+				return nullptr;
+#endif
+
+			if ((bitDepth != 8 && bitDepth != 16) || channels <= 0 || sampleRate <= 0)
+				return nullptr;
+
+			// Some writers leave the size of a truncated file's data chunk as is.
+			return new SoundData(wave, pos + 8, std::min(chunksize, available), sampleRate, bitDepth, channels);
+		}
+
+		// Chunks are padded to an even size.
+		if (chunksize > available)
+			return nullptr;
+
+		pos += 8 + chunksize + (chunksize & 1);
+	}
+
+	return nullptr;
+}
+
+Decoder *Sound::newSoundDataDecoder(SoundData *soundData, int bufferSize)
+{
+	return new SoundDataDecoder(soundData, bufferSize);
+}
+
 } // sound
 } // love
@@ -80,6 +80,22 @@ class Sound : public Module
 	 **/
 	SoundData *newSoundData(void *data, int samples, int sampleRate, int bitDepth, int channels);
 
+	/**
+	 * Creates a new SoundData which uses the samples of an uncompressed PCM
+	 * WAV file in place, without decoding or copying them.
+	 * @param wave The contents of the WAV file.
+	 * @return A new SoundData object, or zero if the file isn't an 8 or 16 bit
+	 * PCM WAV file which can be used as-is.
+	 **/
+	SoundData *newWaveSoundData(Data *wave);
+
+	/**
+	 * Creates a Decoder which reads chunks of samples from a SoundData.
+	 * @param soundData The SoundData to read from.
+	 * @param bufferSize The size of each chunk.
+	 **/
+	Decoder *newSoundDataDecoder(SoundData *soundData, int bufferSize);
+
 	/**
 	 * Attempts to find a decoder for the encoded sound data in the
 	 * specified file.
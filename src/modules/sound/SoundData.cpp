@@ -108,6 +108,43 @@ SoundData::SoundData(void *d, int samples, int sampleRate, int bitDepth, int cha
 	load(samples, sampleRate, bitDepth, channels, d);
 }
 
+SoundData::SoundData(Data *source, size_t offset, size_t size, int sampleRate, int bitDepth, int channels)
+	: data(0)
+	, size(0)
+	, sampleRate(0)
+	, bitDepth(0)
+	, channels(0)
+{
+	if (sampleRate <= 0)
+		throw love::Exception("Invalid sample rate: %d", sampleRate);
+
+	if (bitDepth != 8 && bitDepth != 16)
+		throw love::Exception("Invalid bit depth: %d", bitDepth);
+
+	if (channels <= 0)
+		throw love::Exception("Invalid channel count: %d", channels);
+
+	if (offset > source->getSize() || size > source->getSize() - offset)
+		throw love::Exception("Sample data is out of range of the source Data.");
+
+	// Only whole sample frames.
+	size -= size % ((bitDepth / 8) * channels);
+
+	if (size == 0)
+		throw love::Exception("Invalid sample count: 0");
+
+	if (size / ((bitDepth / 8) * channels) > (size_t) std::numeric_limits<int>::max())
+		throw love::Exception("Data is too big!");
+
+	sourceData.set(source);
+
+	data = (uint8 *) source->getData() + offset;
+	this->size = size;
+	this->sampleRate = sampleRate;
+	this->bitDepth = bitDepth;
+	this->channels = channels;
+}
+
 SoundData::SoundData(const SoundData &c)
 	: data(0)
 	, size(0)
@@ -120,7 +157,7 @@ SoundData::SoundData(const SoundData &c)
 
 SoundData::~SoundData()
 {
-	if (data != 0)
+	if (data != 0 && sourceData.get() == nullptr)
 		free(data);
 }
 
@@ -143,11 +180,11 @@ void SoundData::load(int samples, int sampleRate, int bitDepth, int channels, vo
 	if (channels <= 0)
 		throw love::Exception("Invalid channel count: %d", channels);
 
-	if (data != 0)
-	{
+	if (data != 0 && sourceData.get() == nullptr)
 		free(data);
-		data = 0;
-	}
+
+	data = 0;
+	sourceData.set(nullptr);
 
 	size = samples * (bitDepth / 8) * channels;
 	this->sampleRate = sampleRate;
@@ -179,6 +216,11 @@ size_t SoundData::getSize() const
 	return size;
 }
 
+Data *SoundData::getSourceData() const
+{
+	return sourceData.get();
+}
+
 int SoundData::getChannelCount() const
 {
 	return channels;
@@ -40,6 +40,12 @@ class SoundData : public love::Data
 	SoundData(Decoder *decoder);
 	SoundData(int samples, int sampleRate, int bitDepth, int channels);
 	SoundData(void *d, int samples, int sampleRate, int bitDepth, int channels);
+
+	/**
+	 * Uses a region of existing sample data without copying it. The Data is
+	 * retained for as long as the SoundData exists.
+	 **/
+	SoundData(Data *source, size_t offset, size_t size, int sampleRate, int bitDepth, int channels);
 	SoundData(const SoundData &c);
 
 	virtual ~SoundData();
@@ -49,6 +55,12 @@ class SoundData : public love::Data
 	void *getData() const;
 	size_t getSize() const;
 
+	/**
+	 * Gets the Data whose memory this SoundData uses in place, such as a
+	 * mapped WAV file, or null if the SoundData owns its samples.
+	 **/
+	Data *getSourceData() const;
+
 	virtual int getChannelCount() const;
 	virtual int getBitDepth() const;
 	virtual int getSampleRate() const;
@@ -68,6 +80,9 @@ class SoundData : public love::Data
 	uint8 *data;
 	size_t size;
 
+	// Owns the memory pointed to by data, if it wasn't allocated by us.
+	StrongRef<Data> sourceData;
+
 	int sampleRate;
 	int bitDepth;
 	int channels;
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#include "SoundDataDecoder.h"
+
+// C
+#include <cstring>
+
+// C++
+#include <algorithm>
+
+namespace love
+{
+namespace sound
+{
+
+SoundDataDecoder::SoundDataDecoder(SoundData *soundData, int bufferSize)
+	: Decoder(soundData, bufferSize)
+	, soundData(soundData)
+	, offset(0)
+{
+	sampleRate = soundData->getSampleRate();
+}
+
+SoundDataDecoder::~SoundDataDecoder()
+{
+}
+
+Decoder *SoundDataDecoder::clone()
+{
+	return new SoundDataDecoder(soundData, bufferSize);
+}
+
+int SoundDataDecoder::decode()
+{
+	size_t size = soundData->getSize();
+	size_t frame = (soundData->getBitDepth() / 8) * soundData->getChannelCount();
+
+	// Only whole sample frames, so seeking stays aligned.
+	size_t count = std::min((size_t) bufferSize - (size_t) bufferSize % frame, size - offset);
+
+	if (count > 0)
+		memcpy(buffer, (const uint8 *) soundData->getData() + offset, count);
+
+	offset += count;
+
+	if (offset >= size)
+		eof = true;
+
+	return (int) count;
+}
+
+bool SoundDataDecoder::seek(double s)
+{
+	if (s < 0.0)
+		return false;
+
+	size_t frame = (soundData->getBitDepth() / 8) * soundData->getChannelCount();
+	double sample = s * soundData->getSampleRate();
+
+	if (sample >= (double) soundData->getSampleCount())
+		offset = soundData->getSize();
+	else
+		offset = (size_t) sample * frame;
+
+	eof = offset >= soundData->getSize();
+	return true;
+}
+
+bool SoundDataDecoder::rewind()
+{
+	offset = 0;
+	eof = false;
+	return true;
+}
+
+bool SoundDataDecoder::isSeekable()
+{
+	return true;
+}
+
+int SoundDataDecoder::getChannelCount() const
+{
+	return soundData->getChannelCount();
+}
+
+int SoundDataDecoder::getBitDepth() const
+{
+	return soundData->getBitDepth();
+}
+
+int SoundDataDecoder::getSampleRate() const
+{
+	return soundData->getSampleRate();
+}
+
+double SoundDataDecoder::getDuration()
+{
+	return soundData->getDuration();
+}
+
+} // sound
+} // love
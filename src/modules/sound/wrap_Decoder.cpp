@@ -112,7 +112,7 @@ int w_Decoder_getChannels(lua_State *L)
 	return w_Decoder_getChannelCount(L);
 }
 
-static const luaL_Reg w_Decoder_functions[] =
+const luaL_Reg w_Decoder_functions[] =
 {
 	{ "clone", w_Decoder_clone },
 	{ "getChannelCount", w_Decoder_getChannelCount },
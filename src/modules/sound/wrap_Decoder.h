@@ -31,6 +31,7 @@ namespace sound
 {
 
 Decoder *luax_checkdecoder(lua_State *L, int idx);
+extern const luaL_Reg w_Decoder_functions[];
 extern "C" int luaopen_decoder(lua_State *L);
 
 } // sound
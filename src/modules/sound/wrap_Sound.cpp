@@ -32,6 +32,34 @@ namespace sound
 
 #define instance() (Module::getInstance<Sound>(Module::M_SOUND))
 
+// Smaller files aren't worth keeping a mapping around for.
+static const size_t MIN_MAPPED_FILE_SIZE = 1024 * 1024;
+
+SoundData *luax_newmappedsounddata(lua_State *L, int idx)
+{
+	if (instance() == nullptr)
+		return nullptr;
+
+	love::filesystem::MappedFileData *file = love::filesystem::luax_getmappedfiledata(L, idx);
+
+	if (file == nullptr)
+		return nullptr;
+
+	if (file->getSize() < MIN_MAPPED_FILE_SIZE)
+	{
+		file->release();
+		return nullptr;
+	}
+
+	SoundData *t = nullptr;
+	luax_catchexcept(L,
+		[&]() { t = instance()->newWaveSoundData(file); },
+		[&](bool) { file->release(); }
+	);
+
+	return t;
+}
+
 int w_newDecoder(lua_State *L)
 {
 	love::filesystem::FileData *data = love::filesystem::luax_getfiledata(L, 1);
@@ -67,14 +95,20 @@ int w_newSoundData(lua_State *L)
 	// Must be string or decoder.
 	else
 	{
-		// Convert to Decoder, if necessary.
-		if (!luax_istype(L, 1, Decoder::type))
+		// Large uncompressed WAV files on disk are used in place.
+		t = luax_newmappedsounddata(L, 1);
+
+		if (t == nullptr)
 		{
-			w_newDecoder(L);
-			lua_replace(L, 1);
+			// Convert to Decoder, if necessary.
+			if (!luax_istype(L, 1, Decoder::type))
+			{
+				w_newDecoder(L);
+				lua_replace(L, 1);
+			}
+
+			luax_catchexcept(L, [&](){ t = instance()->newSoundData(luax_checkdecoder(L, 1)); });
 		}
-
-		luax_catchexcept(L, [&](){ t = instance()->newSoundData(luax_checkdecoder(L, 1)); });
 	}
 
 	luax_pushtype(L, t);
@@ -32,6 +32,13 @@ namespace love
 namespace sound
 {
 
+/**
+ * Creates a SoundData which uses a large uncompressed WAV file in place, if
+ * the value at idx is the name of one which is stored directly on disk.
+ * @return A SoundData which must be released, or null.
+ **/
+SoundData *luax_newmappedsounddata(lua_State *L, int idx);
+
 extern "C" LOVE_EXPORT int luaopen_love_sound(lua_State *L);
 
 } // sound
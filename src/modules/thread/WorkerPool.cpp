@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+// LOVE
+#include "WorkerPool.h"
+#include "common/Exception.h"
+
+// C++
+#include <algorithm>
+#include <thread>
+
+namespace love
+{
+namespace thread
+{
+
+WorkerPool::Worker::Worker(WorkerPool *pool)
+	: pool(pool)
+{
+	threadName = "WorkerPool";
+}
+
+void WorkerPool::Worker::threadFunction()
+{
+	pool->workerFunction();
+}
+
+WorkerPool::WorkerPool(int workercount)
+	: jobFunc(nullptr)
+	, jobCount(0)
+	, nextIndex(0)
+	, jobID(0)
+	, busyWorkers(0)
+	, stopping(false)
+{
+	for (int i = 0; i < workercount; i++)
+	{
+		Worker *worker = new Worker(this);
+
+		if (!worker->start())
+		{
+			worker->release();
+			break;
+		}
+
+		workers.push_back(worker);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		Lock lock(mutex);
+		stopping = true;
+		jobCond->broadcast();
+	}
+
+	for (Worker *worker : workers)
+	{
+		worker->wait();
+		worker->release();
+	}
+}
+
+void WorkerPool::parallelFor(int count, const std::function<void(int)> &func)
+{
+	if (count <= 0)
+		return;
+
+	// Not worth waking up the workers.
+	if (workers.empty() || count == 1)
+	{
+		for (int i = 0; i < count; i++)
+			func(i);
+		return;
+	}
+
+	Lock calllock(callMutex);
+
+	{
+		Lock lock(mutex);
+
+		jobFunc = &func;
+		jobCount = count;
+		nextIndex = 0;
+		jobError.clear();
+
+		busyWorkers = (int) workers.size();
+		jobID++;
+
+		jobCond->broadcast();
+	}
+
+	runJob();
+
+	std::string err;
+
+	{
+		Lock lock(mutex);
+
+		while (busyWorkers > 0)
+			doneCond->wait(mutex);
+
+		jobFunc = nullptr;
+		err = jobError;
+	}
+
+	if (!err.empty())
+		throw love::Exception("%s", err.c_str());
+}
+
+int WorkerPool::getWorkerCount() const
+{
+	return (int) workers.size();
+}
+
+void WorkerPool::workerFunction()
+{
+	uint64 lastjob = 0;
+
+	while (true)
+	{
+		{
+			Lock lock(mutex);
+
+			while (!stopping && jobID == lastjob)
+				jobCond->wait(mutex);
+
+			if (stopping)
+				return;
+
+			lastjob = jobID;
+		}
+
+		runJob();
+
+		{
+			Lock lock(mutex);
+
+			if (--busyWorkers == 0)
+				doneCond->signal();
+		}
+	}
+}
+
+void WorkerPool::runJob()
+{
+	while (true)
+	{
+		int i = nextIndex++;
+		if (i >= jobCount)
+			break;
+
+		try
+		{
+			(*jobFunc)(i);
+		}
+		catch (std::exception &e)
+		{
+			Lock lock(mutex);
+			if (jobError.empty())
+				jobError = e.what();
+		}
+	}
+}
+
+WorkerPool *WorkerPool::getShared()
+{
+	// Intentionally never deleted: the workers just sleep until the process
+	// exits, which avoids problems with static destruction order.
+	static WorkerPool *pool = new WorkerPool(std::max((int) std::thread::hardware_concurrency() - 1, 0));
+	return pool;
+}
+
+} // thread
+} // love
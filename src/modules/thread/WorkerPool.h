@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2006-2020 LOVE Development Team
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty.  In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ **/
+
+#ifndef LOVE_THREAD_WORKER_POOL_H
+#define LOVE_THREAD_WORKER_POOL_H
+
+// LOVE
+#include "common/config.h"
+#include "threads.h"
+
+// C++
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace love
+{
+namespace thread
+{
+
+/**
+ * A fixed set of native worker threads which cooperatively run the iterations
+ * of a loop. Used internally to spread CPU-heavy work across cores.
+ **/
+class WorkerPool
+{
+public:
+
+	WorkerPool(int workercount);
+	~WorkerPool();
+
+	/**
+	 * Calls func once for every index in [0, count), spread across the worker
+	 * threads and the calling thread. Returns once all calls have finished.
+	 * The order of the calls is unspecified, so they must be independent of
+	 * each other. Must not be called from inside func.
+	 **/
+	void parallelFor(int count, const std::function<void(int)> &func);
+
+	int getWorkerCount() const;
+
+	/**
+	 * Gets the pool shared by all modules, which has one worker thread for
+	 * each CPU core besides the calling thread's.
+	 **/
+	static WorkerPool *getShared();
+
+private:
+
+	class Worker : public Threadable
+	{
+	public:
+
+		Worker(WorkerPool *pool);
+		virtual ~Worker() {}
+
+		// Implements Threadable.
+		void threadFunction() override;
+
+	private:
+
+		WorkerPool *pool;
+	};
+
+	void workerFunction();
+	void runJob();
+
+	std::vector<Worker *> workers;
+
+	// Serializes parallelFor calls from different threads.
+	MutexRef callMutex;
+
+	MutexRef mutex;
+	ConditionalRef jobCond;
+	ConditionalRef doneCond;
+
+	const std::function<void(int)> *jobFunc;
+	int jobCount;
+	std::atomic<int> nextIndex;
+
+	uint64 jobID;
+	int busyWorkers;
+	bool stopping;
+
+	std::string jobError;
+
+}; // WorkerPool
+
+} // thread
+} // love
+
+#endif // LOVE_THREAD_WORKER_POOL_H
@@ -427,6 +427,9 @@ function love.init()
 			mixwithsystem = true, -- Only relevant for Android / iOS.
 			mic = false, -- Only relevant for Android.
 		},
+		graphics = {
+			streambuffersize = 1024 * 1024, -- Bytes of vertex data streamed per frame.
+		},
 		console = false, -- Only relevant for windows.
 		identity = false,
 		appendidentity = false,
@@ -470,6 +473,12 @@ function love.init()
 		love._setGammaCorrect(c.gammacorrect)
 	end
 
+	if love._setGraphicsStreamBufferSize then
+		if c.graphics and c.graphics.streambuffersize ~= nil then
+			love._setGraphicsStreamBufferSize(c.graphics.streambuffersize)
+		end
+	end
+
 	if love._setAudioMixWithSystem then
 		if c.audio and c.audio.mixwithsystem ~= nil then
 			love._setAudioMixWithSystem(c.audio.mixwithsystem)